@@ -1,31 +1,109 @@
 # ShaderProcessor.cmake
 #
-# This module searches for GLSL files and converts them into C-style strings.
-# It makes a distinction between shaders and snippets. Snippets are used for
-# common code that is included across multiple shaders at runtime.
+# This module converts GLSL files into C++ headers at build time. It makes a
+# distinction between shaders and snippets. Snippets are used for common code
+# that is included across multiple shaders.
+#
+# Shaders are flattened: their includes are resolved here, and the source is
+# split around '#pragma inject_attributes' into a ShaderSource, so that the
+# runtime only has to insert the defines of a program between the two parts.
+# Snippets are written as is, since custom shaders still include them when
+# their program is created.
+#
+# When included, the module adds a custom command for every header and sets
+# SHADER_HEADERS to the list of generated headers. When run as a script, it
+# generates the header SHADER_OUTPUT for the GLSL file SHADER_INPUT.
 
-file(GLOB_RECURSE SHADERS "**/*.vert" "**/*.frag" "**/*.glsl")
+function(shader_flatten SOURCE SNIPPETS_DIR OUT_VAR)
+    set(RESULT "${SOURCE}")
+    # Snippets may include other snippets, up to a few levels deep
+    foreach(DEPTH RANGE 8)
+        string(REGEX MATCHALL "#include \"snippets/[^\"]+\"" INCLUDES "${RESULT}")
+        if (NOT INCLUDES)
+            break()
+        endif()
+        list(REMOVE_DUPLICATES INCLUDES)
+        foreach(INCLUDE IN LISTS INCLUDES)
+            string(REGEX REPLACE "#include \"snippets/([^\"]+)\"" "\\1" SNIPPET "${INCLUDE}")
+            if (NOT EXISTS "${SNIPPETS_DIR}/${SNIPPET}")
+                message(FATAL_ERROR "Shader snippet '${SNIPPET}' not found in ${SNIPPETS_DIR}")
+            endif()
+            file(READ "${SNIPPETS_DIR}/${SNIPPET}" CONTENTS)
+            string(REPLACE "${INCLUDE}" "${CONTENTS}" RESULT "${RESULT}")
+        endforeach()
+    endforeach()
+    set(${OUT_VAR} "${RESULT}" PARENT_SCOPE)
+endfunction()
 
-foreach(SHADER IN LISTS SHADERS)
-    get_filename_component(FILENAME ${SHADER} NAME)
-    get_filename_component(DIRECTORY ${SHADER} DIRECTORY)
-    get_filename_component(EXTENSION ${SHADER} EXT)
+function(shader_write_header INPUT OUTPUT)
+    get_filename_component(FILENAME ${INPUT} NAME)
+    get_filename_component(DIRECTORY ${INPUT} DIRECTORY)
+    get_filename_component(EXTENSION ${INPUT} EXT)
 
     string(REGEX REPLACE "\\." "_" EXT ${EXTENSION})
     string(REGEX REPLACE "\\.[^.]*$" "" FILENAME_NO_EXT ${FILENAME})
-    set(HEADER_FILE ${DIRECTORY}/headers/${FILENAME_NO_EXT}${EXT}.h)
+
+    file(READ ${INPUT} CONTENTS)
+    set(HEADER "// Generated from ${FILENAME} by ShaderProcessor.cmake\n\n#pragma once\n\n")
 
     string(FIND "${DIRECTORY}" "snippets" POSITION)
     if (POSITION GREATER -1)
-        set(VAR "_SNIPPET_${FILENAME_NO_EXT}")
-        message("🎨 Writing snippet ${FILENAME_NO_EXT}.h")
+        string(APPEND HEADER "#include <string_view>\n\n")
+        string(APPEND HEADER "constexpr auto _SNIPPET_${FILENAME_NO_EXT} = std::string_view {R\"(\n${CONTENTS}\n)\"};")
     else()
-        set(VAR "_SHADER_${FILENAME_NO_EXT}${EXT}")
-        message("🎨 Writing shader ${FILENAME_NO_EXT}.h")
+        set(TOKEN "#pragma inject_attributes")
+        string(FIND "${CONTENTS}" "${TOKEN}" POSITION)
+        if (POSITION EQUAL -1)
+            message(FATAL_ERROR "The '${TOKEN}' token is missing in ${FILENAME}")
+        endif()
+        string(LENGTH "${TOKEN}" TOKEN_LENGTH)
+        math(EXPR BODY_START "${POSITION} + ${TOKEN_LENGTH}")
+        string(SUBSTRING "${CONTENTS}" 0 ${POSITION} PROLOGUE)
+        string(SUBSTRING "${CONTENTS}" ${BODY_START} -1 BODY)
+        shader_flatten("${BODY}" "${DIRECTORY}/snippets" BODY)
+
+        string(APPEND HEADER "#include \"core/shader_library.hpp\"\n\n")
+        string(APPEND HEADER "constexpr auto _SHADER_${FILENAME_NO_EXT}${EXT} = gleam::ShaderSource {\n")
+        string(APPEND HEADER "    .prologue = R\"(${PROLOGUE})\",\n")
+        string(APPEND HEADER "    .body = R\"(${BODY})\"\n")
+        string(APPEND HEADER "};")
     endif()
 
-    file(READ ${SHADER} CONTENTS)
-    file(WRITE ${HEADER_FILE} "#pragma once\n\nstatic const char* ${VAR} = R\"(\n")
-    file(APPEND ${HEADER_FILE} "${CONTENTS}")
-    file(APPEND ${HEADER_FILE} "\n)\";")
+    file(WRITE ${OUTPUT} "${HEADER}")
+endfunction()
+
+if (CMAKE_SCRIPT_MODE_FILE)
+    shader_write_header(${SHADER_INPUT} ${SHADER_OUTPUT})
+    return()
+endif()
+
+file(GLOB_RECURSE SHADERS CONFIGURE_DEPENDS
+    "${CMAKE_CURRENT_SOURCE_DIR}/shaders/*.vert"
+    "${CMAKE_CURRENT_SOURCE_DIR}/shaders/*.frag"
+    "${CMAKE_CURRENT_SOURCE_DIR}/shaders/*.glsl"
+)
+file(GLOB SNIPPETS CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/shaders/snippets/*.glsl")
+
+set(SHADER_HEADERS)
+foreach(SHADER IN LISTS SHADERS)
+    file(RELATIVE_PATH RELATIVE ${CMAKE_CURRENT_SOURCE_DIR} ${SHADER})
+    get_filename_component(FILENAME ${RELATIVE} NAME)
+    get_filename_component(DIRECTORY ${RELATIVE} DIRECTORY)
+    get_filename_component(EXTENSION ${RELATIVE} EXT)
+
+    string(REGEX REPLACE "\\." "_" EXT ${EXTENSION})
+    string(REGEX REPLACE "\\.[^.]*$" "" FILENAME_NO_EXT ${FILENAME})
+    set(HEADER_FILE ${CMAKE_CURRENT_BINARY_DIR}/${DIRECTORY}/headers/${FILENAME_NO_EXT}${EXT}.h)
+
+    add_custom_command(
+        OUTPUT ${HEADER_FILE}
+        COMMAND ${CMAKE_COMMAND}
+            -DSHADER_INPUT=${SHADER}
+            -DSHADER_OUTPUT=${HEADER_FILE}
+            -P ${CMAKE_CURRENT_LIST_FILE}
+        DEPENDS ${SHADER} ${SNIPPETS} ${CMAKE_CURRENT_LIST_FILE}
+        COMMENT "🎨 Writing shader ${FILENAME_NO_EXT}${EXT}.h"
+        VERBATIM
+    )
+    list(APPEND SHADER_HEADERS ${HEADER_FILE})
 endforeach()
\ No newline at end of file
@@ -13,4 +13,6 @@
  */
 
 #include "gleam/core/application_context.hpp"
+#include "gleam/core/frame_capture.hpp"
+#include "gleam/core/job_system.hpp"
 #include "gleam/core/timer.hpp"
\ No newline at end of file
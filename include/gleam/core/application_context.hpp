@@ -10,10 +10,12 @@
 #include "gleam_export.h"
 
 #include "gleam/cameras/camera.hpp"
+#include "gleam/core/frame_capture.hpp"
 #include "gleam/core/timer.hpp"
 #include "gleam/math/color.hpp"
 #include "gleam/nodes/scene.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -79,8 +81,16 @@ public:
         int width {1024}; ///< Window width in pixels.
         int height {768}; ///< Window height in pixels.
         int antialiasing {0}; ///< Antialiasing level (e.g., 4x MSAA).
+        unsigned int workers {0}; ///< Job system worker threads (0 = one per core, minus the main thread).
         bool vsync {true}; ///< Enables vertical sync.
+        bool pipelined {false}; ///< Updates the next frame while the current one is rendered (see Start()).
+        bool headless {false}; ///< Renders offscreen without a window or display server (see Start()).
+        bool occlusion_queries {false}; ///< Skips large meshes hidden in the previous frame using GPU occlusion queries.
+        bool depth_prepass {false}; ///< Draws opaque meshes depth-only first, so each pixel is shaded once.
         bool debug {false}; ///< Enables debug mode UI overlays.
+        std::string shader_cache {}; ///< Directory where compiled shaders are cached between runs (empty disables it).
+        bool async_shaders {false}; ///< Compiles shaders in the background, skipping objects until they're ready.
+        float anisotropy {1.0f}; ///< Maximum anisotropic filtering of textures (1 = off, clamped to what the GPU supports).
 
         /**
          * @brief Returns the aspect ratio (width / height).
@@ -104,6 +114,24 @@ public:
      *
      * This method initializes the window, rendering context, and user scene
      * and enters the main loop until the application exits.
+     *
+     * By default, every frame is updated and then rendered on the main thread.
+     * When `Parameters::pipelined` is set, `Update()`, node updates and
+     * culling for the next frame run on a worker thread while the current
+     * frame is submitted to the GPU, which adds one frame of latency. The
+     * rendered frame uses a snapshot of transforms, visibility, lights, sprite
+     * anchors and rotations, and instance data of instanced meshes, so nodes
+     * can be moved, hidden, added and removed during an update. Other
+     * state that's read while rendering, such as materials, geometries,
+     * textures and fog, must not be modified from `Update()` in this mode,
+     * and UI code shouldn't run there either.
+     *
+     * When `Parameters::headless` is set, the application doesn't open a
+     * window. It renders through an EGL surfaceless context, or OSMesa when
+     * EGL isn't available, into an offscreen framebuffer of `width` by
+     * `height` pixels, so it runs on machines without a display or GPU, such
+     * as CI runners with Mesa llvmpipe. There are no input events, and the
+     * loop runs until `Update()` returns false.
      */
     auto Start() -> void;
 
@@ -173,6 +201,73 @@ public:
      */
     auto SetCamera(std::shared_ptr<Camera> camera) -> void;
 
+    /**
+     * @brief Compiles the shaders a scene needs before it's rendered.
+     *
+     * Every shader variant the scene's meshes can be drawn with, given its
+     * lights and fog, is compiled on the main thread once the current update
+     * is done, so it's safe to call from `Update()`. With `async_shaders`
+     * enabled the shaders are compiled in the background, which lets a
+     * loading screen keep rendering until `PendingShaders()` returns zero.
+     *
+     * @code
+     * auto Update(float delta) -> bool override {
+     *   if (loading_ && PendingShaders() == 0) {
+     *     SetScene(level_);
+     *     loading_ = false;
+     *   }
+     *   return true;
+     * }
+     * @endcode
+     *
+     * @param scene Shared pointer to the scene to compile shaders for.
+     */
+    auto PrecompileShaders(std::shared_ptr<Scene> scene) -> void;
+
+    /**
+     * @brief Returns the number of shaders still compiling in the background.
+     *
+     * The count is updated after every frame, so it's still zero in the
+     * frame that called `PrecompileShaders()`.
+     *
+     * @return Number of pending shaders.
+     */
+    [[nodiscard]] auto PendingShaders() const -> std::size_t;
+
+    /**
+     * @brief Starts capturing rendered frames.
+     *
+     * Every frame is copied into a ring of GPU buffers without waiting for the
+     * copy to finish, and passed to the callback on the main thread once it's
+     * ready, typically two to three frames later. If the buffers are still in
+     * flight when a frame is rendered, the frame is dropped rather than
+     * stalling the pipeline. Pending frames are delivered when the capture is
+     * stopped or the application loop exits.
+     *
+     * @code
+     * auto Configure() -> void override {
+     *   StartCapture([this](gleam::CapturedFrame frame) {
+     *     encoder_.Push(std::move(frame));
+     *   });
+     * }
+     * @endcode
+     *
+     * @param callback Callback that receives the captured frames.
+     */
+    auto StartCapture(OnFrameCaptured callback) -> void;
+
+    /**
+     * @brief Stops capturing frames and delivers the frames still in flight.
+     */
+    auto StopCapture() -> void;
+
+    /**
+     * @brief Returns the throughput and latency of the current or last capture.
+     *
+     * @return FrameCaptureStats
+     */
+    [[nodiscard]] auto GetCaptureStats() const -> FrameCaptureStats;
+
     /**
      * @brief Destructor.
      */
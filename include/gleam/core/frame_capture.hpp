@@ -0,0 +1,68 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace gleam {
+
+/**
+ * @brief Pixels of a rendered frame, read back from the GPU.
+ *
+ * @ingroup CoreGroup
+ */
+struct CapturedFrame {
+    /// @brief Index of the frame the pixels were rendered in.
+    std::uint64_t frame {0};
+
+    /// @brief Width of the frame in pixels.
+    int width {0};
+
+    /// @brief Height of the frame in pixels.
+    int height {0};
+
+    /// @brief RGBA pixels with 8 bits per channel, starting at the bottom row.
+    std::vector<std::uint8_t> pixels;
+};
+
+/**
+ * @brief Throughput and latency of a frame capture.
+ *
+ * @ingroup CoreGroup
+ */
+struct FrameCaptureStats {
+    /// @brief Number of frames delivered to the capture callback.
+    std::size_t captured {0};
+
+    /// @brief Number of frames skipped because every readback buffer was in use.
+    std::size_t dropped {0};
+
+    /// @brief Average number of frames between rendering and delivery.
+    double latency_frames {0.0};
+
+    /// @brief Average time between rendering and delivery, in milliseconds.
+    double latency_ms {0.0};
+
+    /// @brief Frames delivered per second since the capture started.
+    double frames_per_second {0.0};
+};
+
+/**
+ * @brief Callback that receives captured frames.
+ *
+ * Called on the render thread, so work that takes longer than a frame,
+ * such as encoding, should be handed off to another thread.
+ *
+ * @ingroup CoreGroup
+ */
+using OnFrameCaptured = std::function<void(CapturedFrame frame)>;
+
+}
\ No newline at end of file
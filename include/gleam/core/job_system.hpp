@@ -0,0 +1,204 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam_export.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gleam {
+
+/**
+ * @brief Work-stealing scheduler for short CPU jobs.
+ *
+ * `JobSystem` runs jobs on a fixed pool of worker threads. Every worker owns a
+ * deque: it pushes and pops its own jobs at the back, and steals from the front
+ * of other workers' deques when it runs out. Threads that are not workers,
+ * such as the main thread, submit into the workers' deques in turn.
+ *
+ * Completion is tracked with `JobSystem::Counter` objects. A counter is
+ * incremented for every job submitted with it and decremented when the job
+ * finishes. Jobs can also depend on a counter, in which case they're held back
+ * until every job tracked by that counter has finished.
+ *
+ * `Wait()` doesn't block the calling thread while work is pending. It runs
+ * the queued jobs of the counter it waits on, and of the counters its held
+ * back jobs depend on, until none are left. Only then does it sleep until the
+ * counter reaches zero, so waiting from inside a job is safe and keeps the
+ * worker busy. Jobs of other counters are left to the workers.
+ *
+ * Long-running jobs, such as file decodes, are submitted with
+ * `RunBackground()`. They only run on workers, once the other queues are
+ * empty, so they never delay the frame on the thread that waits for it.
+ *
+ * The application owns a single job system, available to nodes through
+ * `SharedContext::Jobs()`.
+ *
+ * @code
+ * auto counter = gleam::JobSystem::Counter {};
+ * jobs->Run([&]{ DecodeHeightmap(); }, &counter);
+ * jobs->Run([&]{ DecodeSplatmap(); }, &counter);
+ *
+ * // Runs once both decoding jobs are done
+ * auto done = gleam::JobSystem::Counter {};
+ * jobs->Run([&]{ BuildTerrain(); }, &done, &counter);
+ *
+ * jobs->Wait(done);
+ * @endcode
+ *
+ * @note Counters must outlive the jobs submitted with them, and jobs that
+ * depend on them.
+ *
+ * @note Jobs must not throw. The engine is built without exceptions, so an
+ * exception that leaves a job can't unwind engine frames safely and ends the
+ * program.
+ *
+ * @ingroup CoreGroup
+ */
+class GLEAM_EXPORT JobSystem {
+public:
+    /// @brief Unit of work executed by the job system.
+    using Job = std::function<void()>;
+
+    /// @brief Parameters for constructing a JobSystem object.
+    struct Parameters {
+        /// @brief Number of worker threads. Zero uses one worker per
+        /// hardware thread, minus one for the main thread.
+        unsigned int workers {0};
+    };
+
+    /**
+     * @brief Tracks the completion of a group of jobs.
+     */
+    class GLEAM_EXPORT Counter {
+    public:
+        /**
+         * @brief Constructs a Counter object with no pending jobs.
+         */
+        Counter() = default;
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        /**
+         * @brief Checks whether every job tracked by the counter has finished.
+         *
+         * @return true if no jobs are pending, false otherwise.
+         */
+        [[nodiscard]] auto IsDone() const {
+            return pending_.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class JobSystem;
+
+        /// @brief Number of tracked jobs that haven't finished yet.
+        std::atomic<std::size_t> pending_ {0};
+
+        /// @brief Guards the continuation list.
+        std::mutex mutex_;
+
+        /// @brief Jobs waiting for this counter to reach zero.
+        std::vector<Job> continuations_;
+
+        /// @brief Counters that tracked jobs were held back on, directly
+        /// or through their own dependencies. Cleared when this counter
+        /// reaches zero, and only compared, never dereferenced.
+        std::vector<const Counter*> dependencies_;
+    };
+
+    /**
+     * @brief Constructs a JobSystem object and starts its workers.
+     *
+     * @param params JobSystem::Parameters
+     */
+    explicit JobSystem(const Parameters& params);
+
+    /**
+     * @brief Constructs a JobSystem object with default parameters.
+     */
+    JobSystem() : JobSystem(Parameters {}) {}
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Submits a job.
+     *
+     * @param job Job to run.
+     * @param counter Optional counter incremented until the job finishes.
+     * @param dependency Optional counter the job waits on before it's queued.
+     */
+    auto Run(Job job, Counter* counter = nullptr, Counter* dependency = nullptr) -> void;
+
+    /**
+     * @brief Submits a long-running job at background priority.
+     *
+     * Background jobs run on workers after every queued job submitted with
+     * `Run()`, and `Wait()` never runs them on the calling thread.
+     *
+     * @param job Job to run.
+     * @param counter Optional counter incremented until the job finishes.
+     */
+    auto RunBackground(Job job, Counter* counter = nullptr) -> void;
+
+    /**
+     * @brief Runs queued jobs of the counter on the calling thread until the
+     * counter reaches zero.
+     *
+     * Queued jobs of the counters that held back jobs of this counter depend
+     * on are run as well. Once none of these jobs is left to run, the calling
+     * thread blocks until the jobs running on workers finish.
+     *
+     * @param counter Counter to wait on.
+     */
+    auto Wait(Counter& counter) -> void;
+
+    /**
+     * @brief Splits a range into chunks and processes them in parallel.
+     *
+     * Calls `fn(begin, end)` for consecutive sub-ranges of `[0, count)` and
+     * returns once every chunk is done. The calling thread processes chunks
+     * as well.
+     *
+     * @param count Number of elements in the range.
+     * @param grain Number of elements per chunk. Zero picks a chunk
+     * size that gives each thread a few chunks to balance uneven work.
+     * @param fn Callable that processes the elements in `[begin, end)`.
+     */
+    auto ParallelFor(
+        std::size_t count,
+        std::size_t grain,
+        const std::function<void(std::size_t begin, std::size_t end)>& fn
+    ) -> void;
+
+    /**
+     * @brief Returns the number of worker threads.
+     *
+     * @return Worker thread count.
+     */
+    [[nodiscard]] auto WorkerCount() const -> std::size_t;
+
+    /**
+     * @brief Destructor. Finishes queued jobs and joins the workers.
+     */
+    ~JobSystem();
+
+private:
+    /// @cond INTERNAL
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+    /// @endcond
+};
+
+}
\ No newline at end of file
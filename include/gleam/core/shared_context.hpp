@@ -9,6 +9,7 @@
 
 #include "gleam_export.h"
 
+#include "gleam/core/job_system.hpp"
 #include "gleam/loaders.hpp"
 
 #include <memory>
@@ -102,12 +103,27 @@ public:
         return loaders_;
     }
 
+    /**
+     * @brief Returns the engine's job system.
+     *
+     * The job system is shared by the engine and the application, so
+     * background work doesn't oversubscribe the machine's cores.
+     *
+     * @return Pointer to the `JobSystem`.
+     */
+    [[nodiscard]] JobSystem* Jobs() const {
+        return jobs_;
+    }
+
 private:
     /// @brief Internal parameter state.
     SharedParameters params_ {};
 
     /// @brief Internal loader registry.
     SharedLoaders loaders_ {};
+
+    /// @brief Job system owned by the application context.
+    JobSystem* jobs_ {nullptr};
 };
 
 }
\ No newline at end of file
@@ -35,7 +35,9 @@ enum class VertexAttributeType {
     UV = 2, ///< Texture coordinates.
     Color = 3, ///< Vertex color.
     InstanceColor = 4, ///< Instance color.
-    InstanceTransform = 5 ///< Instance transform.
+    InstanceTransform = 5, ///< Instance transform.
+    InstanceNormalMatrix = 9, ///< Instance normal matrix.
+    InstanceLayer = 12 ///< Instance texture layer.
 };
 
 /**
@@ -180,6 +182,14 @@ public:
      */
     [[nodiscard]] auto HasAttribute(VertexAttributeType type) const -> bool;
 
+    /**
+     * @brief Returns the geometry version.
+     *
+     * The version is incremented whenever the vertex layout changes and is
+     * used by the renderer to detect when cached shader programs are stale.
+     */
+    [[nodiscard]] auto Version() const { return version_; }
+
     /**
      * @brief Returns the geometry's bounding box (computed on demand).
      *
@@ -217,6 +227,9 @@ protected:
     /// @brief Vertex attribute metadata.
     std::vector<GeometryAttribute> attributes_;
 
+    /// @brief Vertex layout version.
+    unsigned int version_ {0};
+
     /**
      * @brief Computes and caches the bounding box.
      */
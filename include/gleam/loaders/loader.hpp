@@ -9,6 +9,8 @@
 
 #include "gleam_export.h"
 
+#include "gleam/core/job_system.hpp"
+
 #include <expected>
 #include <filesystem>
 #include <functional>
@@ -57,9 +59,10 @@ public:
     /**
      * @brief Loads a resource asynchronously from the specified file path.
      * The result is delivered to the provided callback on a background thread.
-     * File existence is verified before loading. This implementation currently
-     * spawns a detached thread and should be updated to use a thread pool
-     * for better control and efficiency.
+     * File existence is verified before loading. Loaders provided by the
+     * `SharedContext` run as background jobs on the engine's job system, so
+     * loads and their callbacks never run on the main thread. Standalone
+     * loaders spawn a detached thread per request.
      *
      * @param path File system path to the resource.
      * @param callback Callback that receives the result of the loading operation.
@@ -71,10 +74,16 @@ public:
         }
 
         auto self = this->shared_from_this();
-        std::thread([self, path, callback]() {
+        auto job = [self, path, callback]() {
             auto result = self->LoadImpl(path);
             callback(result);
-        }).detach();
+        };
+
+        if (jobs_ != nullptr) {
+            jobs_->RunBackground(job);
+        } else {
+            std::thread(job).detach();
+        }
     }
 
     /**
@@ -83,6 +92,13 @@ public:
     virtual ~Loader() = default;
 
 private:
+    /// @cond INTERNAL
+    friend class ApplicationContext;
+
+    /// @brief Job system used for asynchronous loads, if any.
+    JobSystem* jobs_ {nullptr};
+    /// @endcond
+
     /**
      * @brief Pure virtual method to implement the actual loading logic. Must
      * be overridden by derived classes to perform the resource-specific loading
@@ -84,6 +84,9 @@ public:
     /// @brief Blending mode used for rendering this material.
     Blending blending {Blending::Normal};
 
+    /// @brief GPU renderer identifier. Used internally by the renderer.
+    unsigned int renderer_id = 0;
+
     /**
      * @brief Returns material type.
      *
@@ -53,6 +53,9 @@ public:
     /// @brief Alpha map that controls the opacity across the surface.
     std::shared_ptr<Texture2D> alpha_map = nullptr;
 
+    /// @brief Layer sampled from maps that are texture arrays (see TextureArray).
+    unsigned texture_layer = 0;
+
     /**
      * @brief Constructs a PhongMaterial object.
      *
@@ -55,6 +55,12 @@ using UniformValue = std::variant<int, float, Color, Matrix3, Matrix4, Vector2,
  * scene->Add(mesh);
  * @endcode
  *
+ * @note Shaders that include the engine snippets read the model matrix
+ * through `objectModel()`, and `u_Color` and `u_Opacity` from the `ub_Material`
+ * uniform block. Shaders that declare `uniform mat4 u_Model` or
+ * `uniform float u_Opacity` themselves are still given these values, but
+ * `u_Color` is only available through the snippets.
+ *
  * @ingroup MaterialsGroup
  */
 class GLEAM_EXPORT ShaderMaterial : public Material {
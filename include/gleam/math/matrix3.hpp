@@ -228,4 +228,35 @@ private:
     return output;
 }
 
+/**
+ * @brief Computes the normal matrix of a model transform.
+ * @relatesalso Matrix3
+ *
+ * The normal matrix transforms surface normals so that they stay perpendicular
+ * to transformed surfaces, and is the inverse transpose of the upper-left 3x3
+ * submatrix. When the transform is a rotation with uniform scale, the submatrix
+ * itself is returned since it differs from the inverse transpose only by a
+ * scale factor. Either way, transformed normals must be renormalized.
+ *
+ * @param m Model transform matrix.
+ * @return Normal matrix, up to a scale factor.
+ */
+[[nodiscard]] GLEAM_EXPORT inline constexpr auto NormalMatrix(const Matrix4& m) {
+    const auto linear = Matrix3 {m};
+    const auto& x = linear[0];
+    const auto& y = linear[1];
+    const auto& z = linear[2];
+
+    const auto sx = Dot(x, x);
+    const auto tolerance = sx * 1e-5f;
+    const auto is_uniform =
+        math::Fabs(Dot(y, y) - sx) <= tolerance &&
+        math::Fabs(Dot(z, z) - sx) <= tolerance &&
+        math::Fabs(Dot(x, y)) <= tolerance &&
+        math::Fabs(Dot(y, z)) <= tolerance &&
+        math::Fabs(Dot(z, x)) <= tolerance;
+
+    return is_uniform ? linear : Transpose(Inverse(linear));
+}
+
 }
\ No newline at end of file
@@ -23,4 +23,5 @@
 #include "gleam/nodes/node.hpp"
 #include "gleam/nodes/orbit_controls.hpp"
 #include "gleam/nodes/scene.hpp"
-#include "gleam/nodes/sprite.hpp"
\ No newline at end of file
+#include "gleam/nodes/sprite.hpp"
+#include "gleam/nodes/static_batch.hpp"
\ No newline at end of file
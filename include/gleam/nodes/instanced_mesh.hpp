@@ -30,6 +30,7 @@ namespace gleam {
  * Each instance can have:
  * - a transform matrix (model matrix)
  * - a color (for material tinting)
+ * - a texture layer (for materials whose maps are texture arrays)
  *
  * Instances are addressed by zero‑based index in the range `[0, Count())`.
  *
@@ -112,6 +113,14 @@ public:
      */
     [[nodiscard]] auto GetColorAt(std::size_t idx) -> const Color;
 
+    /**
+     * @brief Returns the texture layer assigned to a specific instance.
+     *
+     * @param idx Instance index in [0, Count()).
+     * @return Texture layer of the instance.
+     */
+    [[nodiscard]] auto GetLayerAt(std::size_t idx) -> unsigned;
+
     /**
      * @brief Returns the transform assigned to a specific instance.
      *
@@ -130,6 +139,19 @@ public:
      */
     auto SetColorAt(std::size_t idx, const Color& color) -> void;
 
+    /**
+     * @brief Sets the texture layer for a specific instance.
+     *
+     * Instances sample texture array maps (see TextureArray) at the sum of
+     * the material's `texture_layer` and their own layer, so instances can
+     * use different textures while still being drawn together. Layers are
+     * optional, and only stored once the first one is set.
+     *
+     * @param idx Instance index in [0, Count()).
+     * @param layer Layer to assign.
+     */
+    auto SetLayerAt(std::size_t idx, unsigned layer) -> void;
+
     /**
      * @brief Sets the model transform for a specific instance.
      *
@@ -167,8 +189,12 @@ private:
     /// @brief Per-instance colors indexed by instance ID.
     std::vector<Color> colors_;
 
+    /// @brief Per-instance texture layers, empty until a layer is set.
+    std::vector<float> layers_;
+
     /// @cond INTERNAL
     friend class GLBuffers;
+    friend class RenderLists;
     class Impl;
     std::unique_ptr<Impl> impl_;
     /// @endcond
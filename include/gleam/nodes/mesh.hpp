@@ -36,6 +36,15 @@ namespace gleam {
  */
 class GLEAM_EXPORT Mesh : public Renderable {
 public:
+    /**
+     * @brief If true, the mesh hides other renderables during occlusion culling.
+     *
+     * Occluders are rasterized into a low-resolution depth buffer every frame,
+     * and renderables whose bounds are entirely behind them aren't drawn. Mark
+     * large, opaque meshes with simple geometry, such as walls and floors.
+     */
+    bool occluder {false};
+
     /**
      * @brief Constructs a mesh instance with the given geometry and material.
      *
@@ -283,6 +283,7 @@ private:
     class Impl;
     std::unique_ptr<Impl> impl_;
 
+    friend class RenderLists;
     friend class Scene;
     auto AttachRecursive(SharedContext* context) -> void;
     /// @endcond
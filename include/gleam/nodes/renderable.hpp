@@ -26,7 +26,7 @@ namespace gleam {
  */
 class Renderable : public Node {
 public:
-    virtual ~Renderable() = default;
+    virtual ~Renderable();
 
     [[nodiscard]] virtual auto GetGeometry() -> std::shared_ptr<Geometry> = 0;
 
@@ -47,7 +47,13 @@ public:
     [[nodiscard]] static auto IsMeshType(Renderable* r) -> bool;
 
 protected:
-    Renderable() = default;
+    Renderable();
+
+private:
+    friend class Renderer;
+    friend class RenderLists;
+    class Impl;
+    std::unique_ptr<Impl> impl_;
 };
 /// @endcond
 
@@ -0,0 +1,102 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam_export.h"
+
+#include "gleam/nodes/node.hpp"
+
+#include <memory>
+
+namespace gleam {
+
+/**
+ * @brief Scene node that merges static meshes into a few combined meshes.
+ *
+ * `StaticBatch` is a container for geometry that never moves relative to the
+ * batch, such as level geometry made of many small pieces. Add meshes to the
+ * batch (directly or nested under other nodes) and call `Build()`. Every leaf
+ * mesh is then baked into a shared vertex and index buffer per material, with
+ * its vertices pre-transformed into the batch's local space.
+ *
+ * Merged geometry is split into cubic chunks of `chunk_size` world units, so
+ * each chunk is still frustum-culled on its own. The batch itself can be moved
+ * after building; only the transforms of the original meshes are baked.
+ *
+ * @code
+ * auto level = gleam::StaticBatch::Create({.chunk_size = 16.0f});
+ * for (const auto& prop : props) {
+ *     level->Add(prop);
+ * }
+ * level->Build();
+ * scene->Add(level);
+ * @endcode
+ *
+ * @note
+ * - Only opaque triangle meshes without children are merged. Instanced
+ *   meshes, sprites, meshes with children and meshes with a transparent
+ *   material are left in place, so transparent meshes are still sorted
+ *   back to front.
+ * - Merged meshes share geometry and material but no longer respond to
+ *   changes made to the original nodes.
+ *
+ * @ingroup NodesGroup
+ */
+class GLEAM_EXPORT StaticBatch : public Node {
+public:
+    /// @brief Parameters for constructing a StaticBatch object.
+    struct Parameters {
+        float chunk_size {32.0f}; ///< Edge length of a spatial chunk.
+    };
+
+    /**
+     * @brief Constructs a StaticBatch object.
+     *
+     * @param params StaticBatch::Parameters
+     */
+    explicit StaticBatch(const Parameters& params) : params_(params) {}
+
+    /**
+     * @brief Creates a shared pointer to a StaticBatch object with default parameters.
+     *
+     * @return std::shared_ptr<StaticBatch>
+     */
+    [[nodiscard]] static auto Create() {
+        return std::make_shared<StaticBatch>(Parameters {});
+    }
+
+    /**
+     * @brief Creates a shared pointer to a StaticBatch object.
+     *
+     * @param params StaticBatch::Parameters
+     * @return std::shared_ptr<StaticBatch>
+     */
+    [[nodiscard]] static auto Create(const Parameters& params) {
+        return std::make_shared<StaticBatch>(params);
+    }
+
+    /**
+     * @brief Merges all eligible descendant meshes into combined meshes.
+     *
+     * Merged meshes are removed from the hierarchy and replaced by one mesh
+     * per material, vertex layout and spatial chunk, added as direct children
+     * of the batch. Calling `Build()` again also merges meshes added since.
+     */
+    auto Build() -> void;
+
+    /**
+     * @brief Destructor.
+     */
+    ~StaticBatch() override;
+
+private:
+    /// @brief Batch parameters.
+    Parameters params_;
+};
+
+}
\ No newline at end of file
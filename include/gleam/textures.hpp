@@ -12,4 +12,5 @@
  * @brief Texture types used in materials and rendering processes.
  */
 
-#include "gleam/textures/texture_2d.hpp"
\ No newline at end of file
+#include "gleam/textures/texture_2d.hpp"
+#include "gleam/textures/texture_array.hpp"
\ No newline at end of file
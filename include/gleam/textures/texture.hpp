@@ -19,7 +19,8 @@ namespace gleam {
  * @ingroup TexturesGroup
  */
 enum class TextureType {
-    Texture2D
+    Texture2D,
+    TextureArray
 };
 
 /**
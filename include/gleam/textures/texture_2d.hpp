@@ -12,6 +12,8 @@
 #include "gleam/math/transform2.hpp"
 #include "gleam/textures/texture.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 
 namespace gleam {
@@ -47,7 +49,11 @@ public:
     /// @brief Height in pixels.
     unsigned height;
 
-    /// @brief Underlying texture data.
+    /// @brief Number of mip levels stored in data.
+    unsigned mip_levels = 1;
+
+    /// @brief Underlying texture data, followed by the data of every
+    /// mip level, each half the size of the previous one (rounded down).
     std::vector<uint8_t> data {};
 
     /// @brief Parameters for constructing a texture2D object.
@@ -55,6 +61,7 @@ public:
         unsigned width; ///< Width in pixels.
         unsigned height; ///< Height in pixels.
         std::vector<uint8_t> data; ///< Underlying texture data.
+        unsigned mip_levels = 1; ///< Number of mip levels stored in data.
     };
 
     /**
@@ -65,6 +72,7 @@ public:
     explicit Texture2D(const Parameters& params) :
         width(params.width),
         height(params.height),
+        mip_levels(params.mip_levels),
         data(std::move(params.data)) {}
 
     /**
@@ -86,6 +94,16 @@ public:
         return TextureType::Texture2D;
     }
 
+    /**
+     * @brief Returns the size of a mip level's RGBA8 data in bytes.
+     *
+     * @param level Mip level, where level 0 is the texture itself.
+     * @return std::size_t
+     */
+    [[nodiscard]] auto MipLevelSize(unsigned level) const -> std::size_t {
+        return std::size_t {std::max(width >> level, 1u)} * std::max(height >> level, 1u) * 4;
+    }
+
     /**
      * @brief Returns the transformation matrix for UV mapping.
      *
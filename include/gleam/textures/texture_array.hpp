@@ -0,0 +1,106 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam_export.h"
+
+#include "gleam/textures/texture_2d.hpp"
+
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace gleam {
+
+/**
+ * @brief Represents a stack of same-size 2D textures stored as layers of a
+ * single texture.
+ *
+ * A texture array can be assigned to any material map that accepts a
+ * Texture2D. Materials then select the layer they sample with their
+ * `texture_layer` property. Since every layer lives in the same texture,
+ * materials that share an array don't switch textures between draws, and
+ * meshes whose materials only differ in their layer can be drawn together
+ * in a single instanced draw.
+ *
+ * @code
+ * auto result = gleam::TextureArray::Pack({crate, barrel, pallet});
+ * if (!result) {
+ *   std::println(stderr, "{}", result.error());
+ *   return;
+ * }
+ *
+ * auto material = gleam::PhongMaterial::Create();
+ * material->albedo_map = result.value();
+ * material->texture_layer = 1; // barrel
+ * @endcode
+ *
+ * @ingroup TexturesGroup
+ */
+class GLEAM_EXPORT TextureArray : public Texture2D {
+public:
+    /// @brief Number of layers.
+    unsigned layers;
+
+    /// @brief Parameters for constructing a TextureArray object.
+    struct Parameters {
+        unsigned width; ///< Width of each layer in pixels.
+        unsigned height; ///< Height of each layer in pixels.
+        unsigned layers; ///< Number of layers.
+        /// Texture data of every layer, one after the other, followed
+        /// by the data of every layer for each of the next mip levels.
+        std::vector<uint8_t> data;
+        unsigned mip_levels = 1; ///< Number of mip levels stored in data.
+    };
+
+    /**
+     * @brief Constructs a TextureArray object.
+     *
+     * @param params TextureArray::Parameters
+     */
+    explicit TextureArray(const Parameters& params) :
+        Texture2D({params.width, params.height, params.data, params.mip_levels}),
+        layers(params.layers) {}
+
+    /**
+     * @brief Creates a shared pointer to a TextureArray object.
+     *
+     * @param params TextureArray::Parameters
+     * @return std::shared_ptr<TextureArray>
+     */
+    [[nodiscard]] static auto Create(const Parameters& params) {
+        return std::make_shared<TextureArray>(params);
+    }
+
+    /**
+     * @brief Packs 2D textures into the layers of a new texture array.
+     *
+     * Layers are stored in the order of the given textures. Every texture
+     * must have the same size, and textures loaded by the texture loader
+     * always share the same format. The array keeps the mip levels that
+     * all textures have. The texture transform isn't copied.
+     *
+     * @param textures Textures to pack, one per layer.
+     * @return std::expected<std::shared_ptr<TextureArray>, std::string>
+     */
+    [[nodiscard]] static auto Pack(
+        std::span<const std::shared_ptr<Texture2D>> textures
+    ) -> std::expected<std::shared_ptr<TextureArray>, std::string>;
+
+    /**
+     * @brief Returns texture type.
+     *
+     * @return TextureType::TextureArray
+     */
+    [[nodiscard]] auto GetType() const -> TextureType override {
+        return TextureType::TextureArray;
+    }
+};
+
+}
\ No newline at end of file
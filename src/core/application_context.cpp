@@ -8,13 +8,22 @@
 #include "gleam/core/application_context.hpp"
 
 #include "gleam/cameras/perspective_camera.hpp"
+#include "gleam/core/job_system.hpp"
 #include "gleam/core/shared_context.hpp"
+#include "gleam/events/scene_event.hpp"
 
 #include "core/renderer.hpp"
 #include "core/window.hpp"
+#include "events/event_dispatcher.hpp"
 
 #include "utilities/performance_graph.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 namespace gleam {
 
 namespace {
@@ -31,6 +40,15 @@ auto create_default_camera(int width, int height) {
 }
 
 struct ApplicationContext::Impl {
+    // Time spent in each stage of the last frame, in milliseconds
+    struct FrameStats {
+        double update {0.0};
+        double prepare {0.0};
+        double submit {0.0};
+    };
+
+    // Declared first so that it outlives every system submitting jobs
+    std::unique_ptr<JobSystem> jobs;
     std::unique_ptr<PerformanceGraph> performance_graph;
     std::shared_ptr<Scene> scene;
     std::shared_ptr<Camera> camera;
@@ -38,16 +56,37 @@ struct ApplicationContext::Impl {
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<SharedContext> shared_context;
 
+    // Nodes removed while a frame that may still reference them is in flight
+    std::vector<std::shared_ptr<Node>> retired_nodes;
+    std::shared_ptr<EventListener> retire_listener;
+
+    FrameStats stats;
+
+    // Scene to compile shaders for once the update stage is done, since
+    // the update may run on a worker and GL calls stay on the main thread
+    std::shared_ptr<Scene> precompile_scene;
+    std::atomic<std::size_t> pending_shaders {0};
+
+    // Set when a capture is started before the renderer exists
+    OnFrameCaptured on_frame_captured;
+
     Impl() {
         performance_graph = std::make_unique<PerformanceGraph>();
     }
 
+    auto InitializeJobs(const ApplicationContext::Parameters& params) -> void {
+        jobs = std::make_unique<JobSystem>(JobSystem::Parameters {
+            .workers = params.workers
+        });
+    }
+
     auto InitializeWindow(const ApplicationContext::Parameters& params) -> bool {
         const auto window_params = Window::Parameters {
             .width = params.width,
             .height = params.height,
             .antialiasing = params.antialiasing,
-            .vsync = params.vsync
+            .vsync = params.vsync,
+            .headless = params.headless
         };
         window = std::make_unique<Window>(window_params);
         window->SetTitle(params.title);
@@ -59,18 +98,114 @@ struct ApplicationContext::Impl {
             .debug = params.debug
         });
 
+        shared_context->jobs_ = jobs.get();
+        shared_context->loaders_.Texture->jobs_ = jobs.get();
+        shared_context->loaders_.Mesh->jobs_ = jobs.get();
+
         return window->HasErrors() ? false : true;
     }
 
     auto InitializeRenderer(const ApplicationContext::Parameters& params) -> bool {
         const auto renderer_params = Renderer::Parameters {
             .width = window->Width(),
-            .height = window->Height()
+            .height = window->Height(),
+            .jobs = jobs.get(),
+            .offscreen = params.headless,
+            .samples = params.antialiasing,
+            .occlusion_queries = params.occlusion_queries,
+            .depth_prepass = params.depth_prepass,
+            .shader_cache = params.shader_cache,
+            .async_shaders = params.async_shaders,
+            .pipelined = params.pipelined,
+            .anisotropy = params.anisotropy
         };
         renderer = std::make_unique<Renderer>(renderer_params);
         renderer->SetClearColor(params.clear_color);
+        if (on_frame_captured) {
+            renderer->StartCapture(on_frame_captured);
+            on_frame_captured = nullptr;
+        }
+        return true;
+    }
+
+    auto InitializePipeline(const ApplicationContext::Parameters& params) -> void {
+        if (!params.pipelined) return;
+
+        // Submission reads renderables through raw pointers, so nodes removed
+        // during an update are kept alive until the frame in flight is done.
+        retire_listener = std::make_shared<EventListener>([this](Event* event) {
+            retired_nodes.emplace_back(static_cast<SceneEvent*>(event)->node);
+        });
+        EventDispatcher::Get().AddEventListener("node_removed", retire_listener);
+    }
+
+    auto UpdateStage(ApplicationContext& app, float delta) -> bool {
+        const auto start_time = app.timer.GetElapsedMilliseconds();
+        if (!app.Update(delta)) return false;
+        scene->ProcessUpdates(delta);
+        const auto update_time = app.timer.GetElapsedMilliseconds();
+        renderer->Prepare(scene.get(), camera.get());
+        const auto end_time = app.timer.GetElapsedMilliseconds();
+
+        stats.update = update_time - start_time;
+        stats.prepare = end_time - update_time;
+        return true;
+    }
+
+    auto SubmitStage(ApplicationContext& app) -> void {
+        const auto start_time = app.timer.GetElapsedMilliseconds();
+        renderer->Submit();
+        stats.submit = app.timer.GetElapsedMilliseconds() - start_time;
+    }
+
+    auto PrecompileStage() -> void {
+        if (precompile_scene) {
+            renderer->Precompile(precompile_scene.get());
+            precompile_scene.reset();
+        }
+        pending_shaders.store(renderer->PendingPrograms(), std::memory_order_relaxed);
+    }
+
+    // Percentage of the opaque fragments the depth pre-pass kept from being shaded
+    auto SavedFragments() const -> double {
+        const auto stats = renderer->DepthPrepassStatsPerFrame();
+        if (stats.depth_fragments == 0) return 0.0;
+        const auto saved = stats.depth_fragments - std::min(stats.shaded_fragments, stats.depth_fragments);
+        return 100.0 * static_cast<double>(saved) / static_cast<double>(stats.depth_fragments);
+    }
+
+    auto Tick(ApplicationContext& app, float delta) -> bool {
+        if (!UpdateStage(app, delta)) return false;
+        renderer->SwapFrames();
+        SubmitStage(app);
+        PrecompileStage();
         return true;
     }
+
+    auto TickPipelined(ApplicationContext& app, float delta) -> bool {
+        // The update stage may replace the scene, which
+        // the frame being submitted still points to.
+        const auto submitted_scene = scene;
+
+        // GL calls have to stay on the main thread, so the next frame is
+        // updated and prepared on a worker while this one is submitted.
+        auto running = true;
+        auto counter = JobSystem::Counter {};
+        jobs->Run([&]() { running = UpdateStage(app, delta); }, &counter);
+        SubmitStage(app);
+        jobs->Wait(counter);
+        PrecompileStage();
+
+        renderer->SwapFrames();
+        retired_nodes.clear();
+        return running;
+    }
+
+    ~Impl() {
+        if (retire_listener) {
+            EventDispatcher::Get().RemoveEventListener("node_removed", retire_listener);
+        }
+    }
 };
 
 ApplicationContext::ApplicationContext() : impl_(std::make_unique<Impl>()) {}
@@ -78,8 +213,10 @@ ApplicationContext::ApplicationContext() : impl_(std::make_unique<Impl>()) {}
 auto ApplicationContext::Setup() -> void {
     Configure();
 
+    impl_->InitializeJobs(params);
     impl_->InitializeWindow(params);
     impl_->InitializeRenderer(params);
+    impl_->InitializePipeline(params);
 
     SetCamera(CreateCamera());
     if (!impl_->camera) {
@@ -112,16 +249,21 @@ auto ApplicationContext::Start() -> void {
             impl_->performance_graph->AddData(FramesPerSecond, frame_count);
             impl_->performance_graph->AddData(FrameTime, frame_time_ms);
             impl_->performance_graph->AddData(RenderedObjects, impl_->renderer->RenderedObjectsPerFrame());
+            impl_->performance_graph->AddData(SavedFragments, impl_->SavedFragments());
+            impl_->performance_graph->AddData(UpdateTime, impl_->stats.update);
+            impl_->performance_graph->AddData(PrepareTime, impl_->stats.prepare);
+            impl_->performance_graph->AddData(SubmitTime, impl_->stats.submit);
             frame_count = 0;
             last_frame_rate_update = now;
         }
 
-        if (Update(delta)) {
-            const auto start_time = timer.GetElapsedMilliseconds();
-            impl_->scene->ProcessUpdates(delta);
-            impl_->renderer->Render(impl_->scene.get(), impl_->camera.get());
-            const auto end_time = timer.GetElapsedMilliseconds();
+        const auto start_time = timer.GetElapsedMilliseconds();
+        const auto running = params.pipelined
+            ? impl_->TickPipelined(*this, delta)
+            : impl_->Tick(*this, delta);
+        const auto end_time = timer.GetElapsedMilliseconds();
 
+        if (running) {
             frame_time_ms = end_time - start_time;
 
             if (params.debug) {
@@ -131,6 +273,8 @@ auto ApplicationContext::Start() -> void {
             impl_->window->Break();
         }
     });
+
+    StopCapture();
 }
 
 auto ApplicationContext::GetScene() const -> Scene* {
@@ -151,6 +295,31 @@ auto ApplicationContext::SetCamera(std::shared_ptr<Camera> camera) -> void {
     impl_->camera = camera;
 }
 
+auto ApplicationContext::PrecompileShaders(std::shared_ptr<Scene> scene) -> void {
+    impl_->precompile_scene = scene;
+}
+
+auto ApplicationContext::PendingShaders() const -> std::size_t {
+    return impl_->pending_shaders.load(std::memory_order_relaxed);
+}
+
+auto ApplicationContext::StartCapture(OnFrameCaptured callback) -> void {
+    if (impl_->renderer) {
+        impl_->renderer->StartCapture(callback);
+    } else {
+        impl_->on_frame_captured = std::move(callback);
+    }
+}
+
+auto ApplicationContext::StopCapture() -> void {
+    if (impl_->renderer) impl_->renderer->StopCapture();
+    impl_->on_frame_captured = nullptr;
+}
+
+auto ApplicationContext::GetCaptureStats() const -> FrameCaptureStats {
+    return impl_->renderer ? impl_->renderer->CaptureStats() : FrameCaptureStats {};
+}
+
 ApplicationContext::~ApplicationContext() = default;
 
 }
\ No newline at end of file
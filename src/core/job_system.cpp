@@ -0,0 +1,306 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "gleam/core/job_system.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <thread>
+#include <utility>
+
+namespace gleam {
+
+namespace {
+
+struct Task {
+    JobSystem::Job job;
+    JobSystem::Counter* counter {nullptr};
+};
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+// Identifies the job system a worker thread belongs to, and its queue.
+thread_local const void* tls_owner = nullptr;
+thread_local std::size_t tls_queue = 0;
+
+}
+
+class JobSystem::Impl {
+public:
+    explicit Impl(std::size_t workers) {
+        for (auto i = std::size_t {0}; i < workers; ++i) {
+            queues_.emplace_back(std::make_unique<WorkerQueue>());
+        }
+        for (auto i = std::size_t {0}; i < workers; ++i) {
+            threads_.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    auto Push(Task task) -> void {
+        // Workers push onto their own queue, other threads spread their
+        // jobs over all queues so that no single worker becomes a hotspot.
+        const auto index = tls_owner == this
+            ? tls_queue
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+        auto& queue = *queues_[index];
+        {
+            auto lock = std::lock_guard {queue.mutex};
+            queue.tasks.emplace_back(std::move(task));
+        }
+        Wake();
+    }
+
+    auto PushBackground(Task task) -> void {
+        {
+            auto lock = std::lock_guard {background_.mutex};
+            background_.tasks.emplace_back(std::move(task));
+        }
+        Wake();
+    }
+
+    auto TryPop(Task& out) -> bool {
+        const auto n = queues_.size();
+        const auto is_worker = tls_owner == this;
+        const auto home = is_worker
+            ? tls_queue
+            : next_steal_.fetch_add(1, std::memory_order_relaxed) % n;
+
+        // A worker takes its newest job first, which is the most likely
+        // to still be in cache, and steals the oldest jobs from others.
+        if (is_worker && PopBack(*queues_[home], out)) return true;
+
+        for (auto i = std::size_t {is_worker ? 1u : 0u}; i < n; ++i) {
+            if (PopFront(*queues_[(home + i) % n], out)) return true;
+        }
+
+        return false;
+    }
+
+    // Pops a job tracked by one of the counters, leaving every other job
+    // queued, so a thread waiting for its own jobs never picks up unrelated
+    // work.
+    auto TryPop(std::span<const Counter* const> counters, Task& out) -> bool {
+        const auto n = queues_.size();
+        const auto home = tls_owner == this ? tls_queue : 0;
+        for (auto i = std::size_t {0}; i < n; ++i) {
+            auto& queue = *queues_[(home + i) % n];
+            auto lock = std::lock_guard {queue.mutex};
+            const auto it = std::ranges::find_if(queue.tasks, [&](const Task& task) {
+                return std::ranges::find(counters, task.counter) != counters.end();
+            });
+            if (it != queue.tasks.end()) {
+                out = std::move(*it);
+                queue.tasks.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto Execute(Task& task) -> void {
+        task.job();
+        if (task.counter != nullptr) Finish(task.counter);
+    }
+
+    auto Finish(Counter* counter) -> void {
+        auto ready = std::vector<Job> {};
+        {
+            auto lock = std::lock_guard {counter->mutex_};
+            if (counter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                ready.swap(counter->continuations_);
+                counter->dependencies_.clear();
+                // Notified under the lock, since a woken waiter may destroy
+                // the counter as soon as it can take the lock.
+                counter->pending_.notify_all();
+            }
+        }
+
+        for (auto& continuation : ready) continuation();
+    }
+
+    [[nodiscard]] auto WorkerCount() const {
+        return threads_.size();
+    }
+
+    ~Impl() {
+        stopping_.store(true, std::memory_order_release);
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+
+    // Long-running jobs, taken by workers when every other queue is empty
+    WorkerQueue background_;
+
+    std::vector<std::thread> threads_;
+
+    std::atomic<uint32_t> epoch_ {0};
+
+    std::atomic<std::size_t> next_queue_ {0};
+
+    std::atomic<std::size_t> next_steal_ {0};
+
+    std::atomic<bool> stopping_ {false};
+
+    auto WorkerLoop(std::size_t index) -> void {
+        tls_owner = this;
+        tls_queue = index;
+
+        while (true) {
+            const auto epoch = epoch_.load(std::memory_order_acquire);
+
+            auto task = Task {};
+            if (TryPop(task) || PopFront(background_, task)) {
+                Execute(task);
+                continue;
+            }
+
+            // Queued jobs are finished before the worker exits
+            if (stopping_.load(std::memory_order_acquire)) return;
+            epoch_.wait(epoch, std::memory_order_acquire);
+        }
+    }
+
+    auto Wake() -> void {
+        // Sleeping workers wait for the epoch to change, so a push that
+        // lands just before a worker goes to sleep is never missed.
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_one();
+    }
+
+    auto PopBack(WorkerQueue& queue, Task& out) -> bool {
+        auto lock = std::lock_guard {queue.mutex};
+        if (queue.tasks.empty()) return false;
+        out = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    auto PopFront(WorkerQueue& queue, Task& out) -> bool {
+        auto lock = std::lock_guard {queue.mutex};
+        if (queue.tasks.empty()) return false;
+        out = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+};
+
+JobSystem::JobSystem(const Parameters& params) {
+    auto workers = static_cast<std::size_t>(params.workers);
+    if (workers == 0) {
+        const auto hardware = static_cast<std::size_t>(std::thread::hardware_concurrency());
+        workers = hardware > 1 ? hardware - 1 : 1;
+    }
+    impl_ = std::make_unique<Impl>(workers);
+}
+
+auto JobSystem::Run(Job job, Counter* counter, Counter* dependency) -> void {
+    if (counter != nullptr) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+
+    auto task = Task {std::move(job), counter};
+    auto held_back = false;
+    auto inherited = std::vector<const Counter*> {};
+    if (dependency != nullptr) {
+        auto lock = std::lock_guard {dependency->mutex_};
+        if (!dependency->IsDone()) {
+            dependency->continuations_.emplace_back([impl = impl_.get(), task]() {
+                impl->Push(task);
+            });
+            held_back = true;
+            inherited = dependency->dependencies_;
+            inherited.push_back(dependency);
+        }
+    }
+
+    if (!held_back) {
+        impl_->Push(std::move(task));
+        return;
+    }
+
+    // Waiting on the counter has to be able to run the jobs the held back
+    // job depends on, or a thread waiting from inside a job could sleep on
+    // jobs queued behind itself.
+    if (counter != nullptr) {
+        auto lock = std::lock_guard {counter->mutex_};
+        counter->dependencies_.insert(counter->dependencies_.end(), inherited.begin(), inherited.end());
+    }
+}
+
+auto JobSystem::RunBackground(Job job, Counter* counter) -> void {
+    if (counter != nullptr) counter->pending_.fetch_add(1, std::memory_order_relaxed);
+    impl_->PushBackground(Task {std::move(job), counter});
+}
+
+auto JobSystem::Wait(Counter& counter) -> void {
+    auto counters = std::vector<const Counter*> {};
+    while (true) {
+        const auto pending = counter.pending_.load(std::memory_order_acquire);
+        if (pending == 0) break;
+
+        {
+            auto lock = std::lock_guard {counter.mutex_};
+            counters.assign(counter.dependencies_.begin(), counter.dependencies_.end());
+        }
+        counters.insert(counters.begin(), &counter);
+
+        auto task = Task {};
+        if (impl_->TryPop(counters, task)) {
+            impl_->Execute(task);
+            continue;
+        }
+
+        // Nothing left to help with, so sleep until the last job finishes
+        counter.pending_.wait(pending, std::memory_order_acquire);
+    }
+
+    // The last job may still hold the lock while releasing its continuations,
+    // so the counter isn't safe to destroy until the lock is released.
+    auto lock = std::lock_guard {counter.mutex_};
+}
+
+auto JobSystem::ParallelFor(
+    std::size_t count,
+    std::size_t grain,
+    const std::function<void(std::size_t begin, std::size_t end)>& fn
+) -> void {
+    if (count == 0) return;
+
+    if (grain == 0) {
+        const auto threads = WorkerCount() + 1;
+        grain = std::max(std::size_t {1}, count / (threads * 4));
+    }
+
+    auto counter = Counter {};
+    for (auto begin = grain; begin < count; begin += grain) {
+        const auto end = std::min(begin + grain, count);
+        Run([&fn, begin, end]() { fn(begin, end); }, &counter);
+    }
+
+    fn(0, std::min(grain, count));
+    Wait(counter);
+}
+
+auto JobSystem::WorkerCount() const -> std::size_t {
+    return impl_->WorkerCount();
+}
+
+JobSystem::~JobSystem() = default;
+
+}
\ No newline at end of file
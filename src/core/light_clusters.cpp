@@ -0,0 +1,170 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "core/light_clusters.hpp"
+
+#include "gleam/math/vector3.hpp"
+#include "gleam/math/vector4.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace gleam {
+
+namespace {
+
+// Orthographic projections may start at zero depth, which has no logarithm
+constexpr auto kMinNear = 0.01f;
+
+auto unproject(const Matrix4& inverse, float x, float y, float z) {
+    const auto p = inverse * Vector4 {x, y, z, 1.0f};
+    return Vector3 {p.x / p.w, p.y / p.w, p.z / p.w};
+}
+
+// Point at the given view depth on the line through two view-space points
+auto at_depth(const Vector3& a, const Vector3& b, float depth) {
+    const auto t = (-depth - a.z) / (b.z - a.z);
+    return a + (b - a) * t;
+}
+
+}
+
+auto LightClusters::Build(std::span<const Sphere> lights, const Matrix4& projection) -> void {
+    if (clusters_.empty() || projection != projection_) {
+        BuildBounds(projection);
+    }
+
+    for (auto& list : lights_) list.clear();
+
+    const auto bin = [&](std::size_t begin, std::size_t end) {
+        for (auto slice = begin; slice < end; ++slice) {
+            BinSlice(lights, static_cast<int>(slice));
+        }
+    };
+
+    if (jobs_ == nullptr || lights.size() < kMinParallelLights) {
+        bin(0, kSlices);
+    } else {
+        jobs_->ParallelFor(kSlices, 1, bin);
+    }
+
+    indices_.clear();
+    for (auto i = 0; i < kClusters; ++i) {
+        clusters_[i] = {
+            .offset = static_cast<uint32_t>(indices_.size()),
+            .count = static_cast<uint32_t>(lights_[i].size())
+        };
+        indices_.insert(indices_.end(), lights_[i].begin(), lights_[i].end());
+    }
+}
+
+auto LightClusters::Slice(float depth) const -> int {
+    const auto slice = std::floor(std::log(std::max(depth, near_)) * depth_scale_ + depth_bias_);
+    return std::clamp(static_cast<int>(slice), 0, kSlices - 1);
+}
+
+auto LightClusters::BuildBounds(const Matrix4& projection) -> void {
+    projection_ = projection;
+    const auto inverse = Inverse(projection);
+
+    const auto near = std::max(-unproject(inverse, 0.0f, 0.0f, -1.0f).z, kMinNear);
+    const auto far = std::max(-unproject(inverse, 0.0f, 0.0f, 1.0f).z, near * 2.0f);
+    near_ = near;
+    depth_scale_ = static_cast<float>(kSlices) / std::log(far / near);
+    depth_bias_ = -std::log(near) * depth_scale_;
+
+    slice_depths_.resize(kSlices + 1);
+    for (auto s = 0; s <= kSlices; ++s) {
+        slice_depths_[s] = near * std::pow(far / near, static_cast<float>(s) / kSlices);
+    }
+
+    for (auto* v : {&min_x_, &min_y_, &min_z_, &max_x_, &max_y_, &max_z_}) {
+        v->resize(kClusters);
+    }
+    lights_.resize(kClusters);
+    clusters_.resize(kClusters);
+
+    for (auto y = 0; y < kTilesY; ++y) {
+        for (auto x = 0; x < kTilesX; ++x) {
+            // Lines from the near to the far plane through the tile's corners
+            auto corners = std::array<std::array<Vector3, 2>, 4> {};
+            for (auto c = 0; c < 4; ++c) {
+                const auto ndc_x = -1.0f + 2.0f * static_cast<float>(x + (c & 1)) / kTilesX;
+                const auto ndc_y = -1.0f + 2.0f * static_cast<float>(y + (c >> 1)) / kTilesY;
+                corners[c] = {
+                    unproject(inverse, ndc_x, ndc_y, -1.0f),
+                    unproject(inverse, ndc_x, ndc_y, 1.0f)
+                };
+            }
+
+            for (auto s = 0; s < kSlices; ++s) {
+                auto min = Vector3 {std::numeric_limits<float>::max()};
+                auto max = Vector3 {std::numeric_limits<float>::lowest()};
+                for (const auto& [a, b] : corners) {
+                    for (const auto depth : {slice_depths_[s], slice_depths_[s + 1]}) {
+                        const auto p = at_depth(a, b, depth);
+                        min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+                        max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+                    }
+                }
+
+                const auto i = (s * kTilesY + y) * kTilesX + x;
+                min_x_[i] = min.x;
+                min_y_[i] = min.y;
+                min_z_[i] = min.z;
+                max_x_[i] = max.x;
+                max_y_[i] = max.y;
+                max_z_[i] = max.z;
+            }
+        }
+    }
+}
+
+auto LightClusters::BinSlice(std::span<const Sphere> lights, int slice) -> void {
+    const auto base = static_cast<std::size_t>(slice) * kTiles;
+    const auto min_x = min_x_.data() + base;
+    const auto min_y = min_y_.data() + base;
+    const auto min_z = min_z_.data() + base;
+    const auto max_x = max_x_.data() + base;
+    const auto max_y = max_y_.data() + base;
+    const auto max_z = max_z_.data() + base;
+    const auto near = slice_depths_[slice];
+    const auto far = slice_depths_[slice + 1];
+
+    auto hits = std::array<int32_t, kTiles> {};
+    for (auto i = std::size_t {0}; i < lights.size(); ++i) {
+        const auto& light = lights[i];
+        const auto depth = -light.center.z;
+        if (depth + light.radius < near || depth - light.radius > far) continue;
+
+        // Squared distance from the light to the bounds of every tile. The
+        // center is clamped into the bounds instead of taking the larger of
+        // the distances to each side, and the result is stored as a 32-bit
+        // mask, which keeps the loop free of branches, so GCC vectorizes it
+        // at -O3 (check with -fopt-info-vec).
+        const auto c = light.center;
+        const auto radius_sq = light.radius * light.radius;
+        for (auto t = 0; t < kTiles; ++t) {
+            const auto dx = c.x - std::clamp(c.x, min_x[t], max_x[t]);
+            const auto dy = c.y - std::clamp(c.y, min_y[t], max_y[t]);
+            const auto dz = c.z - std::clamp(c.z, min_z[t], max_z[t]);
+            hits[t] = dx * dx + dy * dy + dz * dz <= radius_sq;
+        }
+
+        // Appending to the lists branches, so this loop stays scalar
+        for (auto t = 0; t < kTiles; ++t) {
+            auto& list = lights_[base + t];
+            if (hits[t] && list.size() < kMaxLightsPerCluster) {
+                list.emplace_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+}
+
+}
\ No newline at end of file
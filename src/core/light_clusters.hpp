@@ -0,0 +1,100 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/core/job_system.hpp"
+#include "gleam/math/matrix4.hpp"
+#include "gleam/math/sphere.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gleam {
+
+// Bins lights into a view-space froxel grid for clustered forward shading.
+// The view frustum is split into kTilesX by kTilesY screen tiles and kSlices
+// depth slices, spaced exponentially so that clusters stay roughly cubic
+// from near to far. Each cluster stores the offset and count of its lights in
+// a shared index list, so a fragment only loops over the lights that can
+// reach its cluster.
+//
+// Lights are binned one depth slice per job. Cluster bounds are stored one
+// component per array, so a light is tested against every tile of a slice
+// with contiguous loads (see BinSlice()).
+class LightClusters {
+public:
+    static constexpr auto kTilesX = 16;
+    static constexpr auto kTilesY = 9;
+    static constexpr auto kSlices = 24;
+    static constexpr auto kTiles = kTilesX * kTilesY;
+    static constexpr auto kClusters = kTiles * kSlices;
+
+    // Bounds the cost of a fragment, lights past it are dropped from the cluster
+    static constexpr std::size_t kMaxLightsPerCluster = 256;
+
+    // Fewer lights are binned on the calling thread
+    static constexpr std::size_t kMinParallelLights = 64;
+
+    // Range of a cluster's lights in Indices()
+    struct Cluster {
+        uint32_t offset {0};
+        uint32_t count {0};
+    };
+
+    explicit LightClusters(JobSystem* jobs = nullptr) : jobs_(jobs) {}
+
+    // Bins lights given as bounding spheres in view space. Cluster bounds
+    // are only recomputed when the projection changes.
+    auto Build(std::span<const Sphere> lights, const Matrix4& projection) -> void;
+
+    [[nodiscard]] auto Clusters() const -> std::span<const Cluster> { return clusters_; }
+
+    [[nodiscard]] auto Indices() const -> std::span<const uint32_t> { return indices_; }
+
+    // A fragment at view depth d is in slice floor(log(d) * scale + bias)
+    [[nodiscard]] auto DepthScale() const { return depth_scale_; }
+
+    [[nodiscard]] auto DepthBias() const { return depth_bias_; }
+
+    [[nodiscard]] auto Slice(float depth) const -> int;
+
+private:
+    std::vector<float> min_x_;
+    std::vector<float> min_y_;
+    std::vector<float> min_z_;
+    std::vector<float> max_x_;
+    std::vector<float> max_y_;
+    std::vector<float> max_z_;
+
+    // View depth of the near side of every slice, and of the far plane
+    std::vector<float> slice_depths_;
+
+    std::vector<std::vector<uint32_t>> lights_;
+
+    std::vector<Cluster> clusters_;
+
+    std::vector<uint32_t> indices_;
+
+    Matrix4 projection_;
+
+    JobSystem* jobs_ {nullptr};
+
+    float near_ {0.0f};
+
+    float depth_scale_ {0.0f};
+
+    float depth_bias_ {0.0f};
+
+    auto BuildBounds(const Matrix4& projection) -> void;
+
+    auto BinSlice(std::span<const Sphere> lights, int slice) -> void;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "core/object_lights.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace gleam {
+
+namespace {
+
+// Lights tested per pass before the hits are collected
+constexpr auto kBlockSize = std::size_t {64};
+
+}
+
+auto ObjectLights::Assign(
+    std::span<const Sphere> objects,
+    const Matrix4& view,
+    std::span<const Sphere> lights
+) -> void {
+    x_.resize(lights.size());
+    y_.resize(lights.size());
+    z_.resize(lights.size());
+    radius_.resize(lights.size());
+    for (auto i = std::size_t {0}; i < lights.size(); ++i) {
+        x_[i] = lights[i].center.x;
+        y_[i] = lights[i].center.y;
+        z_[i] = lights[i].center.z;
+        radius_[i] = lights[i].radius;
+    }
+
+    // Every draw owns a fixed run of indices, so draws are assigned
+    // independently and the result doesn't depend on scheduling.
+    assignments_.resize(objects.size());
+    indices_.resize(objects.size() * kMaxLightsPerObject);
+
+    const auto assign = [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            auto sphere = objects[i];
+            if (!sphere.IsEmpty()) sphere.ApplyTransform(view);
+            AssignObject(sphere, i);
+        }
+    };
+
+    if (jobs_ == nullptr || lights.empty() || objects.size() < kMinParallelObjects) {
+        assign(0, objects.size());
+    } else {
+        jobs_->ParallelFor(objects.size(), 0, assign);
+    }
+
+    has_clustered_ = std::ranges::any_of(assignments_, &Assignment::clustered);
+}
+
+auto ObjectLights::AssignObject(const Sphere& object, std::size_t index) -> void {
+    auto& assignment = assignments_[index];
+    assignment = {.offset = static_cast<uint32_t>(index * kMaxLightsPerObject)};
+    if (object.IsEmpty()) return;
+
+    const auto c = object.center;
+    const auto n = x_.size();
+    auto hits = std::array<bool, kBlockSize> {};
+    for (auto begin = std::size_t {0}; begin < n; begin += kBlockSize) {
+        const auto size = std::min(kBlockSize, n - begin);
+        const auto x = x_.data() + begin;
+        const auto y = y_.data() + begin;
+        const auto z = z_.data() + begin;
+        const auto radius = radius_.data() + begin;
+
+        for (auto j = std::size_t {0}; j < size; ++j) {
+            const auto dx = x[j] - c.x;
+            const auto dy = y[j] - c.y;
+            const auto dz = z[j] - c.z;
+            const auto reach = radius[j] + object.radius;
+            hits[j] = dx * dx + dy * dy + dz * dz <= reach * reach;
+        }
+
+        for (auto j = std::size_t {0}; j < size; ++j) {
+            if (!hits[j]) continue;
+            if (assignment.count == kMaxLightsPerObject) {
+                assignment.count = 0;
+                assignment.clustered = true;
+                return;
+            }
+            indices_[assignment.offset + assignment.count++] = static_cast<uint32_t>(begin + j);
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/core/job_system.hpp"
+#include "gleam/math/matrix4.hpp"
+#include "gleam/math/sphere.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gleam {
+
+// Assigns point and spot lights to the draws they can reach, by testing the
+// range of every light against the bounding sphere of every draw. A draw
+// reached by up to kMaxLightsPerObject lights only shades those, and its
+// program is chosen by their count rounded up to a power of two. Draws
+// reached by more lights than that fall back to the light clusters.
+//
+// Lights are stored one component per array, so a draw is tested against a
+// block of lights in a loop without branches that the compiler vectorizes.
+class ObjectLights {
+public:
+    static constexpr std::size_t kMaxLightsPerObject = 8;
+
+    // Fewer draws are assigned on the calling thread
+    static constexpr std::size_t kMinParallelObjects = 256;
+
+    // Range of a draw's lights in Indices()
+    struct Assignment {
+        uint32_t offset {0};
+        uint32_t count {0};
+        bool clustered {false};
+    };
+
+    explicit ObjectLights(JobSystem* jobs = nullptr) : jobs_(jobs) {}
+
+    // Assigns lights given as bounding spheres in view space to draws given
+    // as bounding spheres in world space. Empty spheres are never lit.
+    auto Assign(
+        std::span<const Sphere> objects,
+        const Matrix4& view,
+        std::span<const Sphere> lights
+    ) -> void;
+
+    [[nodiscard]] auto Assignments() const -> std::span<const Assignment> { return assignments_; }
+
+    [[nodiscard]] auto Indices() const -> std::span<const uint32_t> { return indices_; }
+
+    // Whether any draw is reached by too many lights and uses the clusters
+    [[nodiscard]] auto HasClustered() const { return has_clustered_; }
+
+private:
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> z_;
+    std::vector<float> radius_;
+
+    std::vector<Assignment> assignments_;
+
+    std::vector<uint32_t> indices_;
+
+    JobSystem* jobs_ {nullptr};
+
+    bool has_clustered_ {false};
+
+    auto AssignObject(const Sphere& object, std::size_t index) -> void;
+};
+
+}
\ No newline at end of file
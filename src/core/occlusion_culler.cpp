@@ -0,0 +1,263 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "core/occlusion_culler.hpp"
+
+#include "gleam/math/vector3.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace gleam {
+
+namespace {
+
+// Points on or behind the near plane have no meaningful screen position
+auto behind_near_plane(const Vector4& clip) {
+    return clip.w <= 0.0f || clip.z < -clip.w;
+}
+
+auto edge_key(std::size_t a, std::size_t b) {
+    return (static_cast<uint64_t>(std::min(a, b)) << 32) | static_cast<uint64_t>(std::max(a, b));
+}
+
+auto to_screen(const Vector4& clip) {
+    const auto inv_w = 1.0f / clip.w;
+    return Vector3 {
+        (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::kWidth),
+        (clip.y * inv_w * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::kHeight),
+        clip.z * inv_w * 0.5f + 0.5f
+    };
+}
+
+}
+
+auto OcclusionCuller::Update(std::span<Mesh* const> occluders, const Matrix4& view_projection) -> void {
+    active_ = !occluders.empty();
+    if (!active_) return;
+
+    if (levels_.empty()) {
+        auto width = kWidth;
+        auto height = kHeight;
+        while (true) {
+            levels_.emplace_back(width, height, std::vector<float>(width * height));
+            if (width == 1 && height == 1) break;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+    }
+
+    view_projection_ = view_projection;
+    std::ranges::fill(levels_[0].depth, 1.0f);
+
+    auto clip = std::vector<Vector4> {};
+    auto edges = std::unordered_map<uint64_t, int> {};
+    for (auto mesh : occluders) {
+        const auto geometry = mesh->GetGeometry();
+        const auto stride = geometry->Stride();
+        const auto vertex_count = geometry->VertexCount();
+        const auto& data = geometry->VertexData();
+        const auto& indices = geometry->IndexData();
+        if (vertex_count == 0 || !geometry->HasAttribute(VertexAttributeType::Position)) continue;
+
+        auto offset = std::size_t {0};
+        for (const auto& attribute : geometry->Attributes()) {
+            if (attribute.type == VertexAttributeType::Position) break;
+            offset += attribute.item_size;
+        }
+
+        const auto mvp = view_projection * mesh->GetWorldTransform();
+        clip.resize(vertex_count);
+        for (auto i = std::size_t {0}; i < vertex_count; ++i) {
+            const auto* v = data.data() + i * stride + offset;
+            clip[i] = mvp * Vector4 {v[0], v[1], v[2], 1.0f};
+        }
+
+        const auto count = indices.empty() ? vertex_count : indices.size();
+        const auto vertex = [&](std::size_t i) -> std::size_t {
+            return indices.empty() ? i : indices[i];
+        };
+
+        // Edges shared by two triangles are inside the occluder, and only
+        // the others make up its silhouette.
+        edges.clear();
+        for (auto i = std::size_t {0}; i + 2 < count; i += 3) {
+            for (auto e = 0; e < 3; ++e) {
+                ++edges[edge_key(vertex(i + (e + 1) % 3), vertex(i + (e + 2) % 3))];
+            }
+        }
+
+        for (auto i = std::size_t {0}; i + 2 < count; i += 3) {
+            auto silhouette = std::array<bool, 3> {};
+            for (auto e = 0; e < 3; ++e) {
+                silhouette[e] = edges[edge_key(vertex(i + (e + 1) % 3), vertex(i + (e + 2) % 3))] < 2;
+            }
+            RasterizeTriangle(clip[vertex(i)], clip[vertex(i + 1)], clip[vertex(i + 2)], silhouette);
+        }
+    }
+
+    BuildPyramid();
+}
+
+auto OcclusionCuller::RasterizeTriangle(
+    const Vector4& a,
+    const Vector4& b,
+    const Vector4& c,
+    std::array<bool, 3> silhouette
+) -> void {
+    // Dropping a triangle only lets more objects through, so triangles
+    // that cross the near plane are skipped instead of clipped.
+    if (behind_near_plane(a) || behind_near_plane(b) || behind_near_plane(c)) return;
+
+    auto s = std::array {to_screen(a), to_screen(b), to_screen(c)};
+    auto area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[1].y - s[0].y) * (s[2].x - s[0].x);
+    if (area == 0.0f) return;
+
+    // Occluders hide objects with either side, so back faces are rewound
+    if (area < 0.0f) {
+        std::swap(s[1], s[2]);
+        std::swap(silhouette[1], silhouette[2]);
+        area = -area;
+    }
+
+    const auto x0 = std::max(0, static_cast<int>(std::floor(std::min({s[0].x, s[1].x, s[2].x}))));
+    const auto x1 = std::min(kWidth, static_cast<int>(std::ceil(std::max({s[0].x, s[1].x, s[2].x}))));
+    const auto y0 = std::max(0, static_cast<int>(std::floor(std::min({s[0].y, s[1].y, s[2].y}))));
+    const auto y1 = std::min(kHeight, static_cast<int>(std::ceil(std::max({s[0].y, s[1].y, s[2].y}))));
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Edge i is opposite vertex i. Past the silhouette, a texel is only
+    // written when the triangle covers all of it, so silhouette edges are
+    // moved inwards by the most their function changes between the texel's
+    // center and a corner. Texels on inner edges are written by the
+    // triangle that covers their center, as the other one covers the rest.
+    auto ea = std::array<float, 3> {};
+    auto eb = std::array<float, 3> {};
+    auto ec = std::array<float, 3> {};
+    auto offset = std::array<float, 3> {};
+    for (auto i = 0; i < 3; ++i) {
+        const auto& from = s[(i + 1) % 3];
+        const auto& to = s[(i + 2) % 3];
+        ea[i] = from.y - to.y;
+        eb[i] = to.x - from.x;
+        offset[i] = silhouette[i] ? 0.5f * (std::abs(ea[i]) + std::abs(eb[i])) : 0.0f;
+        ec[i] = -(ea[i] * from.x + eb[i] * from.y) - offset[i];
+    }
+
+    // Depth is affine in screen space after the perspective divide. The
+    // farthest depth within the texel is written, so the texel never claims
+    // to hide anything the triangle doesn't.
+    const auto inv_area = 1.0f / area;
+    const auto dz1 = (s[1].z - s[0].z) * inv_area;
+    const auto dz2 = (s[2].z - s[0].z) * inv_area;
+    const auto dzdx = ea[1] * dz1 + ea[2] * dz2;
+    const auto dzdy = eb[1] * dz1 + eb[2] * dz2;
+    // The moved edge functions are offset from the weights they interpolate
+    // depth with, so the offsets are folded into the base depth.
+    const auto z_base = s[0].z + 0.5f * (std::abs(dzdx) + std::abs(dzdy)) +
+        offset[1] * dz1 + offset[2] * dz2;
+
+    auto& depth = levels_[0].depth;
+    const auto px0 = static_cast<float>(x0) + 0.5f;
+    for (auto y = y0; y < y1; ++y) {
+        const auto py = static_cast<float>(y) + 0.5f;
+        const auto e0 = ea[0] * px0 + eb[0] * py + ec[0];
+        const auto e1 = ea[1] * px0 + eb[1] * py + ec[1];
+        const auto e2 = ea[2] * px0 + eb[2] * py + ec[2];
+        auto* row = depth.data() + y * kWidth + x0;
+
+        // Branchless, so the compiler vectorizes the span
+        for (auto i = 0; i < x1 - x0; ++i) {
+            const auto fi = static_cast<float>(i);
+            const auto w0 = e0 + ea[0] * fi;
+            const auto w1 = e1 + ea[1] * fi;
+            const auto w2 = e2 + ea[2] * fi;
+            const auto z = z_base + w1 * dz1 + w2 * dz2;
+            const auto inside = (w0 >= 0.0f) & (w1 >= 0.0f) & (w2 >= 0.0f);
+            row[i] = inside ? std::min(row[i], z) : row[i];
+        }
+    }
+}
+
+auto OcclusionCuller::BuildPyramid() -> void {
+    for (auto level = std::size_t {1}; level < levels_.size(); ++level) {
+        const auto& src = levels_[level - 1];
+        auto& dst = levels_[level];
+        for (auto y = 0; y < dst.height; ++y) {
+            const auto sy0 = std::min(y * 2, src.height - 1);
+            const auto sy1 = std::min(y * 2 + 1, src.height - 1);
+            for (auto x = 0; x < dst.width; ++x) {
+                const auto sx0 = std::min(x * 2, src.width - 1);
+                const auto sx1 = std::min(x * 2 + 1, src.width - 1);
+                dst.depth[y * dst.width + x] = std::max({
+                    src.depth[sy0 * src.width + sx0],
+                    src.depth[sy0 * src.width + sx1],
+                    src.depth[sy1 * src.width + sx0],
+                    src.depth[sy1 * src.width + sx1]
+                });
+            }
+        }
+    }
+}
+
+auto OcclusionCuller::IsOccluded(const Sphere& sphere) const -> bool {
+    if (!active_) return false;
+
+    // The corners of the sphere's bounding box enclose its projection,
+    // and the nearest corner is at least as near as the sphere.
+    auto min_x = static_cast<float>(kWidth);
+    auto min_y = static_cast<float>(kHeight);
+    auto max_x = 0.0f;
+    auto max_y = 0.0f;
+    auto min_z = 1.0f;
+    for (auto i = 0; i < 8; ++i) {
+        const auto corner = Vector4 {
+            sphere.center.x + (i & 1 ? sphere.radius : -sphere.radius),
+            sphere.center.y + (i & 2 ? sphere.radius : -sphere.radius),
+            sphere.center.z + (i & 4 ? sphere.radius : -sphere.radius),
+            1.0f
+        };
+        const auto clip = view_projection_ * corner;
+        if (behind_near_plane(clip)) return false;
+
+        const auto screen = to_screen(clip);
+        min_x = std::min(min_x, screen.x);
+        min_y = std::min(min_y, screen.y);
+        max_x = std::max(max_x, screen.x);
+        max_y = std::max(max_y, screen.y);
+        min_z = std::min(min_z, screen.z);
+    }
+
+    const auto x0 = std::clamp(static_cast<int>(min_x), 0, kWidth - 1);
+    const auto x1 = std::clamp(static_cast<int>(max_x), 0, kWidth - 1);
+    const auto y0 = std::clamp(static_cast<int>(min_y), 0, kHeight - 1);
+    const auto y1 = std::clamp(static_cast<int>(max_y), 0, kHeight - 1);
+
+    // Picks the level where the bounds span at most two texels per axis
+    const auto extent = static_cast<unsigned>(std::max(x1 - x0, y1 - y0));
+    const auto level_index = std::min(
+        static_cast<std::size_t>(std::bit_width(extent)),
+        levels_.size() - 1
+    );
+    const auto& level = levels_[level_index];
+    const auto shift = static_cast<int>(level_index);
+
+    auto max_depth = 0.0f;
+    for (auto y = std::min(y0 >> shift, level.height - 1); y <= std::min(y1 >> shift, level.height - 1); ++y) {
+        for (auto x = std::min(x0 >> shift, level.width - 1); x <= std::min(x1 >> shift, level.width - 1); ++x) {
+            max_depth = std::max(max_depth, level.depth[y * level.width + x]);
+        }
+    }
+
+    return min_z > max_depth;
+}
+
+}
\ No newline at end of file
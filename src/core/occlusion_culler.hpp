@@ -0,0 +1,69 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/math/matrix4.hpp"
+#include "gleam/math/sphere.hpp"
+#include "gleam/math/vector4.hpp"
+#include "gleam/nodes/mesh.hpp"
+
+#include <array>
+#include <span>
+#include <vector>
+
+namespace gleam {
+
+// Software occlusion culling. Meshes marked as occluders are rasterized into
+// a low-resolution depth buffer, which is reduced into a pyramid where every
+// texel holds the farthest depth of the four below it. A bounding sphere is
+// occluded when its nearest depth is behind the farthest depth of the few
+// pyramid texels that cover its screen bounds. Occluders only write texels
+// that they cover entirely, with the farthest depth they have in the texel,
+// so a texel never hides more than its occluders do.
+//
+// Depth follows GL conventions and ranges from 0 at the near plane to 1 at
+// the far plane. Tests only read the pyramid, so they're safe to run from
+// several threads once Update() returns.
+class OcclusionCuller {
+public:
+    static constexpr auto kWidth = 256;
+    static constexpr auto kHeight = 128;
+
+    auto Update(std::span<Mesh* const> occluders, const Matrix4& view_projection) -> void;
+
+    // Expects a sphere in world space
+    [[nodiscard]] auto IsOccluded(const Sphere& sphere) const -> bool;
+
+    // True when occluders were rasterized in the last update
+    [[nodiscard]] auto IsActive() const { return active_; }
+
+private:
+    struct Level {
+        int width {0};
+        int height {0};
+        std::vector<float> depth;
+    };
+
+    std::vector<Level> levels_;
+
+    Matrix4 view_projection_;
+
+    bool active_ {false};
+
+    // Silhouette flags are per edge, with edge i opposite vertex i
+    auto RasterizeTriangle(
+        const Vector4& a,
+        const Vector4& b,
+        const Vector4& c,
+        std::array<bool, 3> silhouette
+    ) -> void;
+
+    auto BuildPyramid() -> void;
+};
+
+}
\ No newline at end of file
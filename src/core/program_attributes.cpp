@@ -17,68 +17,133 @@
 
 #include "utilities/logger.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
 
 namespace gleam {
 
+namespace {
+
+auto is_array(const Texture* texture) {
+    return texture != nullptr && texture->GetType() == TextureType::TextureArray;
+}
+
+// Albedo and alpha maps of the built-in materials
+auto material_maps(const Material* material) -> std::pair<const Texture*, const Texture*> {
+    switch (material->GetType()) {
+        case MaterialType::PhongMaterial: {
+            auto m = static_cast<const PhongMaterial*>(material);
+            return {m->albedo_map.get(), m->alpha_map.get()};
+        }
+        case MaterialType::SpriteMaterial: {
+            auto m = static_cast<const SpriteMaterial*>(material);
+            return {m->albedo_map.get(), m->alpha_map.get()};
+        }
+        case MaterialType::UnlitMaterial: {
+            auto m = static_cast<const UnlitMaterial*>(material);
+            return {m->albedo_map.get(), m->alpha_map.get()};
+        }
+        default:
+            return {nullptr, nullptr};
+    }
+}
+
+}
+
 ProgramAttributes::ProgramAttributes(
     Renderable* renderable,
     const LightsCounter& lights,
-    const Scene* scene
+    const Scene* scene,
+    bool batched
 ) {
     auto geometry = renderable->GetGeometry().get();
     auto material = renderable->GetMaterial().get();
 
     type = material->GetType();
 
-    if (type == MaterialType::PhongMaterial) {
-        auto m = static_cast<const PhongMaterial*>(material);
-        color = true;
-        albedo_map = m->albedo_map != nullptr;
-        alpha_map = m->alpha_map != nullptr;
-    }
-
     if (type == MaterialType::ShaderMaterial) {
         auto m = static_cast<const ShaderMaterial*>(material);
         vertex_shader = m->vertex_shader_;
         fragment_shader = m->fragment_shader_;
-    }
-
-    if (type == MaterialType::SpriteMaterial) {
-        auto m = static_cast<const SpriteMaterial*>(material);
+    } else {
+        const auto [albedo, alpha] = material_maps(material);
         color = true;
-        albedo_map = m->albedo_map != nullptr;
-        alpha_map = m->alpha_map != nullptr;
-    }
-
-    if (type == MaterialType::UnlitMaterial) {
-        auto m = static_cast<const UnlitMaterial*>(material);
-        color = true;
-        albedo_map = m->albedo_map != nullptr;
-        alpha_map = m->alpha_map != nullptr;
+        albedo_map = albedo != nullptr;
+        alpha_map = alpha != nullptr;
+        albedo_array = is_array(albedo);
+        alpha_array = is_array(alpha);
     }
 
     flat_shaded = material->flat_shaded;
     fog = material->fog && scene->fog != nullptr;
-    instancing = renderable->GetNodeType() == NodeType::InstancedMeshNode;
-    num_lights = lights.directional + lights.point + lights.spot;
+    instancing = batched || renderable->GetNodeType() == NodeType::InstancedMeshNode;
     two_sided = material->two_sided;
     vertex_color = geometry->HasAttribute(VertexAttributeType::Color);
 
+    // Only Phong materials are lit, so lights don't multiply the other programs
+    if (type == MaterialType::PhongMaterial) {
+        num_lights = lights.directional;
+        num_object_lights = lights.local;
+        clustered_lights = lights.clustered;
+    }
+
     static_assert(std::to_underlying(MaterialType::Length) <= 15);
 
     key |= (std::to_underlying(type) & 0xF); // (0–15) → 4 bits
     key |= (color ? 1 : 0)  << 4; // 1 bit
     key |= (flat_shaded ? 1 : 0) << 9; // 1 bit
     key |= (fog ? 1 : 0) << 10; // 1 bit
-    key |= (lights.directional & 0xF) << 5; // (0–15) → 4 bits
-    key |= (lights.point & 0xF) << 11; // (0–15) → 4 bits
-    key |= (lights.spot & 0xF) << 15; // (0–15) → 4 bits
+    key |= (num_lights & 0xF) << 5; // (0–15) → 4 bits
+    key |= (clustered_lights ? 1 : 0) << 11; // 1 bit
+    key |= (num_object_lights & 0xF) << 12; // (0–15) → 4 bits
     key |= (albedo_map ? 1 : 0) << 19; // 1 bit
     key |= (alpha_map ? 1 : 0) << 20; // 1 bit
     key |= (two_sided ? 1 : 0) << 21; // 1 bit
     key |= (instancing ? 1 : 0) << 22; // 1 bit
     key |= (vertex_color ? 1 : 0) << 23; // 1 bit
+    key |= (albedo_array ? 1 : 0) << 25; // 1 bit
+    key |= (alpha_array ? 1 : 0) << 26; // 1 bit
+}
+
+auto ProgramAttributes::MaterialFeatures(const Material* material) -> uint32_t {
+    const auto [albedo, alpha] = material_maps(material);
+    auto features = uint32_t {0};
+    features |= (albedo != nullptr ? 1 : 0);
+    features |= (alpha != nullptr ? 1 : 0) << 1;
+    features |= (is_array(albedo) ? 1 : 0) << 2;
+    features |= (is_array(alpha) ? 1 : 0) << 3;
+    features |= (material->flat_shaded ? 1 : 0) << 4;
+    features |= (material->fog ? 1 : 0) << 5;
+    features |= (material->two_sided ? 1 : 0) << 6;
+    return features;
+}
+
+auto ProgramAttributes::LightBucket(unsigned count, unsigned max) -> uint8_t {
+    if (count == 0) return 0;
+    return static_cast<uint8_t>(std::min(std::bit_ceil(count), max));
+}
+
+auto ProgramAttributes::DepthOnly() const -> ProgramAttributes {
+    auto attrs = *this;
+    attrs.depth_only = true;
+    attrs.num_lights = 0;
+    attrs.num_object_lights = 0;
+    attrs.albedo_map = false;
+    attrs.alpha_map = false;
+    attrs.albedo_array = false;
+    attrs.alpha_array = false;
+    attrs.clustered_lights = false;
+    attrs.color = false;
+    attrs.flat_shaded = false;
+    attrs.fog = false;
+    attrs.two_sided = false;
+    attrs.vertex_color = false;
+
+    attrs.key = 0;
+    attrs.key |= (instancing ? 1 : 0) << 22; // 1 bit
+    attrs.key |= std::size_t {1} << 24; // 1 bit
+    return attrs;
 }
 
 }
\ No newline at end of file
@@ -17,10 +17,17 @@
 namespace gleam {
 
 struct ProgramAttributes {
+    // Light counts of a draw, rounded up with LightBucket() by the caller.
+    // Programs loop over the rounded count and skip the unused lights, so a
+    // light entering the scene only changes the programs of the draws whose
+    // bucket it crosses.
     struct LightsCounter {
         uint8_t directional {0};
-        uint8_t point {0};
-        uint8_t spot {0};
+        // Point and spot lights assigned to the draw (see ObjectLights)
+        uint8_t local {0};
+        // Point and spot lights are looked up in light clusters,
+        // so only their presence changes the program.
+        bool clustered {false};
     };
 
     std::size_t key {0};
@@ -32,9 +39,17 @@ struct ProgramAttributes {
     std::string_view fragment_shader;
 
     uint8_t num_lights {0};
+    uint8_t num_object_lights {0};
+
+    // Position-only program for the depth pre-pass
+    bool depth_only {false};
 
     bool albedo_map {false};
     bool alpha_map {false};
+    // Maps that are texture arrays, sampled at the material's layer
+    bool albedo_array {false};
+    bool alpha_array {false};
+    bool clustered_lights {false};
     bool color {false};
     bool flat_shaded {false};
     bool fog {false};
@@ -45,8 +60,24 @@ struct ProgramAttributes {
     ProgramAttributes(
         Renderable* renderable,
         const LightsCounter& lights,
-        const Scene* scene
+        const Scene* scene,
+        bool batched = false
     );
+
+    // Material properties that select shader features: which maps are set
+    // and whether they're arrays, flat shading, fog and two-sided lighting.
+    // Materials expose them as plain members, so caches compare this
+    // signature to notice when they change.
+    [[nodiscard]] static auto MaterialFeatures(const Material* material) -> uint32_t;
+
+    // Rounds a light count up to the next power of two, capped at the
+    // given maximum, which is the number of lights a program loops over.
+    [[nodiscard]] static auto LightBucket(unsigned count, unsigned max) -> uint8_t;
+
+    // Attributes of the position-only variant of this program. Only
+    // instancing changes how positions are computed, so every material
+    // shares one of two depth-only programs.
+    [[nodiscard]] auto DepthOnly() const -> ProgramAttributes;
 };
 
 }
\ No newline at end of file
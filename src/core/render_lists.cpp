@@ -7,36 +7,413 @@
 
 #include "core/render_lists.hpp"
 
-#include <ranges>
-#include <limits>
+#include "gleam/materials/phong_material.hpp"
+#include "gleam/materials/unlit_material.hpp"
+#include "gleam/nodes/mesh.hpp"
+#include "gleam/nodes/sprite.hpp"
+
+#include "core/program_attributes.hpp"
+#include "nodes/instanced_mesh_impl.hpp"
+#include "nodes/node_impl.hpp"
+#include "nodes/renderable_impl.hpp"
+
+#include <array>
+#include <bit>
+#include <type_traits>
+#include <utility>
 
 namespace gleam {
 
-// Compare function for sorting meshes based on their z position.
+namespace {
+
+enum class RenderLayer : uint64_t {
+    Opaque = 0,
+    Transparent = 1
+};
+
+// Folds an identity, such as a pointer, into a small, well-distributed integer.
+// Equal identities always produce equal values, which is all the sort key
+// needs to group draws.
+auto fold(uint64_t x, int bits) -> uint64_t {
+    return (x * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+}
+
+auto fold_pointer(const void* ptr, int bits) -> uint64_t {
+    return fold(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)), bits);
+}
+
+// Maps a float to an unsigned integer that preserves the float's ordering.
+auto ordered_bits(float value) -> uint32_t {
+    const auto bits = std::bit_cast<uint32_t>(value);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+// Opaque: | layer:2 | program:24 | material:12 | geometry:10 | depth:16 |
+// State changes are ordered by cost (program, then material, then vertex array)
+// and draws that share the same state are rendered front-to-back.
+auto opaque_key(uint64_t program, uint64_t material, Geometry* geometry, float depth) {
+    auto key = std::to_underlying(RenderLayer::Opaque) << 62;
+    key |= (program & 0xFFFFFF) << 38;
+    key |= fold(material, 12) << 26;
+    key |= fold_pointer(geometry, 10) << 16;
+    key |= ordered_bits(depth) >> 16;
+    return key;
+}
+
+// Transparent: | layer:2 | depth:32 | program:24 | material:6 |
+// Depth is inverted so that transparent draws are rendered back-to-front.
+auto transparent_key(uint64_t program, Material* material, float depth) {
+    auto key = std::to_underlying(RenderLayer::Transparent) << 62;
+    key |= static_cast<uint64_t>(~ordered_bits(depth)) << 30;
+    key |= (program & 0xFFFFFF) << 6;
+    key |= fold_pointer(material, 6);
+    return key;
+}
+
+auto is_array(const Texture* texture) {
+    return texture != nullptr && texture->GetType() == TextureType::TextureArray;
+}
+
+// Texture array a batchable material samples at its texture layer, if any
+auto texture_array(const Material* material) -> const Texture* {
+    auto array = [](const auto* m) -> const Texture* {
+        if (is_array(m->albedo_map.get())) return m->albedo_map.get();
+        if (is_array(m->alpha_map.get())) return m->alpha_map.get();
+        return nullptr;
+    };
+    if (material->GetType() == MaterialType::PhongMaterial) {
+        return array(static_cast<const PhongMaterial*>(material));
+    }
+    if (material->GetType() == MaterialType::UnlitMaterial) {
+        return array(static_cast<const UnlitMaterial*>(material));
+    }
+    return nullptr;
+}
+
+auto texture_layer(const Material* material) {
+    if (material->GetType() == MaterialType::PhongMaterial) {
+        return static_cast<float>(static_cast<const PhongMaterial*>(material)->texture_layer);
+    }
+    if (material->GetType() == MaterialType::UnlitMaterial) {
+        return static_cast<float>(static_cast<const UnlitMaterial*>(material)->texture_layer);
+    }
+    return 0.0f;
+}
+
+// Materials that sample the same texture arrays and only differ in their
+// texture layer render the same way apart from the layer, which batches
+// pass per instance, so their meshes can share a batch.
+auto layer_variants(const Material* a, const Material* b) {
+    if (a->GetType() != b->GetType() || texture_array(a) == nullptr) return false;
+
+    const auto same_state =
+        a->opacity == b->opacity &&
+        a->polygon_offset_factor == b->polygon_offset_factor &&
+        a->polygon_offset_units == b->polygon_offset_units &&
+        a->fog == b->fog &&
+        a->two_sided == b->two_sided &&
+        a->depth_test == b->depth_test &&
+        a->transparent == b->transparent &&
+        a->flat_shaded == b->flat_shaded &&
+        a->blending == b->blending;
+    if (!same_state) return false;
+
+    if (a->GetType() == MaterialType::PhongMaterial) {
+        const auto pa = static_cast<const PhongMaterial*>(a);
+        const auto pb = static_cast<const PhongMaterial*>(b);
+        return pa->color == pb->color &&
+            pa->specular == pb->specular &&
+            pa->shininess == pb->shininess &&
+            pa->albedo_map == pb->albedo_map &&
+            pa->alpha_map == pb->alpha_map;
+    }
+
+    const auto ua = static_cast<const UnlitMaterial*>(a);
+    const auto ub = static_cast<const UnlitMaterial*>(b);
+    return ua->color == ub->color &&
+        ua->albedo_map == ub->albedo_map &&
+        ua->alpha_map == ub->alpha_map;
+}
+
+// Identity shared by a material and its layer variants: the texture array
+// combined with every property layer_variants() compares. Materials that
+// share an array but differ in anything else sort apart, like any two
+// unrelated materials.
+auto layer_variant_group(const Material* material, const Texture* array) {
+    auto hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(array));
+    const auto mix = [&hash](auto value) {
+        using Bits = std::conditional_t<sizeof(value) == 8, uint64_t, uint32_t>;
+        hash = (hash ^ static_cast<uint64_t>(std::bit_cast<Bits>(value))) * 0x100000001B3ull;
+    };
+    const auto mix_color = [&mix](const Color& color) {
+        mix(color.r);
+        mix(color.g);
+        mix(color.b);
+    };
+
+    mix(static_cast<uint32_t>(material->GetType()));
+    mix(material->opacity);
+    mix(material->polygon_offset_factor);
+    mix(material->polygon_offset_units);
+    mix(static_cast<uint32_t>(material->blending));
+    mix(static_cast<uint32_t>(
+        material->fog << 0 |
+        material->two_sided << 1 |
+        material->depth_test << 2 |
+        material->transparent << 3 |
+        material->flat_shaded << 4
+    ));
 
+    const auto maps = [&mix](const auto* m) {
+        mix(reinterpret_cast<uintptr_t>(m->albedo_map.get()));
+        mix(reinterpret_cast<uintptr_t>(m->alpha_map.get()));
+    };
+    if (material->GetType() == MaterialType::PhongMaterial) {
+        const auto m = static_cast<const PhongMaterial*>(material);
+        mix_color(m->color);
+        mix_color(m->specular);
+        mix(m->shininess);
+        maps(m);
+    } else {
+        const auto m = static_cast<const UnlitMaterial*>(material);
+        mix_color(m->color);
+        maps(m);
+    }
+    return hash;
+}
+
+// Occluders are drawn regardless of occlusion, since they'd be tested
+// against a depth buffer that already contains them.
+auto is_occluder(Renderable* renderable) {
+    return renderable->GetNodeType() == NodeType::MeshNode &&
+        static_cast<Mesh*>(renderable)->occluder &&
+        !renderable->GetMaterial()->transparent;
+}
+
+// World bounding sphere of a renderable. Bounding spheres are cached lazily,
+// so this is only called on the thread that owns the scene.
+auto world_bounds(Renderable* renderable, const Matrix4& world) {
+    if (renderable->GetNodeType() == NodeType::SpriteNode) return Sphere {};
+    auto sphere = static_cast<Mesh*>(renderable)->BoundingSphere();
+    sphere.ApplyTransform(world);
+    return sphere;
+}
+
+// Local bounding box of a renderable, cached lazily like bounding spheres
+auto local_box(Renderable* renderable) {
+    if (renderable->GetNodeType() == NodeType::SpriteNode) return Box3 {};
+    return static_cast<Mesh*>(renderable)->BoundingBox();
+}
+
+// Stable LSD radix sort on 64-bit keys. Passes where every key shares the same
+// digit are skipped, which is common since the upper bits encode few states.
+auto radix_sort(
+    std::vector<RenderLists::RenderItem>& items,
+    std::vector<RenderLists::RenderItem>& scratch
+) {
+    const auto n = items.size();
+    if (n < 2) return;
+    scratch.resize(n);
+
+    auto histograms = std::array<std::array<size_t, 256>, 8> {};
+    for (const auto& item : items) {
+        for (auto pass = 0; pass < 8; ++pass) {
+            ++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+        }
+    }
+
+    auto* src = &items;
+    auto* dst = &scratch;
+    for (auto pass = 0; pass < 8; ++pass) {
+        auto& counts = histograms[pass];
+        const auto shift = pass * 8;
+        if (counts[((*src)[0].key >> shift) & 0xFF] == n) continue;
+
+        auto offset = size_t {0};
+        for (auto& count : counts) {
+            offset += std::exchange(count, offset);
+        }
+
+        for (const auto& item : *src) {
+            (*dst)[counts[(item.key >> shift) & 0xFF]++] = item;
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != &items) items.swap(scratch);
+}
+
+}
 
 auto RenderLists::ProcessScene(Scene* scene, Camera* camera) -> void {
     Reset();
 
-    const auto frustum = camera->GetFrustum();
     for (const auto& child : scene->Children()) {
-        ProcessNode(child.get(), frustum);
+        ProcessNode(child.get());
     }
 
-    const auto c = camera->GetWorldPosition();
-    const auto f = camera->ViewForward();
-    const auto compare = [&](auto* renderable) {
-        return Dot(renderable->GetWorldPosition() - c, f);
+    // Occluders are rasterized up front, so that every
+    // candidate is tested against the complete depth pyramid.
+    occlusion_.Update(occluders_, camera->projection_transform * camera->view_transform);
+
+    const auto params = CullParameters {
+        .frustum = camera->GetFrustum(),
+        .occlusion = occlusion_.IsActive() ? &occlusion_ : nullptr,
+        .camera_position = camera->GetWorldPosition(),
+        .camera_forward = camera->ViewForward(),
+        .scene = scene,
+        .fog = static_cast<uint32_t>(scene->fog != nullptr)
     };
 
-    // Sort opaque renderables front-to-back to optimize depth buffer writes.
-    std::ranges::stable_sort(opaque_, std::ranges::less {}, compare);
+    const auto n = candidates_.size();
+    if (jobs_ == nullptr || n < kMinParallelCandidates) {
+        Cull(candidates_, params, items_);
+    } else {
+        // Every chunk is culled into its own list. Lists are merged in
+        // chunk order, so the result doesn't depend on scheduling.
+        const auto threads = jobs_->WorkerCount() + 1;
+        const auto grain = (n + threads - 1) / threads;
+        chunks_.resize(threads);
+        jobs_->ParallelFor(n, grain, [&](std::size_t begin, std::size_t end) {
+            auto& chunk = chunks_[begin / grain];
+            chunk.clear();
+            Cull(std::span {candidates_}.subspan(begin, end - begin), params, chunk);
+        });
+
+        for (const auto& chunk : chunks_) {
+            items_.insert(items_.end(), chunk.begin(), chunk.end());
+        }
+    }
+
+    radix_sort(items_, scratch_);
 
-    // Sort transparent renderables back-to-front to ensure correct blending.
-    std::ranges::stable_sort(transparent_, std::ranges::greater {}, compare);
+    for (const auto& item : items_) {
+        item.key >> 62 == std::to_underlying(RenderLayer::Opaque)
+            ? opaque_.emplace_back(item.renderable)
+            : transparent_.emplace_back(item.renderable);
+    }
+
+    BuildBatches();
+
+    for (auto renderable : transparent_) {
+        const auto& transform = renderable->Node::impl_->world_transform;
+        transforms_.emplace_back(transform);
+        bounds_.emplace_back(world_bounds(renderable, transform));
+        boxes_.emplace_back(local_box(renderable));
+        SnapshotState(renderable);
+    }
 }
 
-auto RenderLists::ProcessNode(Node* node, const Frustum& frustum) -> void {
+auto RenderLists::Cull(
+    std::span<const Candidate> candidates,
+    const CullParameters& params,
+    std::vector<RenderItem>& out
+) -> void {
+    // Runs on worker threads. World transforms are read directly since
+    // GetWorldTransform() may update the hierarchy below the node, and every
+    // renderable's sort cache is only ever touched by the worker culling it.
+    for (const auto& [renderable, local_sphere] : candidates) {
+        const auto& world = renderable->Node::impl_->world_transform;
+
+        if (renderable->GetNodeType() != NodeType::SpriteNode) {
+            auto sphere = local_sphere;
+            sphere.ApplyTransform(world);
+            if (!params.frustum.IntersectsWithSphere(sphere)) continue;
+            if (params.occlusion != nullptr && !is_occluder(renderable) &&
+                params.occlusion->IsOccluded(sphere)) continue;
+        }
+
+        auto material = renderable->GetMaterial();
+        auto geometry = renderable->GetGeometry();
+
+        // The camera looks down its negative z-axis, so the view depth of
+        // a renderable is its distance along the inverted view forward axis.
+        const auto position = Vector3 {world[3].x, world[3].y, world[3].z};
+        const auto depth = -Dot(position - params.camera_position, params.camera_forward);
+
+        // Light counts are identical for every draw in a frame, so the
+        // program key without lights is enough to group draws by program.
+        auto& cache = renderable->impl_->sort;
+        if (!cache.IsCurrent(geometry, material, params.fog)) {
+            cache.attrs.emplace(renderable, ProgramAttributes::LightsCounter {}, params.scene);
+            cache.Track(geometry, material, params.fog);
+        }
+        const auto program = cache.attrs->key;
+
+        if (material->transparent) {
+            out.emplace_back(transparent_key(program, material.get(), depth), renderable);
+            continue;
+        }
+
+        // Materials that only differ in the layer of a shared texture array
+        // are sorted as one, so that their meshes end up adjacent.
+        const auto array = CanBatch(renderable) ? texture_array(material.get()) : nullptr;
+        const auto group = array != nullptr
+            ? layer_variant_group(material.get(), array)
+            : static_cast<uint64_t>(reinterpret_cast<uintptr_t>(material.get()));
+        out.emplace_back(opaque_key(program, group, geometry.get(), depth), renderable);
+    }
+}
+
+// Plain meshes drawn with a built-in material can be folded into an instanced
+// draw. Wireframe rendering swaps the geometry and shader materials may not
+// consume the instance attributes, so both are drawn individually.
+auto RenderLists::CanBatch(Renderable* renderable) -> bool {
+    if (renderable->GetNodeType() != NodeType::MeshNode) return false;
+    auto material = renderable->GetMaterial().get();
+    return !material->wireframe && material->GetType() != MaterialType::ShaderMaterial;
+}
+
+auto RenderLists::BuildBatches() -> void {
+    // Opaque renderables are sorted by program, material and geometry,
+    // so meshes that can share an instanced draw are already adjacent.
+    const auto n = opaque_.size();
+    auto i = std::size_t {0};
+    while (i < n) {
+        auto renderable = opaque_[i];
+        auto j = i + 1;
+
+        if (CanBatch(renderable)) {
+            auto material = renderable->GetMaterial().get();
+            auto geometry = renderable->GetGeometry();
+            while (j < n && CanBatch(opaque_[j]) &&
+                   opaque_[j]->GetGeometry() == geometry &&
+                   (opaque_[j]->GetMaterial().get() == material ||
+                    layer_variants(material, opaque_[j]->GetMaterial().get()))) {
+                ++j;
+            }
+        }
+
+        if (j - i >= kMinBatchSize) {
+            batches_.emplace_back(renderable, instance_transforms_.size(), j - i);
+            transforms_.emplace_back(Matrix4::Identity());
+            boxes_.emplace_back();
+            states_.emplace_back();
+            auto& bounds = bounds_.emplace_back();
+            const auto layer = texture_layer(renderable->GetMaterial().get());
+            for (auto k = i; k < j; ++k) {
+                const auto& transform = opaque_[k]->Node::impl_->world_transform;
+                instance_transforms_.emplace_back(transform);
+                instance_normals_.emplace_back(NormalMatrix(transform));
+                instance_layers_.emplace_back(texture_layer(opaque_[k]->GetMaterial().get()) - layer);
+                bounds.Union(world_bounds(opaque_[k], transform));
+            }
+        } else {
+            for (auto k = i; k < j; ++k) {
+                batches_.emplace_back(opaque_[k]);
+                const auto& transform = opaque_[k]->Node::impl_->world_transform;
+                transforms_.emplace_back(transform);
+                bounds_.emplace_back(world_bounds(opaque_[k], transform));
+                boxes_.emplace_back(local_box(opaque_[k]));
+                SnapshotState(opaque_[k]);
+            }
+        }
+
+        i = j;
+    }
+}
+
+auto RenderLists::ProcessNode(Node* node) -> void {
     const auto type = node->GetNodeType();
 
     if (node->IsRenderable()) {
@@ -45,11 +422,17 @@ auto RenderLists::ProcessNode(Node* node, const Frustum& frustum) -> void {
 
         if (!material->visible) return;
         if (!Renderable::CanRender(renderable)) return;
-        if (!Renderable::IsInFrustum(renderable, frustum)) return;
 
-        renderable->GetMaterial()->transparent
-            ? transparent_.emplace_back(renderable)
-            : opaque_.emplace_back(renderable);
+        // Bounding spheres are cached lazily and geometries may be shared, so
+        // they're read here rather than on the worker threads.
+        auto sphere = type == NodeType::SpriteNode
+            ? Sphere {}
+            : static_cast<Mesh*>(renderable)->BoundingSphere();
+        candidates_.emplace_back(renderable, sphere);
+
+        if (is_occluder(renderable)) {
+            occluders_.emplace_back(static_cast<Mesh*>(renderable));
+        }
     }
 
     if (type == NodeType::LightNode) {
@@ -57,14 +440,72 @@ auto RenderLists::ProcessNode(Node* node, const Frustum& frustum) -> void {
     }
 
     for (const auto& child : node->Children()) {
-        ProcessNode(child.get(), frustum);
+        ProcessNode(child.get());
     }
 }
 
 auto RenderLists::Reset() -> void {
+    candidates_.clear();
+    items_.clear();
     opaque_.clear();
     transparent_.clear();
     lights_.clear();
+    occluders_.clear();
+    batches_.clear();
+    instance_transforms_.clear();
+    instance_normals_.clear();
+    instance_layers_.clear();
+    transforms_.clear();
+    bounds_.clear();
+    boxes_.clear();
+    states_.clear();
+    instance_count_ = 0;
+}
+
+auto RenderLists::SnapshotState(Renderable* renderable) -> void {
+    auto& state = states_.emplace_back();
+
+    if (renderable->GetNodeType() == NodeType::SpriteNode) {
+        const auto sprite = static_cast<Sprite*>(renderable);
+        state.anchor = sprite->anchor;
+        state.rotation = sprite->rotation;
+        return;
+    }
+
+    if (renderable->GetNodeType() != NodeType::InstancedMeshNode) return;
+
+    if (instance_count_ == instances_.size()) instances_.emplace_back();
+    state.instance_data = static_cast<int>(instance_count_);
+    auto& data = instances_[instance_count_];
+
+    // Versions are only read here, and the renderer tracks what it uploaded,
+    // so a draw that's skipped doesn't lose changes to its instances.
+    const auto mesh = static_cast<InstancedMesh*>(renderable);
+    const auto& impl = *mesh->impl_;
+    data.mesh = mesh;
+    data.transforms_version = impl.transforms_version;
+    data.colors_version = impl.colors_version;
+    data.layers_version = impl.layers_version;
+
+    if (!copy_instances_) {
+        data.transforms = mesh->transforms_;
+        data.normals = impl.normal_matrices;
+        data.colors = mesh->colors_;
+        data.layers = mesh->layers_;
+        ++instance_count_;
+        return;
+    }
+
+    if (instance_count_ == instance_copies_.size()) instance_copies_.emplace_back();
+    auto& copy = instance_copies_[instance_count_++];
+    copy.transforms.assign(mesh->transforms_.begin(), mesh->transforms_.end());
+    copy.normals.assign(impl.normal_matrices.begin(), impl.normal_matrices.end());
+    copy.colors.assign(mesh->colors_.begin(), mesh->colors_.end());
+    copy.layers.assign(mesh->layers_.begin(), mesh->layers_.end());
+    data.transforms = copy.transforms;
+    data.normals = copy.normals;
+    data.colors = copy.colors;
+    data.layers = copy.layers;
 }
 
 }
\ No newline at end of file
@@ -8,12 +8,24 @@
 #pragma once
 
 #include "gleam/cameras/camera.hpp"
+#include "gleam/core/job_system.hpp"
 #include "gleam/lights/light.hpp"
+#include "gleam/math/box3.hpp"
+#include "gleam/math/color.hpp"
 #include "gleam/math/frustum.hpp"
+#include "gleam/math/matrix3.hpp"
+#include "gleam/math/matrix4.hpp"
+#include "gleam/math/sphere.hpp"
+#include "gleam/math/vector2.hpp"
+#include "gleam/math/vector3.hpp"
+#include "gleam/nodes/instanced_mesh.hpp"
 #include "gleam/nodes/node.hpp"
 #include "gleam/nodes/renderable.hpp"
 #include "gleam/nodes/scene.hpp"
 
+#include "core/occlusion_culler.hpp"
+
+#include <cstdint>
 #include <memory>
 #include <span>
 #include <vector>
@@ -22,12 +34,121 @@ namespace gleam {
 
 class RenderLists {
 public:
+    struct RenderItem {
+        uint64_t key {0};
+        Renderable* renderable {nullptr};
+    };
+
+    // A draw in the opaque pass. Runs of meshes that share geometry and
+    // material are collapsed into a single batch whose world transforms are
+    // stored contiguously in InstanceTransforms(), starting at first_instance,
+    // with their normal matrices at the same indices in InstanceNormals().
+    // Materials that sample texture arrays and only differ in their texture
+    // layer share batches too, and InstanceLayers() holds the layer of every
+    // instance relative to the layer of the batch's material.
+    // Batches with an instance count of zero are drawn as regular renderables.
+    struct RenderBatch {
+        Renderable* renderable {nullptr};
+        std::size_t first_instance {0};
+        std::size_t instance_count {0};
+    };
+
+    // Per-draw state that renderables hold outside of their transforms and
+    // that's read while rendering: the anchor and rotation of sprites, and
+    // the index of an instanced mesh's InstanceData, or -1 for other draws.
+    struct DrawState {
+        Vector2 anchor {};
+        float rotation {0.0f};
+        int instance_data {-1};
+    };
+
+    // Instance data of an instanced mesh. The arrays point to the mesh
+    // itself, or to a copy made when the frame is prepared if the lists copy
+    // instances. The versions change whenever the mesh changes an array, so
+    // renderers that keep them in GPU buffers only upload what changed since
+    // their last upload. Layers are empty until the first layer is set.
+    struct InstanceData {
+        InstancedMesh* mesh {nullptr};
+        std::span<const Matrix4> transforms;
+        std::span<const Matrix3> normals;
+        std::span<const Color> colors;
+        std::span<const float> layers;
+        uint32_t transforms_version {0};
+        uint32_t colors_version {0};
+        uint32_t layers_version {0};
+    };
+
+    static constexpr std::size_t kMinBatchSize = 2;
+
+    // Whether the renderable may be folded into an instanced draw. The
+    // renderer uses it to know which programs need an instanced variant.
+    [[nodiscard]] static auto CanBatch(Renderable* renderable) -> bool;
+
+    // Lists that copy instances keep the instance data of instanced meshes
+    // valid while the meshes change, e.g. when the next frame is updated on
+    // another thread. Otherwise it's only valid until the meshes change.
+    explicit RenderLists(JobSystem* jobs = nullptr, bool copy_instances = false) :
+        jobs_(jobs),
+        copy_instances_(copy_instances) {}
+
+    // Scenes with fewer renderables than this are culled on the calling
+    // thread, since distributing the work would cost more than it saves.
+    static constexpr std::size_t kMinParallelCandidates = 2048;
+
+    // Expects world transforms to be up to date, i.e. the scene's transform
+    // hierarchy was updated earlier in the frame.
     auto ProcessScene(Scene* scene, Camera* camera) -> void;
 
     [[nodiscard]] auto Opaque() const -> std::span<Renderable* const> {
         return opaque_;
     }
 
+    [[nodiscard]] auto OpaqueBatches() const -> std::span<const RenderBatch> {
+        return batches_;
+    }
+
+    [[nodiscard]] auto InstanceTransforms() const -> std::span<const Matrix4> {
+        return instance_transforms_;
+    }
+
+    [[nodiscard]] auto InstanceNormals() const -> std::span<const Matrix3> {
+        return instance_normals_;
+    }
+
+    [[nodiscard]] auto InstanceLayers() const -> std::span<const float> {
+        return instance_layers_;
+    }
+
+    // World transform of every draw in submission order, i.e. the opaque
+    // batches followed by the transparent renderables. Instanced batches
+    // carry their transforms as instance data and store the identity here.
+    [[nodiscard]] auto Transforms() const -> std::span<const Matrix4> {
+        return transforms_;
+    }
+
+    // World bounding sphere of every draw in submission order. Instanced
+    // batches store the union of their instances, and sprites an empty sphere.
+    [[nodiscard]] auto Bounds() const -> std::span<const Sphere> {
+        return bounds_;
+    }
+
+    // Local bounding box of every draw in submission order, so that the
+    // renderer never reads the lazily cached bounds of a geometry while the
+    // next frame is prepared. Instanced batches and sprites store an empty box.
+    [[nodiscard]] auto LocalBoxes() const -> std::span<const Box3> {
+        return boxes_;
+    }
+
+    // Draw state of every draw in submission order, so that values nodes
+    // may change during the next frame's update are never read live.
+    [[nodiscard]] auto DrawStates() const -> std::span<const DrawState> {
+        return states_;
+    }
+
+    [[nodiscard]] auto Instances() const -> std::span<const InstanceData> {
+        return std::span {instances_}.first(instance_count_);
+    }
+
     [[nodiscard]] auto Transparent() const -> std::span<Renderable* const> {
         return transparent_;
     }
@@ -37,15 +158,88 @@ public:
     }
 
 private:
+    JobSystem* jobs_ {nullptr};
+
+    bool copy_instances_ {false};
+
+    // A renderable that passed the per-node checks during traversal, along
+    // with its local bounding sphere, waiting to be culled and keyed.
+    struct Candidate {
+        Renderable* renderable {nullptr};
+        Sphere sphere {};
+    };
+
+    struct CullParameters {
+        Frustum frustum;
+        const OcclusionCuller* occlusion {nullptr};
+        Vector3 camera_position;
+        Vector3 camera_forward;
+        Scene* scene {nullptr};
+        uint32_t fog {0};
+    };
+
+    std::vector<Candidate> candidates_;
+
+    std::vector<std::vector<RenderItem>> chunks_;
+
+    std::vector<RenderItem> items_;
+
+    std::vector<RenderItem> scratch_;
+
     std::vector<Renderable*> opaque_;
 
     std::vector<Renderable*> transparent_;
 
     std::vector<Light*> lights_;
 
-    auto ProcessNode(Node* node, const Frustum& frustum) -> void;
+    std::vector<Mesh*> occluders_;
+
+    OcclusionCuller occlusion_;
+
+    std::vector<RenderBatch> batches_;
+
+    std::vector<Matrix4> instance_transforms_;
+
+    std::vector<Matrix3> instance_normals_;
+
+    std::vector<float> instance_layers_;
+
+    std::vector<Matrix4> transforms_;
+
+    std::vector<Sphere> bounds_;
+
+    std::vector<Box3> boxes_;
+
+    std::vector<DrawState> states_;
+
+    std::vector<InstanceData> instances_;
+
+    // Copies of the instance arrays, at the same indices as instances_.
+    // Kept across frames, so the copies reuse their storage.
+    struct InstanceCopy {
+        std::vector<Matrix4> transforms;
+        std::vector<Matrix3> normals;
+        std::vector<Color> colors;
+        std::vector<float> layers;
+    };
+
+    std::vector<InstanceCopy> instance_copies_;
+
+    std::size_t instance_count_ {0};
+
+    auto BuildBatches() -> void;
+
+    auto Cull(
+        std::span<const Candidate> candidates,
+        const CullParameters& params,
+        std::vector<RenderItem>& out
+    ) -> void;
+
+    auto ProcessNode(Node* node) -> void;
 
     auto Reset() -> void;
+
+    auto SnapshotState(Renderable* renderable) -> void;
 };
 
 }
\ No newline at end of file
@@ -7,25 +7,79 @@
 
 #include "core/renderer.hpp"
 
+#include "renderer/gl/gl_recorder.hpp"
 #include "renderer/gl/gl_renderer_impl.hpp"
+#include "renderer/software/sw_renderer_impl.hpp"
+
+#include "utilities/logger.hpp"
 
 namespace gleam {
 
-Renderer::Renderer(const Renderer::Parameters& params)
-    : impl_(std::make_unique<Impl>(params)) {}
+Renderer::Renderer(const Renderer::Parameters& params) {
+    // GL resources are created as soon as the implementation is
+    // constructed, so the recording backend is installed first.
+    if (params.backend == Backend::Recording && !GLRecorder::Install()) {
+        Logger::Log(LogLevel::Error, "Failed to install the GL recorder");
+    }
+    if (params.backend == Backend::Software) {
+        impl_ = std::make_unique<SoftwareImpl>(params);
+    } else {
+        impl_ = std::make_unique<GLImpl>(params);
+    }
+}
 
 auto Renderer::Render(Scene* scene, Camera* camera) -> void {
     impl_->Render(scene, camera);
 }
 
+auto Renderer::Prepare(Scene* scene, Camera* camera) -> void {
+    impl_->Prepare(scene, camera);
+}
+
+auto Renderer::Submit() -> void {
+    impl_->Submit();
+}
+
+auto Renderer::SwapFrames() -> void {
+    impl_->SwapFrames();
+}
+
 auto Renderer::SetClearColor(const Color &color) -> void {
     impl_->SetClearColor(color);
 }
 
+auto Renderer::StartCapture(const OnFrameCaptured& callback) -> void {
+    impl_->StartCapture(callback);
+}
+
+auto Renderer::StopCapture() -> void {
+    impl_->StopCapture();
+}
+
+auto Renderer::CaptureStats() const -> FrameCaptureStats {
+    return impl_->CaptureStats();
+}
+
 auto Renderer::RenderedObjectsPerFrame() const -> size_t {
     return impl_->RenderedObjectsPerFrame();
 }
 
+auto Renderer::DepthPrepassStatsPerFrame() const -> DepthPrepassStats {
+    return impl_->DepthPrepassStatsPerFrame();
+}
+
+auto Renderer::StateCacheStatsPerFrame() const -> StateCacheStats {
+    return impl_->StateCacheStatsPerFrame();
+}
+
+auto Renderer::Precompile(Scene* scene) -> void {
+    impl_->Precompile(scene);
+}
+
+auto Renderer::PendingPrograms() -> std::size_t {
+    return impl_->PendingPrograms();
+}
+
 Renderer::~Renderer() = default;
 
 }
\ No newline at end of file
@@ -8,32 +8,121 @@
 #pragma once
 
 #include "gleam/cameras/camera.hpp"
+#include "gleam/core/frame_capture.hpp"
+#include "gleam/core/job_system.hpp"
 #include "gleam/math/color.hpp"
 #include "gleam/nodes/scene.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <memory>
 
 namespace gleam {
 
 class Renderer {
 public:
+    enum class Backend {
+        OpenGL,
+        // Records GL calls instead of executing them (see GLRecorder)
+        Recording,
+        // Rasterizes on the CPU without a GL context (see SoftwareImpl)
+        Software
+    };
+
     struct Parameters {
         int width;
         int height;
+        JobSystem* jobs {nullptr};
+        Backend backend {Backend::OpenGL};
+        // Renders into an offscreen framebuffer of the given size instead
+        // of the default framebuffer, multisampled when samples > 0.
+        bool offscreen {false};
+        int samples {0};
+        // Skips large meshes that were hidden in the previous
+        // frame, using GPU occlusion queries (see GLOcclusionQueries).
+        bool occlusion_queries {false};
+        // Draws the opaque list depth-only before shading it, so that
+        // each pixel is shaded once (see GLDepthPrepass).
+        bool depth_prepass {false};
+        // Directory where linked shader programs are cached between runs
+        // (see GLProgramCache). An empty path disables the cache.
+        std::filesystem::path shader_cache {};
+        // Compiles shader programs in the background when the driver
+        // supports it. Objects are skipped until their programs are ready.
+        bool async_shaders {false};
+        // Prepares frames while the previous one is submitted, so instance
+        // data of instanced meshes is copied into each frame.
+        bool pipelined {false};
+        // Maximum anisotropy of texture filtering. Values above 1 are
+        // clamped to what the driver supports, and ignored without it.
+        float anisotropy {1.0f};
+    };
+
+    // Fragments of the opaque list that passed the depth test in the depth
+    // pre-pass and in the color pass, read back a few frames late. Without
+    // the pre-pass, the color pass would shade as many as the pre-pass.
+    struct DepthPrepassStats {
+        uint64_t depth_fragments {0};
+        uint64_t shaded_fragments {0};
+    };
+
+    // Calls to the GL state cache in a frame, and how many of them would
+    // have set state that was already current and never reached the driver.
+    struct StateCacheStats {
+        uint64_t calls {0};
+        uint64_t skipped {0};
     };
 
     explicit Renderer(const Renderer::Parameters& params);
 
+    // Prepares and submits a frame.
     auto Render(Scene* scene, Camera* camera) -> void;
 
+    // Frames can also be rendered in two stages. Prepare() builds a snapshot
+    // of the scene on the CPU without issuing GL calls, and Submit() draws the
+    // last snapshot made current by SwapFrames(). Preparing the next frame on
+    // another thread while the current one is submitted is safe, as long as
+    // SwapFrames() is only called once both are done.
+    auto Prepare(Scene* scene, Camera* camera) -> void;
+
+    auto Submit() -> void;
+
+    auto SwapFrames() -> void;
+
     auto SetClearColor(const Color& color) -> void;
 
+    // Reads every submitted frame back without blocking and passes it to
+    // the callback a few frames later (see GLFrameCapture). Stopping
+    // waits for the frames still in flight and delivers them.
+    auto StartCapture(const OnFrameCaptured& callback) -> void;
+
+    auto StopCapture() -> void;
+
+    [[nodiscard]] auto CaptureStats() const -> FrameCaptureStats;
+
     [[nodiscard]] auto RenderedObjectsPerFrame() const -> size_t;
 
+    [[nodiscard]] auto DepthPrepassStatsPerFrame() const -> DepthPrepassStats;
+
+    [[nodiscard]] auto StateCacheStatsPerFrame() const -> StateCacheStats;
+
+    // Starts compiling every program the renderables in the scene can be
+    // drawn with, given its lights and fog, e.g. during a loading screen.
+    // Programs are compiled in the background with async shaders enabled,
+    // and before returning otherwise.
+    auto Precompile(Scene* scene) -> void;
+
+    // Number of programs still compiling in the background. Pending
+    // programs that finished are made ready first, without blocking.
+    [[nodiscard]] auto PendingPrograms() -> std::size_t;
+
     ~Renderer();
 
 private:
     class Impl;
+    class GLImpl;
+    class SoftwareImpl;
     std::unique_ptr<Impl> impl_;
 };
 
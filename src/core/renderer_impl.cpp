@@ -0,0 +1,67 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "core/renderer_impl.hpp"
+
+namespace gleam {
+
+Renderer::Impl::Impl(const Renderer::Parameters& params)
+  : params_(params) {
+    for (auto& frame : frames_) {
+        frame = std::make_unique<Frame>(params.jobs, params.pipelined);
+    }
+}
+
+auto Renderer::Impl::Render(Scene* scene, Camera* camera) -> void {
+    Prepare(scene, camera);
+    SwapFrames();
+    Submit();
+}
+
+auto Renderer::Impl::Prepare(Scene* scene, Camera* camera) -> void {
+    // Prepares the back frame. Only CPU-side state is written here, since
+    // this may run on a worker thread while the front frame is submitted.
+    auto& frame = *frames_[front_ ^ 1];
+
+    scene->UpdateTransformHierarchy();
+    camera->SetViewTransform();
+
+    frame.scene = scene;
+    frame.projection = camera->projection_transform;
+    frame.view = camera->view_transform;
+
+    frame.render_lists.ProcessScene(scene, camera);
+    ProcessLights(frame);
+}
+
+auto Renderer::Impl::SwapFrames() -> void {
+    front_ ^= 1;
+}
+
+auto Renderer::Impl::ProcessLights(Frame& frame) -> void {
+    frame.lights.Reset();
+
+    for(auto light : frame.render_lists.Lights()) {
+        frame.lights.AddLight(light, frame.view);
+    }
+
+    // Lights are assigned to every draw first, and only binned
+    // into clusters when some draw is reached by too many of them.
+    frame.object_lights.Assign(
+        frame.render_lists.Bounds(),
+        frame.view,
+        frame.lights.local_bounds
+    );
+
+    if (frame.object_lights.HasClustered()) {
+        frame.clusters.Build(frame.lights.local_bounds, frame.projection);
+    }
+}
+
+Renderer::Impl::~Impl() = default;
+
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "core/renderer.hpp"
+
+#include "gleam/math/matrix4.hpp"
+
+#include "core/light_clusters.hpp"
+#include "core/object_lights.hpp"
+#include "core/render_lists.hpp"
+
+#include "renderer/gl/gl_lights.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+namespace gleam {
+
+// Base of the rendering backends. Preparing a frame only reads the scene
+// graph on the CPU, so it's shared by every backend, and each backend
+// implements how the prepared frames are submitted.
+class Renderer::Impl {
+public:
+    explicit Impl(const Renderer::Parameters& params);
+
+    Impl(const Impl&) = delete;
+    Impl(Impl&&) = delete;
+    Impl& operator=(const Impl&) = delete;
+    Impl& operator=(Impl&&) = delete;
+
+    auto Render(Scene* scene, Camera* camera) -> void;
+
+    auto Prepare(Scene* scene, Camera* camera) -> void;
+
+    auto SwapFrames() -> void;
+
+    virtual auto Submit() -> void = 0;
+
+    virtual auto SetClearColor(const Color& color) -> void = 0;
+
+    virtual auto StartCapture(const OnFrameCaptured& callback) -> void = 0;
+
+    virtual auto StopCapture() -> void = 0;
+
+    [[nodiscard]] virtual auto CaptureStats() const -> FrameCaptureStats = 0;
+
+    // Backends without shader programs have nothing to compile
+    virtual auto Precompile(Scene* scene) -> void {}
+
+    [[nodiscard]] virtual auto PendingPrograms() -> std::size_t { return 0; }
+
+    [[nodiscard]] auto RenderedObjectsPerFrame() const {
+        return rendered_objects_per_frame_;
+    }
+
+    [[nodiscard]] auto DepthPrepassStatsPerFrame() const {
+        return depth_prepass_stats_per_frame_;
+    }
+
+    [[nodiscard]] auto StateCacheStatsPerFrame() const {
+        return state_cache_stats_per_frame_;
+    }
+
+    virtual ~Impl();
+
+protected:
+    // Everything the submission of a frame reads from the scene graph,
+    // captured when the frame is prepared.
+    struct Frame {
+        Frame(JobSystem* jobs, bool pipelined) :
+            render_lists(jobs, pipelined),
+            clusters(jobs),
+            object_lights(jobs) {}
+
+        RenderLists render_lists;
+        GLLights::State lights;
+        LightClusters clusters;
+        ObjectLights object_lights;
+        Matrix4 projection;
+        Matrix4 view;
+        Scene* scene {nullptr};
+    };
+
+    Renderer::Parameters params_;
+
+    size_t rendered_objects_per_frame_ {0};
+
+    DepthPrepassStats depth_prepass_stats_per_frame_;
+
+    StateCacheStats state_cache_stats_per_frame_;
+
+    [[nodiscard]] auto FrontFrame() const -> const Frame& {
+        return *frames_[front_];
+    }
+
+private:
+    std::array<std::unique_ptr<Frame>, 2> frames_;
+
+    std::size_t front_ {0};
+
+    auto ProcessLights(Frame& frame) -> void;
+};
+
+}
\ No newline at end of file
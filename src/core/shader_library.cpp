@@ -14,6 +14,8 @@
 
 #include "utilities/logger.hpp"
 
+#include "shaders/headers/depth_frag.h"
+#include "shaders/headers/depth_vert.h"
 #include "shaders/headers/phong_material_frag.h"
 #include "shaders/headers/phong_material_vert.h"
 #include "shaders/headers/sprite_material_frag.h"
@@ -27,11 +29,22 @@
 #include "shaders/snippets/headers/vert_global_params_glsl.h"
 #include "shaders/snippets/headers/vert_main_varyings_glsl.h"
 
-#include <unordered_map>
+#include <array>
+#include <utility>
 
 namespace gleam {
 
 auto ShaderLibrary::GetShaderSource(const ProgramAttributes& attrs) const -> std::vector<ShaderInfo> {
+    if (attrs.depth_only) {
+        return {{
+            ShaderType::kVertexShader,
+            ProcessShader(attrs, _SHADER_depth_vert)
+        }, {
+            ShaderType::kFragmentShader,
+            ProcessShader(attrs, _SHADER_depth_frag)
+        }};
+    }
+
     if (attrs.type == MaterialType::PhongMaterial) {
         return {{
             ShaderType::kVertexShader,
@@ -45,10 +58,10 @@ auto ShaderLibrary::GetShaderSource(const ProgramAttributes& attrs) const -> std
     if (attrs.type == MaterialType::ShaderMaterial) {
         return {{
             ShaderType::kVertexShader,
-            ProcessShader(attrs, attrs.vertex_shader)
+            ProcessCustomShader(attrs, attrs.vertex_shader)
         }, {
             ShaderType::kFragmentShader,
-            ProcessShader(attrs, attrs.fragment_shader)
+            ProcessCustomShader(attrs, attrs.fragment_shader)
         }};
     }
 
@@ -82,59 +95,76 @@ auto ShaderLibrary::GetShaderSource(const ProgramAttributes& attrs) const -> std
 }
 
 auto ShaderLibrary::ProcessShader(
+    const ProgramAttributes& attrs,
+    const ShaderSource& source
+) const -> std::string {
+    const auto defines = GetDefines(attrs);
+    auto output = std::string {};
+    output.reserve(source.prologue.size() + defines.size() + source.body.size());
+    output.append(source.prologue);
+    output.append(defines);
+    output.append(source.body);
+    return output;
+}
+
+auto ShaderLibrary::ProcessCustomShader(
     const ProgramAttributes& attrs,
     std::string_view source
 ) const -> std::string {
     auto output = std::string {source};
-    InjectAttributes(attrs, output);
+
+    const auto token = std::string_view {"#pragma inject_attributes"};
+    const auto pos = output.find(token);
+    if (pos == std::string::npos) {
+        Logger::Log(
+            LogLevel::Error,
+            "The '#pragma inject_attributes' token is missing in program {}",
+            Material::TypeToString(attrs.type)
+        );
+        return output;
+    }
+
+    output.replace(pos, token.size(), GetDefines(attrs));
     ResolveIncludes(output);
     return output;
 }
 
-auto ShaderLibrary::InjectAttributes(
-    const ProgramAttributes& attrs,
-    std::string& source
-) const -> void {
+auto ShaderLibrary::GetDefines(const ProgramAttributes& attrs) const -> std::string {
     auto features = std::string {};
 
     if (attrs.alpha_map) features += "#define USE_ALPHA_MAP\n";
+    if (attrs.clustered_lights) features += "#define USE_CLUSTERED_LIGHTS\n";
     if (attrs.color) features += "#define USE_COLOR\n";
     if (attrs.flat_shaded) features += "#define USE_FLAT_SHADED\n";
     if (attrs.fog) features += "#define USE_FOG\n";
     if (attrs.instancing) features += "#define USE_INSTANCING\n";
     if (attrs.albedo_map) features += "#define USE_ALBEDO_MAP\n";
+    if (attrs.albedo_array) features += "#define USE_ALBEDO_ARRAY\n";
+    if (attrs.alpha_array) features += "#define USE_ALPHA_ARRAY\n";
+    if (attrs.albedo_array || attrs.alpha_array) features += "#define USE_TEXTURE_LAYER\n";
     if (attrs.two_sided) features += "#define USE_TWO_SIDED\n";
     if (attrs.vertex_color) features += "#define USE_VERTEX_COLOR\n";
 
     const auto lights = attrs.num_lights;
     features += "#define NUM_LIGHTS " + std::to_string(lights) + '\n';
 
-    const auto token = std::string_view {"#pragma inject_attributes"};
-    const auto pos = source.find(token);
-    if (pos == std::string::npos) {
-        Logger::Log(
-            LogLevel::Error,
-            "The '#pragma inject_attributes' token is missing in program {}",
-            Material::TypeToString(attrs.type)
-        );
-        return;
-    }
+    const auto object_lights = attrs.num_object_lights;
+    features += "#define NUM_OBJECT_LIGHTS " + std::to_string(object_lights) + '\n';
 
-    source.replace(pos, token.size(), features);
+    return features;
 }
 
 auto ShaderLibrary::ResolveIncludes(std::string& source) const -> void {
-    static const std::unordered_map<std::string, std::string> include_map = {
-        {"snippets/frag_global_fog.glsl", _SNIPPET_frag_global_fog},
-        {"snippets/frag_global_params.glsl", _SNIPPET_frag_global_params},
-        {"snippets/frag_main_normal.glsl", _SNIPPET_frag_main_normal},
-        {"snippets/utilities.glsl", _SNIPPET_utilities},
-        {"snippets/vert_global_params.glsl", _SNIPPET_vert_global_params},
-        {"snippets/vert_main_varyings.glsl", _SNIPPET_vert_main_varyings}
-    };
-
-    for (const auto& [include, content] : include_map) {
-        auto token = std::string {"#include \"" + include + "\""};
+    static constexpr auto include_map = std::array<std::pair<std::string_view, std::string_view>, 6> {{
+        {"#include \"snippets/frag_global_fog.glsl\"", _SNIPPET_frag_global_fog},
+        {"#include \"snippets/frag_global_params.glsl\"", _SNIPPET_frag_global_params},
+        {"#include \"snippets/frag_main_normal.glsl\"", _SNIPPET_frag_main_normal},
+        {"#include \"snippets/utilities.glsl\"", _SNIPPET_utilities},
+        {"#include \"snippets/vert_global_params.glsl\"", _SNIPPET_vert_global_params},
+        {"#include \"snippets/vert_main_varyings.glsl\"", _SNIPPET_vert_main_varyings}
+    }};
+
+    for (const auto& [token, content] : include_map) {
         auto pos = source.find(token);
         if (pos != std::string::npos) {
             source.replace(pos, token.size(), content);
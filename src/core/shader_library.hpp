@@ -9,6 +9,7 @@
 
 #include "core/program_attributes.hpp"
 
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -24,14 +25,26 @@ struct ShaderInfo {
     std::string source;
 };
 
+// Built-in shaders are flattened at build time (see ShaderProcessor.cmake).
+// The defines of a program go between the prologue, which holds the version
+// and extension directives, and the body, whose includes are resolved.
+struct ShaderSource {
+    std::string_view prologue;
+    std::string_view body;
+};
+
 class ShaderLibrary {
 public:
     auto GetShaderSource(const ProgramAttributes& attrs) const -> std::vector<ShaderInfo>;
 
 private:
-    auto ProcessShader(const ProgramAttributes& attrs, std::string_view source) const -> std::string;
+    auto ProcessShader(const ProgramAttributes& attrs, const ShaderSource& source) const -> std::string;
+
+    // Shader materials are written by the application, so their defines
+    // and includes are still resolved when their program is created.
+    auto ProcessCustomShader(const ProgramAttributes& attrs, std::string_view source) const -> std::string;
 
-    auto InjectAttributes(const ProgramAttributes& attrs, std::string& source) const -> void;
+    auto GetDefines(const ProgramAttributes& attrs) const -> std::string;
 
     auto ResolveIncludes(std::string& source) const -> void;
 };
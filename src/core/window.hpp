@@ -28,6 +28,7 @@ public:
         int height;
         int antialiasing;
         bool vsync;
+        bool headless {false};
     };
 
     explicit Window(const Window::Parameters& params);
@@ -31,6 +31,12 @@ static auto glfw_mouse_button_map(int button) -> MouseButton;
 static auto glfw_keyboard_map(int key) -> Key;
 
 Window::Impl::Impl(const Window::Parameters& params) {
+    // Headless windows use the null platform, which needs no display
+    // server. Its contexts are created through EGL on a surfaceless pbuffer
+    // (e.g. Mesa llvmpipe), falling back to OSMesa, and are rendered to
+    // through an offscreen framebuffer owned by the renderer.
+    if (params.headless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
     if (!glfwInit()) {
         Logger::Log(LogLevel::Error, "Failed to initialize GLFW {}", glfw_get_error());
         return;
@@ -45,14 +51,25 @@ Window::Impl::Impl(const Window::Parameters& params) {
     glfwWindowHint(GLFW_ALPHA_BITS, 8);
     glfwWindowHint(GLFW_DEPTH_BITS, 24);
     glfwWindowHint(GLFW_STENCIL_BITS, 8);
-    glfwWindowHint(GLFW_SAMPLES, params.antialiasing);
+    glfwWindowHint(GLFW_SAMPLES, params.headless ? 0 : params.antialiasing);
 
     #ifdef __APPLE__
         glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_TRUE);
     #endif
 
+    if (params.headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    }
+
     window_ = glfwCreateWindow(params.width, params.height, "Untitled", nullptr, nullptr);
 
+    if (window_ == nullptr && params.headless) {
+        Logger::Log(LogLevel::Warning, "Failed to create an EGL context {}", glfw_get_error());
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        window_ = glfwCreateWindow(params.width, params.height, "Untitled", nullptr, nullptr);
+    }
+
     if (window_ == nullptr) {
         Logger::Log(LogLevel::Error, "Failed to create a GLFW window {}", glfw_get_error());
         return;
@@ -67,7 +84,7 @@ Window::Impl::Impl(const Window::Parameters& params) {
     LogContextInfo();
     initialized_ = true;
 
-    glfwSwapInterval(params.vsync ? 1 : 0);
+    glfwSwapInterval(params.vsync && !params.headless ? 1 : 0);
     glfwSetWindowUserPointer(window_, this);
     glfwGetFramebufferSize(window_, &buffer_width_, &buffer_height_);
 
@@ -26,8 +26,11 @@ auto Geometry::SetAttribute(const GeometryAttribute &attribute) -> void {
 
     assert(attribute.type != InstanceColor);
     assert(attribute.type != InstanceTransform);
+    assert(attribute.type != InstanceNormalMatrix);
+    assert(attribute.type != InstanceLayer);
 
     attributes_.emplace_back(attribute);
+    ++version_;
 }
 
 auto Geometry::HasAttribute(VertexAttributeType type) const -> bool {
@@ -11,6 +11,7 @@
 
 #include "asset_builder/include/types.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 
@@ -39,9 +40,19 @@ auto TextureLoader::LoadImpl(const fs::path& path) const -> LoaderResult<Texture
     auto texture = std::make_shared<Texture2D>(Texture2D::Parameters {
         .width = header.width,
         .height = header.height,
-        .data = std::move(data)
+        .data = std::move(data),
+        .mip_levels = std::max(header.mip_levels, 1u)
     });
 
+    // Mip levels are stored after the texture, down to the header's count
+    auto size = std::size_t {0};
+    for (auto level = 0u; level < texture->mip_levels; ++level) {
+        size += texture->MipLevelSize(level);
+    }
+    if (texture->data.size() != size) {
+        return std::unexpected("Invalid texture data in file '" + path_s + "'");
+    }
+
     texture->SetName(path.filename().string());
 
     return texture;
@@ -20,6 +20,7 @@ InstancedMesh::InstancedMesh(
 ): Mesh(geometry, material), count_(count), impl_(std::make_unique<Impl>()) {
     transforms_.resize(count);
     colors_.resize(count);
+    impl_->normal_matrices.resize(count);
 }
 
 auto InstancedMesh::GetColorAt(std::size_t idx) -> const Color {
@@ -27,6 +28,11 @@ auto InstancedMesh::GetColorAt(std::size_t idx) -> const Color {
     return colors_[idx];
 }
 
+auto InstancedMesh::GetLayerAt(std::size_t idx) -> unsigned {
+    assert(idx < count_);
+    return layers_.empty() ? 0 : static_cast<unsigned>(layers_[idx]);
+}
+
 auto InstancedMesh::GetTransformAt(std::size_t idx) -> const Matrix4 {
     assert(idx <= count_);
     return transforms_[idx];
@@ -35,13 +41,21 @@ auto InstancedMesh::GetTransformAt(std::size_t idx) -> const Matrix4 {
 auto InstancedMesh::SetColorAt(std::size_t idx, const Color& color) -> void {
     assert(idx <= count_);
     colors_[idx] = color;
-    impl_->colors_touched = true;
+    ++impl_->colors_version;
+}
+
+auto InstancedMesh::SetLayerAt(std::size_t idx, unsigned layer) -> void {
+    assert(idx < count_);
+    if (layers_.empty()) layers_.resize(count_);
+    layers_[idx] = static_cast<float>(layer);
+    ++impl_->layers_version;
 }
 
 auto InstancedMesh::SetTransformAt(std::size_t idx, const Matrix4& matrix) -> void {
     assert(idx <= count_);
     transforms_[idx] = matrix;
-    impl_->transforms_touched = true;
+    impl_->normal_matrices[idx] = NormalMatrix(matrix);
+    ++impl_->transforms_version;
     impl_->bounding_box_touched = true;
     impl_->bounding_sphere_touched = true;
 }
@@ -8,20 +8,34 @@
 #pragma once
 
 #include "gleam/math/box3.hpp"
+#include "gleam/math/matrix3.hpp"
 #include "gleam/math/sphere.hpp"
 #include "gleam/nodes/instanced_mesh.hpp"
 
+#include <cstdint>
+#include <vector>
+
 namespace gleam {
 
 struct InstancedMesh::Impl {
     Box3 bounding_box {};
     Sphere bounding_sphere {};
+    std::vector<Matrix3> normal_matrices {};
     unsigned int colors_buff_id = 0;
+    unsigned int layers_buff_id = 0;
+    unsigned int normals_buff_id = 0;
     unsigned int transforms_buff_id = 0;
+    // Incremented whenever an array changes. Only read while preparing a
+    // frame, so they're safe to change while another frame is submitted.
+    uint32_t colors_version {1};
+    uint32_t layers_version {0};
+    uint32_t transforms_version {1};
+    // Versions last uploaded to the buffers, only used while submitting
+    uint32_t colors_uploaded {0};
+    uint32_t layers_uploaded {0};
+    uint32_t transforms_uploaded {0};
     bool bounding_box_touched {true};
     bool bounding_sphere_touched {true};
-    bool colors_touched {true};
-    bool transforms_touched {true};
 };
 
 }
\ No newline at end of file
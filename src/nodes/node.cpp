@@ -10,6 +10,7 @@
 #include "gleam/cameras/camera.hpp"
 
 #include "events/event_dispatcher.hpp"
+#include "nodes/node_impl.hpp"
 #include "utilities/logger.hpp"
 
 #include <queue>
@@ -17,18 +18,6 @@
 
 namespace gleam {
 
-struct Node::Impl {
-    std::vector<std::shared_ptr<Node>> children;
-
-    Node* parent {nullptr};
-
-    Matrix4 world_transform {1.0f};
-
-    bool world_transform_touched {false};
-
-    bool attached {false};
-};
-
 Node::Node() : impl_(std::make_unique<Impl>()) {};
 
 auto Node::Add(const std::shared_ptr<Node>& node) -> void {
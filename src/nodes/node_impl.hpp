@@ -0,0 +1,30 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/math/matrix4.hpp"
+#include "gleam/nodes/node.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace gleam {
+
+struct Node::Impl {
+    std::vector<std::shared_ptr<Node>> children;
+
+    Node* parent {nullptr};
+
+    Matrix4 world_transform {1.0f};
+
+    bool world_transform_touched {false};
+
+    bool attached {false};
+};
+
+}
\ No newline at end of file
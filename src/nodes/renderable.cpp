@@ -9,10 +9,13 @@
 
 #include "gleam/nodes/mesh.hpp"
 
+#include "nodes/renderable_impl.hpp"
 #include "utilities/logger.hpp"
 
 namespace gleam {
 
+Renderable::Renderable() : impl_(std::make_unique<Impl>()) {}
+
 auto Renderable::CanRender(Renderable* r) -> bool {
     const auto level = LogLevel::Error;
     const auto geometry = r->GetGeometry();
@@ -73,4 +76,6 @@ auto Renderable::IsMeshType(Renderable* r) -> bool {
            r->GetNodeType() == NodeType::InstancedMeshNode;
 }
 
+Renderable::~Renderable() = default;
+
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/nodes/renderable.hpp"
+
+#include "core/program_attributes.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace gleam {
+
+class GLProgram;
+
+// Program attributes derived from a renderable, reused until the geometry,
+// the features of the material or the per-frame environment they were
+// derived from change.
+struct ProgramCache {
+    std::optional<ProgramAttributes> attrs;
+    GLProgram* program {nullptr};
+
+    // Weak references compare by ownership, so a new geometry or material
+    // allocated at the address of a released one is never mistaken for it.
+    std::weak_ptr<Geometry> geometry;
+    std::weak_ptr<Material> material;
+    unsigned int geometry_version {0};
+    uint32_t material_features {0};
+
+    // Light counts, fog and batching, shared by many renderables in a frame
+    uint32_t environment {0};
+
+    [[nodiscard]] auto IsCurrent(
+        const std::shared_ptr<Geometry>& g,
+        const std::shared_ptr<Material>& m,
+        uint32_t env
+    ) const {
+        return attrs.has_value() && environment == env &&
+            !geometry.owner_before(g) && !g.owner_before(geometry) &&
+            !material.owner_before(m) && !m.owner_before(material) &&
+            geometry_version == g->Version() &&
+            material_features == ProgramAttributes::MaterialFeatures(m.get());
+    }
+
+    auto Track(
+        const std::shared_ptr<Geometry>& g,
+        const std::shared_ptr<Material>& m,
+        uint32_t env
+    ) {
+        geometry = g;
+        material = m;
+        geometry_version = g->Version();
+        material_features = ProgramAttributes::MaterialFeatures(m.get());
+        environment = env;
+    }
+};
+
+struct Renderable::Impl {
+    // Lights-independent attributes used by RenderLists to build sort keys
+    ProgramCache sort;
+
+    // Attributes and program used by the renderer to draw
+    ProgramCache draw;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "gleam/nodes/static_batch.hpp"
+
+#include "gleam/geometries/geometry.hpp"
+#include "gleam/math/matrix3.hpp"
+#include "gleam/nodes/mesh.hpp"
+
+#include "utilities/logger.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gleam {
+
+namespace {
+
+// Materials are keyed by the order they're first seen in, rather than by
+// address, so that chunks are added in the same order on every run.
+struct ChunkKey {
+    std::size_t material;
+    uint64_t layout;
+    int x;
+    int y;
+    int z;
+
+    auto operator<=>(const ChunkKey&) const = default;
+};
+
+struct Chunk {
+    std::shared_ptr<Material> material;
+    std::vector<GeometryAttribute> attributes;
+    std::vector<float> vertex_data;
+    std::vector<unsigned int> index_data;
+};
+
+// Packs the attribute layout into an integer so that only geometries with
+// identical interleaved layouts share a vertex buffer.
+auto layout_key(const Geometry* geometry) {
+    auto key = uint64_t {0};
+    for (const auto& attr : geometry->Attributes()) {
+        key = (key << 6) | (std::to_underlying(attr.type) << 3) | (attr.item_size & 0x7);
+    }
+    return key;
+}
+
+auto attribute_offset(const Geometry* geometry, VertexAttributeType type) -> int {
+    auto offset = 0;
+    for (const auto& attr : geometry->Attributes()) {
+        if (attr.type == type) return offset;
+        offset += attr.item_size;
+    }
+    return -1;
+}
+
+auto can_merge(Node* node) {
+    if (node->GetNodeType() != NodeType::MeshNode) return false;
+    if (!node->Children().empty()) return false;
+
+    auto mesh = static_cast<Mesh*>(node);
+    auto geometry = mesh->GetGeometry().get();
+    if (!geometry || !mesh->GetMaterial()) return false;
+    // Transparent meshes are sorted back to front, which needs them separate
+    if (mesh->GetMaterial()->transparent) return false;
+    if (geometry->primitive != GeometryPrimitiveType::Triangles) return false;
+    if (geometry->Attributes().size() > 10) return false;
+    return geometry->VertexCount() > 0 && attribute_offset(geometry, VertexAttributeType::Position) >= 0;
+}
+
+auto append_geometry(Chunk& chunk, const Geometry* geometry, const Matrix4& transform) {
+    const auto stride = geometry->Stride();
+    const auto& vertices = geometry->VertexData();
+    const auto base = static_cast<unsigned int>(chunk.vertex_data.size() / stride);
+
+    const auto position = attribute_offset(geometry, VertexAttributeType::Position);
+    const auto normal = attribute_offset(geometry, VertexAttributeType::Normal);
+    const auto normal_matrix = NormalMatrix(transform);
+
+    for (auto i = size_t {0}; i + stride <= vertices.size(); i += stride) {
+        const auto first = chunk.vertex_data.size();
+        chunk.vertex_data.insert(chunk.vertex_data.end(), &vertices[i], &vertices[i] + stride);
+
+        auto* p = &chunk.vertex_data[first + position];
+        const auto v = transform * Vector3 {p[0], p[1], p[2]};
+        p[0] = v.x; p[1] = v.y; p[2] = v.z;
+
+        if (normal >= 0) {
+            auto* n = &chunk.vertex_data[first + normal];
+            const auto w = Normalize(normal_matrix * Vector3 {n[0], n[1], n[2]});
+            n[0] = w.x; n[1] = w.y; n[2] = w.z;
+        }
+    }
+
+    const auto first_index = chunk.index_data.size();
+    if (geometry->IndexCount()) {
+        for (auto index : geometry->IndexData()) {
+            chunk.index_data.emplace_back(base + index);
+        }
+    } else {
+        for (auto i = size_t {0}; i < geometry->VertexCount(); ++i) {
+            chunk.index_data.emplace_back(base + static_cast<unsigned int>(i));
+        }
+    }
+
+    // A mirroring transform flips the winding order of every triangle
+    if (Determinant(Matrix3 {transform}) < 0.0f) {
+        for (auto i = first_index; i + 2 < chunk.index_data.size(); i += 3) {
+            std::swap(chunk.index_data[i + 1], chunk.index_data[i + 2]);
+        }
+    }
+}
+
+}
+
+auto StaticBatch::Build() -> void {
+    auto chunks = std::map<ChunkKey, Chunk> {};
+    auto materials = std::unordered_map<const Material*, std::size_t> {};
+    auto merged = std::vector<std::pair<Node*, std::shared_ptr<Node>>> {};
+
+    auto stack = std::vector<std::pair<Node*, Matrix4>> {{this, Matrix4::Identity()}};
+    while (!stack.empty()) {
+        const auto [parent, parent_transform] = stack.back();
+        stack.pop_back();
+
+        for (const auto& child : parent->Children()) {
+            const auto transform = parent_transform * child->transform.Get();
+
+            if (!can_merge(child.get())) {
+                stack.emplace_back(child.get(), transform);
+                continue;
+            }
+
+            auto mesh = static_cast<Mesh*>(child.get());
+            auto geometry = mesh->GetGeometry();
+            auto material = mesh->GetMaterial();
+
+            // Chunks are assigned by the center of each mesh, so a mesh is
+            // never split and chunk bounds may overlap slightly.
+            const auto center = transform * geometry->BoundingSphere().center;
+            const auto [order, _] = materials.try_emplace(material.get(), materials.size());
+            const auto key = ChunkKey {
+                order->second,
+                layout_key(geometry.get()),
+                static_cast<int>(std::floor(center.x / params_.chunk_size)),
+                static_cast<int>(std::floor(center.y / params_.chunk_size)),
+                static_cast<int>(std::floor(center.z / params_.chunk_size))
+            };
+
+            auto& chunk = chunks[key];
+            if (!chunk.material) {
+                chunk.material = material;
+                chunk.attributes = geometry->Attributes();
+            }
+
+            append_geometry(chunk, geometry.get(), transform);
+            merged.emplace_back(parent, child);
+        }
+    }
+
+    for (auto& [parent, node] : merged) {
+        parent->Remove(node);
+    }
+
+    for (auto& [key, chunk] : chunks) {
+        auto geometry = Geometry::Create(chunk.vertex_data, chunk.index_data);
+        for (const auto& attr : chunk.attributes) {
+            geometry->SetAttribute(attr);
+        }
+        Add(Mesh::Create(geometry, chunk.material));
+    }
+
+    Logger::Log(
+        LogLevel::Info,
+        "Static batch merged {} meshes into {} chunks",
+        merged.size(), chunks.size()
+    );
+}
+
+StaticBatch::~StaticBatch() = default;
+
+}
\ No newline at end of file
@@ -23,31 +23,28 @@ constexpr uint8_t BUFF_IDX_VBO  = 0;
 constexpr uint8_t BUFF_IDX_EBO  = 1;
 constexpr uint8_t BUFF_IDX_INSTANCE_COLOR = 2;
 constexpr uint8_t BUFF_IDX_INSTANCE_TRANSFORM = 3;
+constexpr uint8_t BUFF_IDX_INSTANCE_NORMAL = 4;
+constexpr uint8_t BUFF_IDX_INSTANCE_LAYER = 5;
 
 }
 
 #define BUFFER_OFFSET(offset) ((void*)(offset * sizeof(GLfloat)))
 
-auto GLBuffers::Bind(const std::shared_ptr<Geometry>& geometry) -> void {
-    auto vao = geometry->renderer_id;
-    if (vao != 0 && vao == current_vao_) return;
-
-    if (vao == 0) {
-        GenerateBuffers(geometry.get());
-        vao = geometry->renderer_id;
+auto GLBuffers::Bind(GLState& state, const std::shared_ptr<Geometry>& geometry) -> void {
+    if (geometry->renderer_id == 0) {
+        GenerateBuffers(state, geometry.get());
         geometries_.emplace_back(geometry);
     }
 
-    glBindVertexArray(vao);
-    current_vao_ = vao;
+    state.BindVertexArray(geometry->renderer_id);
 }
 
-auto GLBuffers::GenerateBuffers(Geometry* geometry) -> void {
+auto GLBuffers::GenerateBuffers(GLState& state, Geometry* geometry) -> void {
     auto& vao = geometry->renderer_id;
-    auto buffers = std::array<GLuint, 4> {};
+    auto buffers = std::array<GLuint, 6> {};
 
     glGenVertexArrays(1, &vao);
-    glBindVertexArray(geometry->renderer_id);
+    state.BindVertexArray(vao);
     glGenBuffers(buffers.size(), buffers.data());
 
     const auto& vertex = geometry->VertexData();
@@ -98,47 +95,85 @@ auto GLBuffers::GenerateBuffers(Geometry* geometry) -> void {
         glDeleteBuffers(buffers.size(), buffers.data());
         Logger::Log(LogLevel::Info, "Geometry buffer cleared {}", *static_cast<Geometry*>(target));
         this->bindings_.erase(vao);
+        this->instance_sources_.erase(vao);
     });
 }
 
-auto GLBuffers::BindInstancedMesh(InstancedMesh* mesh) -> void {
+auto GLBuffers::BindInstancedMesh(const RenderLists::InstanceData& instances) -> void {
+    const auto mesh = instances.mesh;
+    const auto vao = mesh->GetGeometry()->renderer_id;
+
     if (mesh->impl_->transforms_buff_id == 0) {
-        auto& buffers = bindings_[mesh->GetGeometry()->renderer_id];
+        auto& buffers = bindings_[vao];
         mesh->impl_->transforms_buff_id = buffers[BUFF_IDX_INSTANCE_TRANSFORM];
-        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->transforms_buff_id);
-
-        for (auto i = 0; i < 4; ++i) {
-            auto loc = std::to_underlying(VertexAttributeType::InstanceTransform) + i;
-            glEnableVertexAttribArray(loc);
-            glVertexAttribPointer(
-                loc,
-                4,
-                GL_FLOAT,
-                GL_FALSE,
-                4 * sizeof(Vector4),
-                BUFFER_OFFSET(i * 4)
-            );
-            glVertexAttribDivisor(loc, 1);
-        }
+        mesh->impl_->colors_buff_id = buffers[BUFF_IDX_INSTANCE_COLOR];
+        mesh->impl_->normals_buff_id = buffers[BUFF_IDX_INSTANCE_NORMAL];
     }
 
-    if (mesh->impl_->transforms_touched) {
+    auto& impl = *mesh->impl_;
+    if (instances.transforms_version != impl.transforms_uploaded) {
+        impl.transforms_uploaded = instances.transforms_version;
         glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->transforms_buff_id);
         glBufferData(
             GL_ARRAY_BUFFER,
-            mesh->transforms_.size() * 4 * sizeof(Vector4),
-            mesh->transforms_.data(),
+            instances.transforms.size() * 4 * sizeof(Vector4),
+            instances.transforms.data(),
+            GL_DYNAMIC_DRAW
+        );
+
+        // Normal matrices are computed when transforms are set, so shaders
+        // don't need to invert the instance transform for every vertex.
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->normals_buff_id);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            instances.normals.size() * sizeof(Matrix3),
+            instances.normals.data(),
             GL_DYNAMIC_DRAW
         );
-        mesh->impl_->transforms_touched = false;
     }
 
-    if (mesh->impl_->colors_buff_id == 0) {
-        auto& buffers = bindings_[mesh->GetGeometry()->renderer_id];
-        mesh->impl_->colors_buff_id = buffers[BUFF_IDX_INSTANCE_COLOR];
+    if (instances.colors_version != impl.colors_uploaded) {
+        impl.colors_uploaded = instances.colors_version;
         glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->colors_buff_id);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            instances.colors.size() * sizeof(Color),
+            instances.colors.data(),
+            GL_DYNAMIC_DRAW
+        );
+    }
+
+    // The instance attributes are part of the vertex array state, which is
+    // shared by every instanced draw of the same geometry. Only re-point them
+    // when another source was the last to use this vertex array.
+    auto setup = instance_sources_[vao] != mesh;
+
+    // Layers are optional, so their buffer is only used, and the attributes
+    // set up again, once the first layer is set.
+    if (instances.layers_version != impl.layers_uploaded) {
+        impl.layers_uploaded = instances.layers_version;
+        if (mesh->impl_->layers_buff_id == 0) {
+            mesh->impl_->layers_buff_id = bindings_[vao][BUFF_IDX_INSTANCE_LAYER];
+            setup = true;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->layers_buff_id);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            instances.layers.size() * sizeof(float),
+            instances.layers.data(),
+            GL_DYNAMIC_DRAW
+        );
+    }
+
+    if (setup) {
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->transforms_buff_id);
+        SetInstanceTransformPointers(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->normals_buff_id);
+        SetInstanceNormalPointers(0);
 
         const auto loc = std::to_underlying(VertexAttributeType::InstanceColor);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->colors_buff_id);
         glEnableVertexAttribArray(loc);
         glVertexAttribPointer(
                 loc,
@@ -149,22 +184,124 @@ auto GLBuffers::BindInstancedMesh(InstancedMesh* mesh) -> void {
                 BUFFER_OFFSET(0)
         );
         glVertexAttribDivisor(loc, 1);
+
+        // Without layers the array is disabled, and the attribute reads
+        // its default value of zero, i.e. the material's texture layer.
+        if (mesh->impl_->layers_buff_id != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->layers_buff_id);
+            SetInstanceLayerPointer(0);
+        } else {
+            glDisableVertexAttribArray(std::to_underlying(VertexAttributeType::InstanceLayer));
+        }
+
+        instance_sources_[vao] = mesh;
     }
+}
 
-    if (mesh->impl_->colors_touched) {
-        glBindBuffer(GL_ARRAY_BUFFER, mesh->impl_->colors_buff_id);
+auto GLBuffers::UploadInstances(
+    std::span<const Matrix4> transforms,
+    std::span<const Matrix3> normals,
+    std::span<const float> layers
+) -> void {
+    if (transforms.empty()) return;
+    if (instances_buff_id_ == 0) {
+        glGenBuffers(1, &instances_buff_id_);
+        glGenBuffers(1, &instance_normals_buff_id_);
+        glGenBuffers(1, &instance_layers_buff_id_);
+    }
 
-        glBufferData(
-            GL_ARRAY_BUFFER,
-            mesh->colors_.size() * sizeof(Color),
-            mesh->colors_.data(),
-            GL_DYNAMIC_DRAW
+    // Orphan the previous contents so the driver doesn't have to wait for
+    // last frame's draws before accepting the new transforms.
+    glBindBuffer(GL_ARRAY_BUFFER, instances_buff_id_);
+    glBufferData(GL_ARRAY_BUFFER, transforms.size_bytes(), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, transforms.size_bytes(), transforms.data());
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_normals_buff_id_);
+    glBufferData(GL_ARRAY_BUFFER, normals.size_bytes(), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, normals.size_bytes(), normals.data());
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_layers_buff_id_);
+    glBufferData(GL_ARRAY_BUFFER, layers.size_bytes(), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, layers.size_bytes(), layers.data());
+}
+
+auto GLBuffers::BindInstances(const GLState& state, std::size_t first_instance) -> void {
+    // OpenGL 4.1 has no base instance, so every batch points the instance
+    // attributes at its own range of the shared per-frame buffer. The arrays
+    // and divisors stay set while batches are the source of the vertex array.
+    const auto vao = state.VertexArray();
+    const auto setup = instance_sources_[vao] != this;
+
+    glBindBuffer(GL_ARRAY_BUFFER, instances_buff_id_);
+    SetInstanceTransformPointers(first_instance * sizeof(Matrix4), setup);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_normals_buff_id_);
+    SetInstanceNormalPointers(first_instance * sizeof(Matrix3), setup);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_layers_buff_id_);
+    SetInstanceLayerPointer(first_instance * sizeof(float), setup);
+
+    if (!setup) return;
+
+    // Batched meshes have no per-instance colors. With the array disabled the
+    // attribute reads the current generic value, which is set to white.
+    const auto loc = std::to_underlying(VertexAttributeType::InstanceColor);
+    glDisableVertexAttribArray(loc);
+    glVertexAttrib3f(loc, 1.0f, 1.0f, 1.0f);
+
+    instance_sources_[vao] = this;
+}
+
+auto GLBuffers::SetInstanceTransformPointers(std::size_t offset, bool setup) -> void {
+    for (auto i = 0; i < 4; ++i) {
+        auto loc = std::to_underlying(VertexAttributeType::InstanceTransform) + i;
+        if (setup) glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(
+            loc,
+            4,
+            GL_FLOAT,
+            GL_FALSE,
+            4 * sizeof(Vector4),
+            reinterpret_cast<void*>(offset + i * sizeof(Vector4))
         );
-        mesh->impl_->colors_touched = false;
+        if (setup) glVertexAttribDivisor(loc, 1);
     }
 }
 
+auto GLBuffers::SetInstanceNormalPointers(std::size_t offset, bool setup) -> void {
+    for (auto i = 0; i < 3; ++i) {
+        auto loc = std::to_underlying(VertexAttributeType::InstanceNormalMatrix) + i;
+        if (setup) glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(
+            loc,
+            3,
+            GL_FLOAT,
+            GL_FALSE,
+            3 * sizeof(Vector3),
+            reinterpret_cast<void*>(offset + i * sizeof(Vector3))
+        );
+        if (setup) glVertexAttribDivisor(loc, 1);
+    }
+}
+
+auto GLBuffers::SetInstanceLayerPointer(std::size_t offset, bool setup) -> void {
+    const auto loc = std::to_underlying(VertexAttributeType::InstanceLayer);
+    if (setup) glEnableVertexAttribArray(loc);
+    glVertexAttribPointer(
+        loc,
+        1,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(float),
+        reinterpret_cast<void*>(offset)
+    );
+    if (setup) glVertexAttribDivisor(loc, 1);
+}
+
 GLBuffers::~GLBuffers() {
+    if (instances_buff_id_ != 0) glDeleteBuffers(1, &instances_buff_id_);
+    if (instance_normals_buff_id_ != 0) glDeleteBuffers(1, &instance_normals_buff_id_);
+    if (instance_layers_buff_id_ != 0) glDeleteBuffers(1, &instance_layers_buff_id_);
     for (const auto& geometry : geometries_) {
         if (auto g = geometry.lock()) g->Dispose();
     }
@@ -8,10 +8,16 @@
 #pragma once
 
 #include "gleam/geometries/geometry.hpp"
+#include "gleam/math/matrix3.hpp"
+#include "gleam/math/matrix4.hpp"
 #include "gleam/nodes/instanced_mesh.hpp"
 
+#include "core/render_lists.hpp"
+#include "renderer/gl/gl_state.hpp"
+
 #include <array>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -29,20 +35,44 @@ public:
     GLBuffers& operator=(const GLBuffers&) = delete;
     GLBuffers& operator=(GLBuffers&&) = delete;
 
-    auto Bind(const std::shared_ptr<Geometry>& geometry) -> void;
+    auto Bind(GLState& state, const std::shared_ptr<Geometry>& geometry) -> void;
+
+    // Uploads the instance arrays that changed since the mesh was last drawn
+    auto BindInstancedMesh(const RenderLists::InstanceData& instances) -> void;
+
+    auto UploadInstances(
+        std::span<const Matrix4> transforms,
+        std::span<const Matrix3> normals,
+        std::span<const float> layers
+    ) -> void;
 
-    auto BindInstancedMesh(InstancedMesh* mesh) -> void;
+    // Points the bound vertex array's instance attributes at the batch
+    auto BindInstances(const GLState& state, std::size_t first_instance) -> void;
 
     ~GLBuffers();
 
 private:
-    std::unordered_map<GLuint, std::array<GLuint, 4>> bindings_;
+    std::unordered_map<GLuint, std::array<GLuint, 6>> bindings_;
+
+    std::unordered_map<GLuint, const void*> instance_sources_;
 
     std::vector<std::weak_ptr<Geometry>> geometries_;
 
-    GLuint current_vao_ {0};
+    GLuint instances_buff_id_ {0};
+
+    GLuint instance_normals_buff_id_ {0};
+
+    GLuint instance_layers_buff_id_ {0};
+
+    auto GenerateBuffers(GLState& state, Geometry* geometry) -> void;
+
+    // Setup enables the arrays and sets their divisors, which
+    // only has to happen once while a vertex array keeps its source.
+    auto SetInstanceTransformPointers(std::size_t offset, bool setup = true) -> void;
+
+    auto SetInstanceNormalPointers(std::size_t offset, bool setup = true) -> void;
 
-    auto GenerateBuffers(Geometry* geometry) -> void;
+    auto SetInstanceLayerPointer(std::size_t offset, bool setup = true) -> void;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_depth_prepass.hpp"
+
+namespace gleam {
+
+GLDepthPrepass::GLDepthPrepass() {
+    for (auto& slot : slots_) {
+        glGenQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+    }
+}
+
+auto GLDepthPrepass::IsCandidate(Renderable* renderable) -> bool {
+    const auto material = renderable->GetMaterial().get();
+    const auto type = material->GetType();
+    return Renderable::IsMeshType(renderable) &&
+        (type == MaterialType::PhongMaterial || type == MaterialType::UnlitMaterial) &&
+        !material->transparent &&
+        !material->wireframe &&
+        material->depth_test &&
+        renderable->GetGeometry()->primitive == GeometryPrimitiveType::Triangles;
+}
+
+auto GLDepthPrepass::BeginDepthPass(GLState& state) -> void {
+    // A slot whose queries are still in flight isn't reused until they finish
+    auto& slot = slots_[frame_++ % kFramesInFlight];
+    current_ = !slot.issued || Poll(slot) ? &slot : nullptr;
+
+    state.SetColorMask(false);
+    state.SetDepthFunc(GL_LESS);
+    state.SetDepthMask(true);
+
+    if (current_) {
+        glBeginQuery(GL_SAMPLES_PASSED, current_->queries[0]);
+    }
+}
+
+auto GLDepthPrepass::BeginColorPass(GLState& state) -> void {
+    if (current_) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        glBeginQuery(GL_SAMPLES_PASSED, current_->queries[1]);
+    }
+
+    state.SetColorMask(true);
+}
+
+auto GLDepthPrepass::SetDepthState(GLState& state, bool prepassed) const -> void {
+    state.SetDepthFunc(prepassed ? GL_EQUAL : GL_LESS);
+    state.SetDepthMask(!prepassed);
+}
+
+auto GLDepthPrepass::EndColorPass(GLState& state) -> void {
+    if (current_) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        current_->issued = true;
+        current_ = nullptr;
+    }
+
+    state.SetDepthFunc(GL_LESS);
+    state.SetDepthMask(true);
+}
+
+auto GLDepthPrepass::Poll(Slot& slot) -> bool {
+    // The color pass query ends last, so the depth pass result is ready too
+    auto available = GLuint {0};
+    glGetQueryObjectuiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available != GL_TRUE) return false;
+
+    auto depth = GLuint {0};
+    auto shaded = GLuint {0};
+    glGetQueryObjectuiv(slot.queries[0], GL_QUERY_RESULT, &depth);
+    glGetQueryObjectuiv(slot.queries[1], GL_QUERY_RESULT, &shaded);
+    stats_ = {.depth_fragments = depth, .shaded_fragments = shaded};
+    slot.issued = false;
+    return true;
+}
+
+GLDepthPrepass::~GLDepthPrepass() {
+    for (auto& slot : slots_) {
+        glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+    }
+}
+
+}
\ No newline at end of file
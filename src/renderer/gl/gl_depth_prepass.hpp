@@ -0,0 +1,80 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/nodes/renderable.hpp"
+
+#include "core/renderer.hpp"
+#include "renderer/gl/gl_state.hpp"
+
+#include <array>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+// Depth pre-pass for the opaque list. The opaque draws are first rendered
+// depth-only with a position-only program, and the color pass then tests for
+// equal depth with depth writes disabled, so every pixel is shaded once no
+// matter how much the opaque draws overlap.
+//
+// Both passes are wrapped in GL_SAMPLES_PASSED queries. The pre-pass count is
+// what the color pass would shade without the pre-pass, so the difference
+// between the two counts is the shading work saved. Results are read back a
+// few frames late, and frames whose results are still in flight aren't
+// measured, so the CPU never waits on the GPU.
+class GLDepthPrepass {
+public:
+    static constexpr std::size_t kFramesInFlight = 3;
+
+    GLDepthPrepass();
+
+    GLDepthPrepass(const GLDepthPrepass&) = delete;
+    GLDepthPrepass(GLDepthPrepass&&) = delete;
+    GLDepthPrepass& operator=(const GLDepthPrepass&) = delete;
+    GLDepthPrepass& operator=(GLDepthPrepass&&) = delete;
+
+    // Shader materials may displace positions in their vertex shaders, and
+    // wireframes and lines don't match the triangles of the pre-pass, so
+    // only triangle meshes with built-in materials are drawn in both passes.
+    [[nodiscard]] static auto IsCandidate(Renderable* renderable) -> bool;
+
+    auto BeginDepthPass(GLState& state) -> void;
+
+    auto BeginColorPass(GLState& state) -> void;
+
+    // Sets the depth state of a color pass draw. Renderables drawn in the
+    // pre-pass test for equal depth without writing it, others as usual.
+    auto SetDepthState(GLState& state, bool prepassed) const -> void;
+
+    auto EndColorPass(GLState& state) -> void;
+
+    [[nodiscard]] auto Stats() const { return stats_; }
+
+    ~GLDepthPrepass();
+
+private:
+    // Depth pass and color pass queries of a frame
+    struct Slot {
+        std::array<GLuint, 2> queries {};
+        bool issued {false};
+    };
+
+    std::array<Slot, kFramesInFlight> slots_;
+
+    Renderer::DepthPrepassStats stats_;
+
+    std::size_t frame_ {0};
+
+    Slot* current_ {nullptr};
+
+    auto Poll(Slot& slot) -> bool;
+};
+
+}
\ No newline at end of file
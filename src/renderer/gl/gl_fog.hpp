@@ -0,0 +1,55 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/math/color.hpp"
+#include "gleam/nodes/fog.hpp"
+
+#include "renderer/gl/gl_uniform_buffer.hpp"
+
+#include <utility>
+
+namespace gleam {
+
+class GLFog {
+public:
+    auto Update(const Fog* fog) {
+        if (fog == nullptr) return;
+
+        fog_.type = std::to_underlying(fog->GetType());
+        fog_.color = fog->color;
+
+        if (fog->GetType() == FogType::LinearFog) {
+            auto f = static_cast<const LinearFog*>(fog);
+            fog_.near = f->near;
+            fog_.far = f->far;
+        }
+
+        if (fog->GetType() == FogType::ExponentialFog) {
+            auto f = static_cast<const ExponentialFog*>(fog);
+            fog_.density = f->density;
+        }
+
+        uniform_buffer_.UploadIfNeeded(&fog_, sizeof(fog_));
+    }
+
+private:
+    struct alignas(16) UniformFog {
+        alignas(4)  int type {0};
+        alignas(16) Color color {0x000000};
+        alignas(4)  float near {0.0f};
+        alignas(4)  float far {0.0f};
+        alignas(4)  float density {0.0f};
+    };
+
+    UniformFog fog_;
+
+    GLUniformBuffer uniform_buffer_ {"ub_Fog", sizeof(UniformFog)};
+};
+
+}
\ No newline at end of file
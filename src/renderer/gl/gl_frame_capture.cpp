@@ -0,0 +1,119 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_frame_capture.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace gleam {
+
+namespace {
+
+constexpr auto kFenceTimeout = GLuint64 {1'000'000'000};
+
+auto is_signaled(GLsync fence, bool wait) {
+    // Polling flushes as well, so the fence is guaranteed to signal eventually
+    const auto timeout = wait ? kFenceTimeout : GLuint64 {0};
+    while (true) {
+        const auto result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        if (result != GL_TIMEOUT_EXPIRED) return result != GL_WAIT_FAILED;
+        if (!wait) return false;
+    }
+}
+
+}
+
+GLFrameCapture::GLFrameCapture(int width, int height)
+  : width_(width),
+    height_(height) {}
+
+auto GLFrameCapture::Read(GLuint framebuffer, std::uint64_t frame) -> void {
+    auto& slot = slots_[head_];
+    if (slot.fence != nullptr) {
+        ++stats_.dropped;
+        return;
+    }
+
+    if (slot.buffer == 0) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, Size(), nullptr, GL_STREAM_READ);
+    } else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    }
+
+    // With a pack buffer bound, glReadPixels returns as soon as the copy is
+    // queued and writes into the buffer instead of client memory.
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+    slot.time = timer_.GetElapsedMilliseconds();
+
+    head_ = (head_ + 1) % kSlots;
+}
+
+auto GLFrameCapture::Poll(const OnFrameCaptured& callback, std::uint64_t frame, bool wait) -> void {
+    while (true) {
+        auto& slot = slots_[tail_];
+        if (slot.fence == nullptr || !is_signaled(slot.fence, wait)) return;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        auto captured = CapturedFrame {
+            .frame = slot.frame,
+            .width = width_,
+            .height = height_,
+            .pixels = std::vector<std::uint8_t>(Size())
+        };
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const auto mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, Size(), GL_MAP_READ_BIT);
+        if (mapped != nullptr) {
+            std::memcpy(captured.pixels.data(), mapped, Size());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        ++stats_.captured;
+        total_latency_frames_ += static_cast<double>(frame - slot.frame);
+        total_latency_ms_ += timer_.GetElapsedMilliseconds() - slot.time;
+
+        tail_ = (tail_ + 1) % kSlots;
+
+        if (callback) callback(std::move(captured));
+    }
+}
+
+auto GLFrameCapture::Stats() const -> FrameCaptureStats {
+    auto stats = stats_;
+    if (stats.captured > 0) {
+        const auto captured = static_cast<double>(stats.captured);
+        stats.latency_frames = total_latency_frames_ / captured;
+        stats.latency_ms = total_latency_ms_ / captured;
+    }
+
+    const auto elapsed = timer_.GetElapsedSeconds();
+    if (elapsed > 0.0) {
+        stats.frames_per_second = static_cast<double>(stats.captured) / elapsed;
+    }
+
+    return stats;
+}
+
+GLFrameCapture::~GLFrameCapture() {
+    for (auto& slot : slots_) {
+        if (slot.fence != nullptr) glDeleteSync(slot.fence);
+        if (slot.buffer != 0) glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/core/frame_capture.hpp"
+#include "gleam/core/timer.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+// Reads frames back through a ring of pixel buffer objects. Read() only
+// queues an asynchronous copy into the next buffer, and Poll() hands the
+// pixels of copies the GPU has finished to the callback, typically two to
+// three frames later, so capturing never stalls the pipeline. When every
+// buffer is still in flight the frame is dropped instead.
+class GLFrameCapture {
+public:
+    GLFrameCapture(int width, int height);
+
+    GLFrameCapture(const GLFrameCapture&) = delete;
+    GLFrameCapture(GLFrameCapture&&) = delete;
+    GLFrameCapture& operator=(const GLFrameCapture&) = delete;
+    GLFrameCapture& operator=(GLFrameCapture&&) = delete;
+
+    auto Read(GLuint framebuffer, std::uint64_t frame) -> void;
+
+    // Delivers finished frames in order. With wait set, blocks
+    // until every pending frame is delivered.
+    auto Poll(const OnFrameCaptured& callback, std::uint64_t frame, bool wait) -> void;
+
+    [[nodiscard]] auto Stats() const -> FrameCaptureStats;
+
+    ~GLFrameCapture();
+
+private:
+    static constexpr auto kSlots = 3;
+
+    struct Slot {
+        GLuint buffer {0};
+        GLsync fence {nullptr};
+        std::uint64_t frame {0};
+        double time {0.0};
+    };
+
+    std::array<Slot, kSlots> slots_ {};
+
+    Timer timer_ {true};
+
+    FrameCaptureStats stats_;
+
+    double total_latency_frames_ {0.0};
+    double total_latency_ms_ {0.0};
+
+    int width_ {0};
+    int height_ {0};
+
+    int head_ {0};
+    int tail_ {0};
+
+    [[nodiscard]] auto Size() const {
+        return static_cast<std::size_t>(width_) * static_cast<std::size_t>(height_) * 4;
+    }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_framebuffer.hpp"
+
+#include "utilities/logger.hpp"
+
+namespace gleam {
+
+GLFramebuffer::GLFramebuffer(const Parameters& params)
+  : width_(params.width),
+    height_(params.height),
+    samples_(params.samples) {
+    complete_ = Create(resolved_, 0);
+    if (complete_ && samples_ > 0) complete_ = Create(multisampled_, samples_);
+
+    if (!complete_) {
+        Logger::Log(LogLevel::Error, "Failed to create a {}x{} offscreen framebuffer", width_, height_);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+auto GLFramebuffer::Bind() const -> void {
+    glBindFramebuffer(
+        GL_FRAMEBUFFER,
+        samples_ > 0 ? multisampled_.framebuffer : resolved_.framebuffer
+    );
+}
+
+auto GLFramebuffer::Resolve() const -> void {
+    if (samples_ == 0) return;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, multisampled_.framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolved_.framebuffer);
+    glBlitFramebuffer(
+        0, 0, width_, height_,
+        0, 0, width_, height_,
+        GL_COLOR_BUFFER_BIT,
+        GL_NEAREST
+    );
+    glBindFramebuffer(GL_FRAMEBUFFER, resolved_.framebuffer);
+}
+
+auto GLFramebuffer::Create(Target& target, int samples) const -> bool {
+    const auto storage = [&](GLenum format) {
+        if (samples > 0) {
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, width_, height_);
+        } else {
+            glRenderbufferStorage(GL_RENDERBUFFER, format, width_, height_);
+        }
+    };
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+
+    glGenRenderbuffers(1, &target.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.color);
+    storage(GL_RGBA8);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.color);
+
+    glGenRenderbuffers(1, &target.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
+    storage(GL_DEPTH24_STENCIL8);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depth);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+auto GLFramebuffer::Destroy(Target& target) const -> void {
+    if (target.framebuffer == 0) return;
+
+    glDeleteFramebuffers(1, &target.framebuffer);
+    glDeleteRenderbuffers(1, &target.color);
+    glDeleteRenderbuffers(1, &target.depth);
+    target = {};
+}
+
+GLFramebuffer::~GLFramebuffer() {
+    Destroy(multisampled_);
+    Destroy(resolved_);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+// Offscreen render target with color and depth-stencil renderbuffers.
+// Multisampled targets render into a second set of renderbuffers that
+// Resolve() blits into the single-sampled framebuffer, which holds the
+// final image either way.
+class GLFramebuffer {
+public:
+    struct Parameters {
+        int width;
+        int height;
+        int samples {0};
+    };
+
+    explicit GLFramebuffer(const Parameters& params);
+
+    GLFramebuffer(const GLFramebuffer&) = delete;
+    GLFramebuffer(GLFramebuffer&&) = delete;
+    GLFramebuffer& operator=(const GLFramebuffer&) = delete;
+    GLFramebuffer& operator=(GLFramebuffer&&) = delete;
+
+    // Binds the framebuffer that draws render into
+    auto Bind() const -> void;
+
+    auto Resolve() const -> void;
+
+    [[nodiscard]] auto Width() const { return width_; }
+
+    [[nodiscard]] auto Height() const { return height_; }
+
+    // Framebuffer holding the resolved image, for reading pixels back
+    [[nodiscard]] auto ResolvedId() const { return resolved_.framebuffer; }
+
+    [[nodiscard]] auto IsComplete() const { return complete_; }
+
+    ~GLFramebuffer();
+
+private:
+    struct Target {
+        GLuint framebuffer {0};
+        GLuint color {0};
+        GLuint depth {0};
+    };
+
+    Target resolved_;
+    Target multisampled_;
+
+    int width_ {0};
+    int height_ {0};
+    int samples_ {0};
+
+    bool complete_ {false};
+
+    auto Create(Target& target, int samples) const -> bool;
+
+    auto Destroy(Target& target) const -> void;
+};
+
+}
\ No newline at end of file
@@ -15,20 +15,32 @@
 #include "utilities/logger.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
 
 namespace gleam {
 
-auto GLLights::AddLight(Light* light, Camera* camera) -> void {
-    using enum LightType;
+namespace {
 
-    if (idx_ >= kMaxLights) {
-        Logger::Log(
-            LogLevel::Error,
-            "Exceeded the maximum allowed number of lights ({}) in the scene",
-            kMaxLights
-        );
-        return;
+// Distance at which the attenuation reaches the floor and fades out, or
+// infinity when the light isn't attenuated with distance at all.
+auto light_range(float base, float linear, float quadratic) {
+    const auto limit = 1.0f / GLLights::kAttenuationFloor;
+    if (base >= limit) return 0.0f;
+    if (quadratic > 0.0f) {
+        const auto discriminant = linear * linear - 4.0f * quadratic * (base - limit);
+        return (-linear + std::sqrt(discriminant)) / (2.0f * quadratic);
     }
+    if (linear > 0.0f) return (limit - base) / linear;
+    return std::numeric_limits<float>::infinity();
+}
+
+}
+
+auto GLLights::State::AddLight(Light* light, const Matrix4& view) -> void {
+    using enum LightType;
 
     if (light->GetType() == AmbientLight) {
         if (ambient >= 1) {
@@ -40,75 +52,191 @@ auto GLLights::AddLight(Light* light, Camera* camera) -> void {
         }
         ambient_light = light->color * light->intensity;
         ++ambient;
-    } else {
-        auto& dst = lights_.lights[idx_++];
-        dst.type = static_cast<unsigned>(light->GetType());
+        return;
+    }
+
+    if (light->GetType() == DirectionalLight) {
+        if (directional >= kMaxLights) {
+            Logger::Log(
+                LogLevel::Error,
+                "Exceeded the maximum allowed number of directional lights ({}) in the scene",
+                kMaxLights
+            );
+            return;
+        }
+
+        auto src = static_cast<gleam::DirectionalLight*>(light);
+        auto src_dir = src->Direction();
+        auto dir = view * Vector4(src_dir.x, src_dir.y, src_dir.z, 0.0f);
+        auto& dst = lights.lights[directional++];
+        lights.count = directional;
+        dst.type = static_cast<int>(DirectionalLight);
         dst.color = light->color * light->intensity;
+        dst.position = Vector3::Zero();
+        dst.direction = Vector3(dir.x, dir.y, dir.z);
+        return;
+    }
 
-        switch(light->GetType()) {
-            case AmbientLight: /* noop */ break;
-            case DirectionalLight: {
-                ++directional;
-                auto src = static_cast<gleam::DirectionalLight*>(light);
-                auto src_dir = src->Direction();
-                auto dir = camera->view_transform * Vector4(src_dir.x, src_dir.y, src_dir.z, 0.0f);
-                dst.position = Vector3::Zero();
-                dst.direction = Vector3(dir.x, dir.y, dir.z);
-                dst.cone_cos = 0.0f;
-                dst.penumbra_cos = 0.0f;
-                dst.base = 0.0f;
-                dst.linear = 0.0f;
-                dst.quadratic = 0.0f;
-            }
-            break;
-            case PointLight: {
-                ++point;
-                auto src = static_cast<gleam::PointLight*>(light);
-                auto world = src->GetWorldPosition();
-                auto pos = camera->view_transform *  Vector4(world.x, world.y, world.z, 1.0f);
-                dst.position = Vector3(pos.x, pos.y, pos.z);
-                dst.direction = Vector3::Zero();
-                dst.cone_cos = 0.0f;
-                dst.penumbra_cos = 0.0f;
-                dst.base = src->attenuation.base;
-                dst.linear = src->attenuation.linear;
-                dst.quadratic = src->attenuation.quadratic;
-            }
-            break;
-            case SpotLight: {
-                ++spot;
-                auto src = static_cast<gleam::SpotLight*>(light);
-                auto src_dir = src->Direction();
-                auto world = src->GetWorldPosition();
-                auto dir = camera->view_transform * Vector4(src_dir.x, src_dir.y, src_dir.z, 0.0f);
-                auto pos = camera->view_transform * Vector4(world.x, world.y, world.z, 1.0f);
-                dst.position = Vector3(pos.x, pos.y, pos.z);
-                dst.direction = Vector3(dir.x, dir.y, dir.z);
-                dst.cone_cos = math::Cos(src->angle);
-                dst.penumbra_cos = math::Cos(src->angle * (1 - src->penumbra));
-                dst.base = src->attenuation.base;
-                dst.linear = src->attenuation.linear;
-                dst.quadratic = src->attenuation.quadratic;
-            }
-            break;
-        };
+    if (local_lights.size() >= kMaxLocalLights) {
+        Logger::Log(
+            LogLevel::Error,
+            "Exceeded the maximum allowed number of point and spot lights ({}) in the scene",
+            kMaxLocalLights
+        );
+        return;
     }
-}
 
-auto GLLights::Update() -> void {
-    uniform_buffer_.UploadIfNeeded(&lights_, sizeof(lights_));
+    const auto color = light->color * light->intensity;
+    auto dst = BufferLight {};
+
+    switch(light->GetType()) {
+        case AmbientLight: /* noop */ break;
+        case DirectionalLight: /* noop */ break;
+        case PointLight: {
+            ++point;
+            auto src = static_cast<gleam::PointLight*>(light);
+            auto world = src->GetWorldPosition();
+            auto pos = view * Vector4(world.x, world.y, world.z, 1.0f);
+            const auto& a = src->attenuation;
+            dst.position = Vector4(pos.x, pos.y, pos.z, static_cast<float>(PointLight));
+            dst.color = Vector4(color.r, color.g, color.b, light_range(a.base, a.linear, a.quadratic));
+            dst.direction = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+            dst.attenuation = Vector4(0.0f, a.base, a.linear, a.quadratic);
+        }
+        break;
+        case SpotLight: {
+            ++spot;
+            auto src = static_cast<gleam::SpotLight*>(light);
+            auto src_dir = src->Direction();
+            auto world = src->GetWorldPosition();
+            auto dir = view * Vector4(src_dir.x, src_dir.y, src_dir.z, 0.0f);
+            auto pos = view * Vector4(world.x, world.y, world.z, 1.0f);
+            const auto& a = src->attenuation;
+            dst.position = Vector4(pos.x, pos.y, pos.z, static_cast<float>(SpotLight));
+            dst.color = Vector4(color.r, color.g, color.b, light_range(a.base, a.linear, a.quadratic));
+            dst.direction = Vector4(dir.x, dir.y, dir.z, math::Cos(src->angle));
+            dst.attenuation = Vector4(
+                math::Cos(src->angle * (1 - src->penumbra)),
+                a.base, a.linear, a.quadratic
+            );
+        }
+        break;
+    };
+
+    // Spot lights are bound by the sphere of their range as well
+    const auto range = dst.color.w;
+    if (range <= 0.0f) return;
+    local_lights.emplace_back(dst);
+    local_bounds.emplace_back(
+        Vector3 {dst.position.x, dst.position.y, dst.position.z},
+        std::min(range, std::numeric_limits<float>::max())
+    );
 }
 
-auto GLLights::HasLights() const -> bool {
-    return ambient || directional || point || spot;
+auto GLLights::State::HasLights() const -> bool {
+    return ambient || directional || !local_lights.empty();
 }
 
-auto GLLights::Reset() -> void {
-    idx_ = 0;
+auto GLLights::State::Reset() -> void {
+    local_lights.clear();
+    local_bounds.clear();
+    lights.count = 0;
     ambient = 0;
     directional = 0;
     point = 0;
     spot = 0;
 }
 
+GLLights::GLLights() {
+    for (auto target : {&light_data_, &light_clusters_, &light_indices_}) {
+        glGenBuffers(1, &target->buffer);
+        glGenTextures(1, &target->texture);
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, light_data_.buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, light_data_.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, light_data_.buffer);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, light_clusters_.buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, light_clusters_.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, light_clusters_.buffer);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, light_indices_.buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, light_indices_.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, light_indices_.buffer);
+
+    // Leaves the unit as the GL state cache expects a new context to be,
+    // since it's created before the cache sees any binding.
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+auto GLLights::Update(
+    GLState& gl_state,
+    const State& state,
+    const LightClusters& clusters,
+    const ObjectLights& objects,
+    int width,
+    int height
+) -> void {
+    uniform_buffer_.UploadIfNeeded(&state.lights, sizeof(state.lights));
+    if (!state.HasLocalLights()) return;
+
+    // Clusters are only built when some draw is reached by too many
+    // lights, otherwise every draw reads the lights assigned to it.
+    const auto lights = std::span {state.local_lights};
+    Upload(gl_state, light_data_, lights.data(), lights.size_bytes(), GLTextureMapType::LightData);
+
+    indices_.clear();
+    if (objects.HasClustered()) {
+        const auto uniform_clusters = UniformClusters {
+            .scale = {
+                static_cast<float>(LightClusters::kTilesX) / static_cast<float>(width),
+                static_cast<float>(LightClusters::kTilesY) / static_cast<float>(height),
+                clusters.DepthScale(),
+                clusters.DepthBias()
+            },
+            .grid = {LightClusters::kTilesX, LightClusters::kTilesY, LightClusters::kSlices, 0}
+        };
+        clusters_buffer_.UploadIfNeeded(&uniform_clusters, sizeof(uniform_clusters));
+
+        const auto grid = clusters.Clusters();
+        Upload(gl_state, light_clusters_, grid.data(), grid.size_bytes(), GLTextureMapType::LightClusters);
+        indices_.assign(clusters.Indices().begin(), clusters.Indices().end());
+    }
+
+    object_indices_offset_ = static_cast<int>(indices_.size());
+    indices_.insert(indices_.end(), objects.Indices().begin(), objects.Indices().end());
+    const auto indices = std::span {indices_};
+    Upload(gl_state, light_indices_, indices.data(), indices.size_bytes(), GLTextureMapType::LightIndices);
+}
+
+auto GLLights::Upload(
+    GLState& gl_state,
+    TextureBuffer& target,
+    const void* data,
+    std::size_t size,
+    GLTextureMapType unit
+) -> void {
+    // Respecifying the whole store lets the driver orphan the previous one
+    // instead of waiting for the frames that still read it. Empty lists get
+    // a single zero texel, since a buffer texture can't have no storage.
+    static constexpr auto kEmpty = std::array<uint32_t, 4> {};
+    glBindBuffer(GL_TEXTURE_BUFFER, target.buffer);
+    glBufferData(
+        GL_TEXTURE_BUFFER,
+        size > 0 ? size : sizeof(kEmpty),
+        size > 0 ? data : kEmpty.data(),
+        GL_STREAM_DRAW
+    );
+
+    gl_state.BindTexture(std::to_underlying(unit), GL_TEXTURE_BUFFER, target.texture);
+}
+
+GLLights::~GLLights() {
+    for (auto target : {&light_data_, &light_clusters_, &light_indices_}) {
+        glDeleteTextures(1, &target->texture);
+        glDeleteBuffers(1, &target->buffer);
+    }
+}
+
 }
\ No newline at end of file
@@ -9,21 +9,43 @@
 
 #include "gleam/lights/light.hpp"
 
-#include "gleam/cameras/camera.hpp"
 #include "gleam/math/color.hpp"
+#include "gleam/math/matrix4.hpp"
+#include "gleam/math/sphere.hpp"
 #include "gleam/math/vector3.hpp"
+#include "gleam/math/vector4.hpp"
 
+#include "core/light_clusters.hpp"
+#include "core/object_lights.hpp"
+#include "renderer/gl/gl_state.hpp"
+#include "renderer/gl/gl_textures.hpp"
 #include "renderer/gl/gl_uniform_buffer.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
 
 namespace gleam {
 
+// Directional lights are stored in the ub_Lights uniform block and shaded by
+// every lit fragment. Point and spot lights are stored in a texture buffer
+// and binned into LightClusters, so a fragment only shades the ones that can
+// reach it, and scenes may contain thousands of them.
 class GLLights {
 public:
+    // Directional lights per scene
     static constexpr auto kMaxLights = 10;
 
+    // Point and spot lights per scene
+    static constexpr auto kMaxLocalLights = 16384;
+
+    // Attenuation is faded out to zero where it drops to this
+    // floor, which gives point and spot lights a finite range.
+    static constexpr auto kAttenuationFloor = 0.02f;
+
     struct alignas(16) UniformLight {
         alignas(4)  int type {0};
         alignas(16) Color color {0xFFFFFF};
@@ -37,17 +59,45 @@ public:
     };
 
     struct alignas(16) UniformLights {
+        alignas(16) int count {0};
         alignas(16) UniformLight lights[kMaxLights];
     };
 
-    Color ambient_light {0x000000};
+    // A point or spot light, four texels in the light data buffer
+    struct BufferLight {
+        Vector4 position; // view space, w is the light type
+        Vector4 color; // w is the range
+        Vector4 direction; // view space, w is the cosine of the cone angle
+        Vector4 attenuation; // cosine of the penumbra angle, base, linear, quadratic
+    };
+
+    // Light data for a single frame. It's collected on the CPU without
+    // touching GL, so the next frame can be prepared while one is submitted.
+    struct State {
+        UniformLights lights {};
+
+        std::vector<BufferLight> local_lights;
 
-    uint8_t ambient {0};
-    uint8_t directional {0};
-    uint8_t point {0};
-    uint8_t spot {0};
+        // View-space bounds of the local lights, binned into clusters
+        std::vector<Sphere> local_bounds;
 
-    GLLights() = default;
+        Color ambient_light {0x000000};
+
+        uint8_t ambient {0};
+        uint8_t directional {0};
+        uint32_t point {0};
+        uint32_t spot {0};
+
+        auto AddLight(Light* light, const Matrix4& view) -> void;
+
+        [[nodiscard]] auto HasLights() const -> bool;
+
+        [[nodiscard]] auto HasLocalLights() const { return !local_lights.empty(); }
+
+        auto Reset() -> void;
+    };
+
+    GLLights();
 
     // delete copy constructor and assignment operator
     GLLights(const GLLights&) = delete;
@@ -57,20 +107,56 @@ public:
     GLLights(GLLights&&) = delete;
     auto operator=(GLLights&&) -> GLLights& = delete;
 
-    auto AddLight(Light* light, Camera* camera) -> void;
-
-    auto HasLights() const -> bool;
+    // Uploads the lights of a frame and binds the buffers of the local
+    // lights. Clusters are looked up by the fragment's window coordinates,
+    // so the size of the render target is needed as well.
+    auto Update(
+        GLState& gl_state,
+        const State& state,
+        const LightClusters& clusters,
+        const ObjectLights& objects,
+        int width,
+        int height
+    ) -> void;
 
-    auto Reset() -> void;
+    // Offset of the draws' light indices in the index buffer, which
+    // starts with the indices of the clusters.
+    [[nodiscard]] auto ObjectIndicesOffset() const { return object_indices_offset_; }
 
-    auto Update() -> void;
+    ~GLLights();
 
 private:
-    UniformLights lights_ {};
+    struct alignas(16) UniformClusters {
+        Vector4 scale; // tiles per pixel, depth slice scale and bias
+        std::array<int, 4> grid; // tiles and slices
+    };
+
+    struct TextureBuffer {
+        GLuint buffer {0};
+        GLuint texture {0};
+    };
 
     GLUniformBuffer uniform_buffer_ {"ub_Lights", sizeof(UniformLights)};
 
-    unsigned int idx_ {0};
+    GLUniformBuffer clusters_buffer_ {"ub_Clusters", sizeof(UniformClusters)};
+
+    TextureBuffer light_data_;
+
+    TextureBuffer light_clusters_;
+
+    TextureBuffer light_indices_;
+
+    std::vector<uint32_t> indices_;
+
+    int object_indices_offset_ {0};
+
+    auto Upload(
+        GLState& gl_state,
+        TextureBuffer& target,
+        const void* data,
+        std::size_t size,
+        GLTextureMapType unit
+    ) -> void;
 };
 
 }
\ No newline at end of file
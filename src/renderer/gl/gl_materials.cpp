@@ -0,0 +1,153 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_materials.hpp"
+
+#include "gleam/materials/phong_material.hpp"
+#include "gleam/materials/sprite_material.hpp"
+#include "gleam/materials/unlit_material.hpp"
+#include "gleam/math/matrix3.hpp"
+
+#include "renderer/gl/gl_uniform_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace gleam {
+
+namespace {
+
+constexpr auto kInitialCapacity = std::size_t {64};
+
+constexpr auto kMaterialBinding = std::to_underlying(UniformBuffer::Material);
+
+auto pack_material(Material* material) {
+    auto data = GLMaterials::UniformMaterial {};
+    auto transform = Matrix3 {1.0f};
+
+    data.opacity = material->opacity;
+
+    if (material->GetType() == MaterialType::PhongMaterial) {
+        auto m = static_cast<PhongMaterial*>(material);
+        data.color = m->color;
+        data.specular = m->specular;
+        data.shininess = m->shininess;
+        data.texture_layer = static_cast<float>(m->texture_layer);
+        if (m->albedo_map) transform = m->albedo_map->GetTransform();
+    }
+
+    if (material->GetType() == MaterialType::SpriteMaterial) {
+        auto m = static_cast<SpriteMaterial*>(material);
+        data.color = m->color;
+        data.texture_layer = static_cast<float>(m->texture_layer);
+        if (m->albedo_map) transform = m->albedo_map->GetTransform();
+    }
+
+    if (material->GetType() == MaterialType::UnlitMaterial) {
+        auto m = static_cast<UnlitMaterial*>(material);
+        data.color = m->color;
+        data.texture_layer = static_cast<float>(m->texture_layer);
+        if (m->albedo_map) transform = m->albedo_map->GetTransform();
+    }
+
+    // std140 stores each mat3 column with the alignment of a vec4
+    for (auto i = 0; i < 3; ++i) {
+        const auto& column = transform[i];
+        data.texture_transform[i] = Vector4 {column.x, column.y, column.z, 0.0f};
+    }
+
+    return data;
+}
+
+}
+
+auto GLMaterials::BeginFrame() -> void {
+    ++frame_;
+}
+
+auto GLMaterials::Bind(GLState& state, const std::shared_ptr<Material>& material) -> void {
+    auto& id = material->renderer_id;
+    if (id == 0) id = AcquireSlot(material) + 1;
+
+    const auto index = id - 1;
+    const auto offset = static_cast<GLintptr>(index) * slot_size_;
+    auto& slot = slots_[index];
+
+    // Materials shared by many renderables are packed once per frame, and
+    // only written to the buffer when their values actually changed.
+    if (slot.frame != frame_) {
+        slot.frame = frame_;
+        const auto data = pack_material(material.get());
+        if (!slot.uploaded || std::memcmp(&data, &slot.data, sizeof(data)) != 0) {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+            glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(data), &data);
+            slot.data = data;
+            slot.uploaded = true;
+        }
+    }
+
+    state.BindUniformBufferRange(kMaterialBinding, buffer_, offset, sizeof(UniformMaterial));
+}
+
+auto GLMaterials::AcquireSlot(const std::shared_ptr<Material>& material) -> unsigned int {
+    // Slots of released materials are reclaimed only when the buffer is full,
+    // at which point none of the slots are on the free list.
+    if (free_slots_.empty() && slots_.size() == capacity_) {
+        for (auto i = 0u; i < slots_.size(); ++i) {
+            if (slots_[i].material.expired()) free_slots_.emplace_back(i);
+        }
+    }
+
+    if (!free_slots_.empty()) {
+        const auto index = free_slots_.back();
+        free_slots_.pop_back();
+        slots_[index] = {.material = material};
+        return index;
+    }
+
+    if (slots_.size() == capacity_) {
+        Reserve(std::max(kInitialCapacity, capacity_ * 2));
+    }
+
+    slots_.push_back({.material = material});
+    return static_cast<unsigned int>(slots_.size() - 1);
+}
+
+auto GLMaterials::Reserve(std::size_t capacity) -> void {
+    if (slot_size_ == 0) {
+        auto alignment = GLint {0};
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        alignment = std::max(alignment, 16);
+        const auto size = static_cast<GLsizeiptr>(sizeof(UniformMaterial));
+        slot_size_ = (size + alignment - 1) / alignment * alignment;
+    }
+
+    if (buffer_ == 0) glGenBuffers(1, &buffer_);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, capacity * slot_size_, nullptr, GL_DYNAMIC_DRAW);
+
+    // Reallocating discards the previous contents, so every
+    // material is uploaded again the next time it's bound.
+    for (auto& slot : slots_) {
+        slot.uploaded = false;
+        slot.frame = 0;
+    }
+
+    capacity_ = capacity;
+}
+
+GLMaterials::~GLMaterials() {
+    for (const auto& slot : slots_) {
+        if (auto material = slot.material.lock()) material->renderer_id = 0;
+    }
+
+    if (buffer_ != 0) glDeleteBuffers(1, &buffer_);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/materials/material.hpp"
+#include "gleam/math/color.hpp"
+#include "gleam/math/vector4.hpp"
+
+#include "renderer/gl/gl_state.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+class GLMaterials {
+public:
+    struct alignas(16) UniformMaterial {
+        alignas(16) std::array<Vector4, 3> texture_transform {};
+        alignas(16) Color color {0xFFFFFF};
+        alignas(4)  float opacity {1.0f};
+        alignas(16) Color specular {0x000000};
+        alignas(4)  float shininess {0.0f};
+        alignas(4)  float texture_layer {0.0f};
+    };
+
+    GLMaterials() = default;
+
+    GLMaterials(const GLMaterials&) = delete;
+    GLMaterials(GLMaterials&&) = delete;
+    GLMaterials& operator=(const GLMaterials&) = delete;
+    GLMaterials& operator=(GLMaterials&&) = delete;
+
+    auto BeginFrame() -> void;
+
+    auto Bind(GLState& state, const std::shared_ptr<Material>& material) -> void;
+
+    ~GLMaterials();
+
+private:
+    struct Slot {
+        std::weak_ptr<Material> material;
+        UniformMaterial data {};
+        uint64_t frame {0};
+        bool uploaded {false};
+    };
+
+    std::vector<Slot> slots_;
+
+    std::vector<unsigned int> free_slots_;
+
+    GLuint buffer_ {0};
+
+    GLsizeiptr slot_size_ {0};
+
+    std::size_t capacity_ {0};
+
+    uint64_t frame_ {0};
+
+    auto AcquireSlot(const std::shared_ptr<Material>& material) -> unsigned int;
+
+    auto Reserve(std::size_t capacity) -> void;
+};
+
+}
\ No newline at end of file
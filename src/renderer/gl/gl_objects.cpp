@@ -0,0 +1,164 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_objects.hpp"
+
+#include "gleam/math/matrix3.hpp"
+
+#include "utilities/logger.hpp"
+
+#include <algorithm>
+
+namespace gleam {
+
+namespace {
+
+constexpr auto kInitialCapacity = std::size_t {256};
+
+constexpr auto kTexelsPerObject = sizeof(GLObjects::ObjectData) / sizeof(Vector4);
+
+constexpr auto kFenceTimeout = GLuint64 {1'000'000'000};
+
+auto wait_for(GLsync& fence) {
+    if (fence == nullptr) return;
+
+    auto flags = GLbitfield {0};
+    while (true) {
+        const auto result = glClientWaitSync(fence, flags, kFenceTimeout);
+        if (result != GL_TIMEOUT_EXPIRED) break;
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+}
+
+auto GLObjects::BeginFrame(GLState& state, std::size_t count) -> void {
+    if (max_objects_ == 0) {
+        auto max_texels = GLint {0};
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_texels);
+        max_objects_ = static_cast<std::size_t>(max_texels) / kTexelsPerObject;
+    }
+
+    // A texture buffer can't grow past the limit, so the objects over it
+    // aren't drawn rather than drawn with another object's transform.
+    if (count > max_objects_) {
+        if (!warned_) {
+            Logger::Log(
+                LogLevel::Warning,
+                "Object data buffer supports up to {} objects, {} requested, skipping the rest",
+                max_objects_, count
+            );
+            warned_ = true;
+        }
+        count = max_objects_;
+    }
+
+    // The segment written this frame was last read three frames ago, so
+    // the wait normally returns immediately without stalling the CPU.
+    auto& segment = segments_[current_];
+    wait_for(segment.fence);
+
+    if (count > segment.capacity) {
+        auto capacity = std::max(kInitialCapacity, segment.capacity);
+        while (capacity < count) capacity *= 2;
+        Reserve(state, segment, std::min(capacity, max_objects_));
+    }
+
+    count_ = 0;
+    capacity_ = count;
+    if (count == 0) return;
+
+    // Unsynchronized is safe since the fence guarantees the GPU is done with
+    // the segment, and avoids the implicit sync of a regular map.
+    glBindBuffer(GL_TEXTURE_BUFFER, segment.buffer);
+    mapped_ = static_cast<ObjectData*>(glMapBufferRange(
+        GL_TEXTURE_BUFFER,
+        0,
+        count * sizeof(ObjectData),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+    ));
+}
+
+auto GLObjects::Push(const Matrix4& model) -> int {
+    if (mapped_ == nullptr || count_ == capacity_) {
+        if (!warned_) {
+            Logger::Log(
+                LogLevel::Warning,
+                "Object data buffer is full at {} objects, skipping the rest",
+                count_
+            );
+            warned_ = true;
+        }
+        return -1;
+    }
+
+    // Mapped memory is write-only and may be uncached,
+    // so the entry is assembled locally and copied once.
+    auto data = ObjectData {};
+    const auto normal_matrix = NormalMatrix(model);
+    for (auto i = 0; i < 4; ++i) {
+        data.model[i] = model[i];
+    }
+    for (auto i = 0; i < 3; ++i) {
+        const auto& column = normal_matrix[i];
+        data.normal_matrix[i] = Vector4 {column.x, column.y, column.z, 0.0f};
+    }
+
+    mapped_[count_] = data;
+    return static_cast<int>(count_++);
+}
+
+auto GLObjects::Upload(GLState& state, GLuint texture_unit) -> void {
+    auto& segment = segments_[current_];
+
+    if (mapped_ != nullptr) {
+        glBindBuffer(GL_TEXTURE_BUFFER, segment.buffer);
+        glUnmapBuffer(GL_TEXTURE_BUFFER);
+        mapped_ = nullptr;
+    }
+
+    if (segment.texture == 0) return;
+
+    state.BindTexture(texture_unit, GL_TEXTURE_BUFFER, segment.texture);
+}
+
+auto GLObjects::EndFrame() -> void {
+    auto& segment = segments_[current_];
+    if (segment.texture != 0) {
+        segment.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    current_ = (current_ + 1) % kSegments;
+}
+
+auto GLObjects::Reserve(GLState& state, Segment& segment, std::size_t capacity) -> void {
+    if (segment.buffer == 0) glGenBuffers(1, &segment.buffer);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, segment.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, capacity * sizeof(ObjectData), nullptr, GL_STREAM_DRAW);
+
+    if (segment.texture == 0) {
+        glGenTextures(1, &segment.texture);
+        state.BindTexture(GL_TEXTURE_BUFFER, segment.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, segment.buffer);
+    }
+
+    segment.capacity = capacity;
+}
+
+GLObjects::~GLObjects() {
+    for (auto& segment : segments_) {
+        if (segment.fence != nullptr) glDeleteSync(segment.fence);
+        if (segment.texture != 0) glDeleteTextures(1, &segment.texture);
+        if (segment.buffer != 0) glDeleteBuffers(1, &segment.buffer);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/math/matrix4.hpp"
+#include "gleam/math/vector4.hpp"
+
+#include "renderer/gl/gl_state.hpp"
+
+#include <array>
+#include <cstddef>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+class GLObjects {
+public:
+    struct ObjectData {
+        std::array<Vector4, 4> model {};
+        std::array<Vector4, 3> normal_matrix {};
+    };
+
+    GLObjects() = default;
+
+    GLObjects(const GLObjects&) = delete;
+    GLObjects(GLObjects&&) = delete;
+    GLObjects& operator=(const GLObjects&) = delete;
+    GLObjects& operator=(GLObjects&&) = delete;
+
+    auto BeginFrame(GLState& state, std::size_t count) -> void;
+
+    // Returns the index of the object, or -1 when the frame holds more
+    // objects than the buffer supports, in which case the draw is skipped.
+    auto Push(const Matrix4& model) -> int;
+
+    [[nodiscard]] auto Contains(int index) const {
+        return index >= 0 && static_cast<std::size_t>(index) < count_;
+    }
+
+    auto Upload(GLState& state, GLuint texture_unit) -> void;
+
+    auto EndFrame() -> void;
+
+    ~GLObjects();
+
+private:
+    static constexpr auto kSegments = 3;
+
+    struct Segment {
+        GLuint buffer {0};
+        GLuint texture {0};
+        GLsync fence {nullptr};
+        std::size_t capacity {0};
+    };
+
+    std::array<Segment, kSegments> segments_ {};
+
+    ObjectData* mapped_ {nullptr};
+
+    std::size_t max_objects_ {0};
+
+    std::size_t capacity_ {0};
+
+    std::size_t count_ {0};
+
+    int current_ {0};
+
+    bool warned_ {false};
+
+    auto Reserve(GLState& state, Segment& segment, std::size_t capacity) -> void;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_occlusion_queries.hpp"
+
+#include "gleam/geometries/box_geometry.hpp"
+#include "gleam/materials/unlit_material.hpp"
+#include "gleam/math/box3.hpp"
+#include "core/shader_library.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace gleam {
+
+namespace {
+
+constexpr auto kBoxPadding = 0.01f;
+
+constexpr auto kProxyVertexShader = R"(#version 410 core
+layout(std140) uniform ub_Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+};
+
+uniform mat4 u_Model;
+
+in vec3 a_Position;
+
+void main() {
+    gl_Position = u_Projection * u_View * u_Model * vec4(a_Position, 1.0);
+})";
+
+constexpr auto kProxyFragmentShader = R"(#version 410 core
+out vec4 v_FragColor;
+
+void main() {
+    v_FragColor = vec4(1.0);
+})";
+
+// Maps the unit cube of the proxy geometry onto a local bounding box,
+// padded by a fraction of its largest side so that flat boxes have depth
+auto box_transform(const Box3& box) {
+    const auto center = box.Center();
+    auto size = box.max - box.min;
+    const auto padding = std::max({size.x, size.y, size.z}) * kBoxPadding;
+    size += Vector3 {padding * 2.0f};
+    return Matrix4 {
+        size.x, 0.0f, 0.0f, center.x,
+        0.0f, size.y, 0.0f, center.y,
+        0.0f, 0.0f, size.z, center.z,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+}
+
+// A box that reaches behind the near plane is clipped, so
+// its query could fail even though the mesh is visible.
+auto crosses_near_plane(const Matrix4& mvp) {
+    for (auto i = 0; i < 8; ++i) {
+        const auto corner = Vector4 {
+            i & 1 ? 0.5f : -0.5f,
+            i & 2 ? 0.5f : -0.5f,
+            i & 4 ? 0.5f : -0.5f,
+            1.0f
+        };
+        const auto clip = mvp * corner;
+        if (clip.w <= 0.0f || clip.z < -clip.w) return true;
+    }
+    return false;
+}
+
+}
+
+GLOcclusionQueries::GLOcclusionQueries()
+  : program_(std::make_unique<GLProgram>(std::vector<ShaderInfo> {
+        {ShaderType::kVertexShader, kProxyVertexShader},
+        {ShaderType::kFragmentShader, kProxyFragmentShader}
+    })),
+    proxy_(BoxGeometry::Create()) {
+    // Two-sided with depth testing and without blending
+    auto material = UnlitMaterial::Create();
+    material->two_sided = true;
+    proxy_material_ = material;
+}
+
+auto GLOcclusionQueries::IsCandidate(Renderable* renderable) -> bool {
+    return renderable->GetNodeType() == NodeType::MeshNode &&
+        !renderable->GetMaterial()->transparent &&
+        renderable->GetGeometry()->VertexCount() >= kMinVertices;
+}
+
+auto GLOcclusionQueries::BeginFrame() -> void {
+    ++frame_;
+    occluded_ = 0;
+    drawn_.clear();
+
+    std::erase_if(entries_, [this](auto& item) {
+        auto& entry = item.second;
+        if (frame_ - entry.frame <= kMaxIdleFrames) return false;
+        if (entry.query != 0) glDeleteQueries(1, &entry.query);
+        return true;
+    });
+}
+
+auto GLOcclusionQueries::BeginDraw(
+    Renderable* renderable,
+    const Matrix4& world,
+    const Box3& box
+) -> bool {
+    auto& entry = entries_[renderable];
+    if (entry.uuid != renderable->UUID()) {
+        entry.uuid = renderable->UUID();
+        entry.issued = false;
+    }
+
+    if (entry.frame != frame_) {
+        entry.frame = frame_;
+        entry.visibility = Resolve(entry);
+        if (entry.visibility == Visibility::Hidden) ++occluded_;
+        drawn_.emplace_back(renderable, world, box);
+    }
+
+    if (entry.visibility == Visibility::Hidden) return false;
+
+    if (entry.visibility == Visibility::Pending) {
+        glBeginConditionalRender(entry.query, GL_QUERY_NO_WAIT);
+        conditional_ = true;
+    }
+    return true;
+}
+
+auto GLOcclusionQueries::Resolve(const Entry& entry) const -> Visibility {
+    if (!entry.issued) return Visibility::Visible;
+
+    auto available = GLuint {0};
+    glGetQueryObjectuiv(entry.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available != GL_TRUE) return Visibility::Pending;
+
+    auto passed = GLuint {0};
+    glGetQueryObjectuiv(entry.query, GL_QUERY_RESULT, &passed);
+    return passed == 0 ? Visibility::Hidden : Visibility::Visible;
+}
+
+auto GLOcclusionQueries::EndDraw() -> void {
+    if (conditional_) {
+        glEndConditionalRender();
+        conditional_ = false;
+    }
+}
+
+auto GLOcclusionQueries::Query(GLState& state, GLBuffers& buffers, const Matrix4& view_projection) -> void {
+    if (drawn_.empty()) return;
+
+    state.ProcessMaterial(proxy_material_.get());
+    state.SetColorMask(false);
+    state.SetDepthMask(false);
+    state.SetDepthFunc(GL_LEQUAL);
+    state.UseProgram(program_->Id());
+    buffers.Bind(state, proxy_);
+
+    const auto index_count = static_cast<GLsizei>(proxy_->IndexCount());
+    for (const auto& [renderable, world, box] : drawn_) {
+        auto& entry = entries_[renderable];
+        const auto model = world * box_transform(box);
+
+        // Without a query, the renderable is drawn unconditionally next frame
+        entry.issued = !crosses_near_plane(view_projection * model);
+        if (!entry.issued) continue;
+
+        if (entry.query == 0) glGenQueries(1, &entry.query);
+        program_->SetUnknownUniform("u_Model", &model);
+        program_->UpdateUniforms();
+
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, entry.query);
+        glDrawElements(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+    }
+
+    state.SetColorMask(true);
+    state.SetDepthMask(true);
+    state.SetDepthFunc(GL_LESS);
+    drawn_.clear();
+}
+
+GLOcclusionQueries::~GLOcclusionQueries() {
+    for (const auto& [_, entry] : entries_) {
+        if (entry.query != 0) glDeleteQueries(1, &entry.query);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/geometries/geometry.hpp"
+#include "gleam/materials/material.hpp"
+#include "gleam/math/box3.hpp"
+#include "gleam/math/matrix4.hpp"
+#include "gleam/nodes/renderable.hpp"
+
+#include "renderer/gl/gl_buffers.hpp"
+#include "renderer/gl/gl_program.hpp"
+#include "renderer/gl/gl_state.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+// GPU occlusion culling with a frame of latency. After the opaque pass, the
+// bounding box of every large mesh drawn in the frame is rasterized against
+// the depth buffer inside a GL_ANY_SAMPLES_PASSED query. The depth buffer
+// already contains the mesh, so boxes are padded slightly and tested with
+// GL_LEQUAL, which keeps faces that coincide with the mesh's surface, such
+// as those of flat planes, from failing the test. In the next frame,
+// a mesh whose query already found no samples isn't drawn at all. When the
+// result isn't available yet, the draw is wrapped in a conditional render
+// that the GPU skips if the query fails, so the CPU never waits on a result.
+//
+// Results are kept per renderable and released once a renderable hasn't
+// been drawn for a while, e.g. after it was removed from the scene.
+class GLOcclusionQueries {
+public:
+    // Smaller meshes cost less to draw than their query
+    static constexpr std::size_t kMinVertices = 256;
+
+    static constexpr uint64_t kMaxIdleFrames = 120;
+
+    GLOcclusionQueries();
+
+    GLOcclusionQueries(const GLOcclusionQueries&) = delete;
+    GLOcclusionQueries(GLOcclusionQueries&&) = delete;
+    GLOcclusionQueries& operator=(const GLOcclusionQueries&) = delete;
+    GLOcclusionQueries& operator=(GLOcclusionQueries&&) = delete;
+
+    [[nodiscard]] static auto IsCandidate(Renderable* renderable) -> bool;
+
+    auto BeginFrame() -> void;
+
+    // Returns false when the renderable was occluded in the previous frame.
+    // Otherwise the draw must be followed by EndDraw(). The world transform
+    // is the one the renderable is drawn with in this frame, and the box is
+    // the local bounding box captured with it (see RenderLists::LocalBoxes()). A renderable
+    // drawn more than once per frame, e.g. by the depth pre-pass and the
+    // color pass, reuses the result resolved by its first draw.
+    [[nodiscard]] auto BeginDraw(
+        Renderable* renderable,
+        const Matrix4& world,
+        const Box3& box
+    ) -> bool;
+
+    auto EndDraw() -> void;
+
+    // Issues the queries of the renderables drawn since BeginFrame(). Expects
+    // the depth buffer to contain every opaque draw of the frame.
+    auto Query(GLState& state, GLBuffers& buffers, const Matrix4& view_projection) -> void;
+
+    // Renderables skipped in the current frame
+    [[nodiscard]] auto Occluded() const { return occluded_; }
+
+    ~GLOcclusionQueries();
+
+private:
+    enum class Visibility {
+        Visible,
+        Hidden,
+        // The result isn't available yet, the GPU decides
+        Pending
+    };
+
+    struct Drawn {
+        Renderable* renderable {nullptr};
+        Matrix4 world;
+        Box3 box;
+    };
+
+    struct Entry {
+        GLuint query {0};
+        uint64_t frame {0};
+        Visibility visibility {Visibility::Visible};
+        bool issued {false};
+        // Renderables may be released and their address reused
+        std::string uuid;
+    };
+
+    std::unordered_map<Renderable*, Entry> entries_;
+
+    std::vector<Drawn> drawn_;
+
+    std::unique_ptr<GLProgram> program_;
+
+    std::shared_ptr<Geometry> proxy_;
+
+    std::shared_ptr<Material> proxy_material_;
+
+    uint64_t frame_ {0};
+
+    std::size_t occluded_ {0};
+
+    bool conditional_ {false};
+
+    [[nodiscard]] auto Resolve(const Entry& entry) const -> Visibility;
+};
+
+}
\ No newline at end of file
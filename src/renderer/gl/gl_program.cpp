@@ -17,6 +17,10 @@ namespace gleam {
 
 namespace {
 
+// GL_COMPLETION_STATUS_KHR from GL_KHR_parallel_shader_compile,
+// which the loader doesn't include since it's an extension
+constexpr auto kCompletionStatus = GLenum {0x91B1};
+
 const auto VertexAttributesMap = std::unordered_map<std::string, VertexAttributeType> {
     {"a_Position", VertexAttributeType::Position},
     {"a_Normal", VertexAttributeType::Normal},
@@ -24,45 +28,85 @@ const auto VertexAttributesMap = std::unordered_map<std::string, VertexAttribute
     {"a_Color", VertexAttributeType::Color},
     {"a_InstanceColor", VertexAttributeType::InstanceColor},
     {"a_InstanceTransform", VertexAttributeType::InstanceTransform},
+    {"a_InstanceNormalMatrix", VertexAttributeType::InstanceNormalMatrix},
+    {"a_InstanceLayer", VertexAttributeType::InstanceLayer},
 };
 
 }
 
-GLProgram::GLProgram(const std::vector<ShaderInfo>& shaders) {
+GLProgram::GLProgram(
+    const std::vector<ShaderInfo>& shaders,
+    GLProgramCache* cache,
+    std::size_t key,
+    bool deferred
+) : cache_(cache), key_(key) {
     program_ = glCreateProgram();
 
-    auto compilation_error = false;
+    if (cache_ != nullptr && cache_->Load(program_, key_, shaders)) {
+        ProcessUniforms();
+        ProcessUniformBlocks();
+        return;
+    }
+
+    // Compile and link status are only checked once the program is finished,
+    // since the queries wait for the driver to complete the work.
     for (const auto& shader_info : shaders) {
         auto shader_id = glCreateShader(GetShaderType(shader_info.type));
         auto data = shader_info.source.data();
 
         glShaderSource(shader_id, 1, &data, nullptr);
         glCompileShader(shader_id);
-
-        if (!CheckShaderCompileStatus(shader_id)) {
-            compilation_error = true;
-            break;
-        }
-
         glAttachShader(program_, shader_id);
-        glDeleteShader(shader_id);
-    }
-
-    if (compilation_error) {
-        has_errors_ = true;
-        return;
+        shaders_.emplace_back(shader_id);
     }
 
     BindVertexAttributeLocations();
 
+    if (cache_ != nullptr) {
+        glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        sources_ = shaders;
+    }
+
     glLinkProgram(program_);
-    if (!CheckProgramLinkStatus()) {
+
+    pending_ = true;
+    if (!deferred) Finish();
+}
+
+auto GLProgram::Poll() -> bool {
+    if (!pending_) return true;
+
+    auto complete = GLint {GL_FALSE};
+    glGetProgramiv(program_, kCompletionStatus, &complete);
+    if (complete == GL_FALSE) return false;
+
+    Finish();
+    return true;
+}
+
+auto GLProgram::Finish() -> void {
+    pending_ = false;
+
+    for (const auto shader_id : shaders_) {
+        if (!has_errors_ && !CheckShaderCompileStatus(shader_id)) {
+            has_errors_ = true;
+        }
+        glDetachShader(program_, shader_id);
+        glDeleteShader(shader_id);
+    }
+    shaders_.clear();
+
+    if (has_errors_ || !CheckProgramLinkStatus()) {
         has_errors_ = true;
+        sources_.clear();
         return;
     }
 
     ProcessUniforms();
     ProcessUniformBlocks();
+
+    if (cache_ != nullptr) cache_->Store(program_, key_, sources_);
+    sources_.clear();
 }
 
 auto GLProgram::UpdateUniforms() -> void {
@@ -121,6 +165,12 @@ auto GLProgram::ProcessUniforms() -> void {
             buffer.data()
         );
 
+        // Members of uniform blocks are backed by buffers, not locations
+        auto block_index = GLint {-1};
+        auto index = static_cast<GLuint>(i);
+        glGetActiveUniformsiv(program_, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block_index);
+        if (block_index != -1) continue;
+
         auto name = std::string(buffer.data(), length);
         auto idx = get_uniform_loc(name);
         if (idx != -1) {
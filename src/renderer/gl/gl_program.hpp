@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "renderer/gl/gl_program_cache.hpp"
 #include "renderer/gl/gl_uniform.hpp"
 #include "renderer/gl/gl_uniform_buffer.hpp"
 
@@ -29,7 +30,18 @@ constexpr auto uniforms_len = static_cast<int>(Uniform::KnownUniformsLength);
 
 class GLProgram {
 public:
-    explicit GLProgram(const std::vector<ShaderInfo>& shaders);
+    // Programs are loaded from the cache when it has an entry for the
+    // shaders, and compiled and stored in the cache otherwise.
+    //
+    // Deferred programs only issue the compile and link commands, so drivers
+    // with GL_KHR_parallel_shader_compile build them in the background. They
+    // stay pending, and invalid, until Poll() finds them complete.
+    explicit GLProgram(
+        const std::vector<ShaderInfo>& shaders,
+        GLProgramCache* cache = nullptr,
+        std::size_t key = 0,
+        bool deferred = false
+    );
 
     GLProgram(const GLProgram&) = delete;
     GLProgram(GLProgram&&) = delete;
@@ -38,10 +50,21 @@ public:
 
     auto UpdateUniforms() -> void;
 
-    auto IsValid() const { return !has_errors_ && program_ > 0; }
+    auto IsValid() const { return !pending_ && !has_errors_ && program_ > 0; }
+
+    auto IsPending() const { return pending_; }
+
+    // Checks whether a deferred program finished compiling and linking
+    // without blocking, and finishes it if so. Returns true once the
+    // program is no longer pending.
+    auto Poll() -> bool;
 
     auto Id() const { return program_; }
 
+    auto HasUnknownUniform(const std::string& name) const {
+        return unknown_uniforms_.contains(name);
+    }
+
     auto SetUnknownUniform(const std::string& name, const void* v) -> void;
 
     auto SetUniform(Uniform uniform, const void* v) -> void;
@@ -53,10 +76,23 @@ private:
 
     std::array<std::unique_ptr<GLUniform>, uniforms_len> uniforms_ {nullptr};
 
+    // Kept until a deferred program is finished
+    std::vector<ShaderInfo> sources_;
+
+    std::vector<GLuint> shaders_;
+
+    GLProgramCache* cache_ {nullptr};
+
+    std::size_t key_ {0};
+
     GLuint program_ {0};
 
     bool has_errors_ {false};
 
+    bool pending_ {false};
+
+    auto Finish() -> void;
+
     auto BindVertexAttributeLocations() const -> void;
 
     auto GetUniformLoc(std::string_view name) const -> int;
@@ -0,0 +1,155 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_program_cache.hpp"
+
+#include "utilities/file.hpp"
+#include "utilities/logger.hpp"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+
+namespace gleam {
+
+namespace {
+
+// FNV-1a, which is stable across runs and platforms unlike std::hash
+auto hash(std::string_view data, uint64_t seed = 0xCBF29CE484222325ull) {
+    auto h = seed;
+    for (const auto c : data) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+auto hash_sources(const std::vector<ShaderInfo>& sources) {
+    auto h = hash("");
+    for (const auto& shader : sources) {
+        h = hash(shader.source, hash(std::string_view {"\0", 1}, h));
+    }
+    return h;
+}
+
+auto get_string(GLenum name) {
+    const auto value = reinterpret_cast<const char*>(glGetString(name));
+    return std::string_view {value != nullptr ? value : ""};
+}
+
+}
+
+GLProgramCache::GLProgramCache(const fs::path& directory) : directory_(directory) {
+    auto formats = GLint {0};
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0) {
+        Logger::Log(LogLevel::Warning, "The driver doesn't support program binaries, shaders aren't cached");
+        return;
+    }
+
+    auto error = std::error_code {};
+    fs::create_directories(directory_, error);
+    if (error) {
+        Logger::Log(LogLevel::Warning, "Unable to create the shader cache directory '{}'", directory_.string());
+        return;
+    }
+
+    driver_ = hash(get_string(GL_VENDOR));
+    driver_ = hash(get_string(GL_RENDERER), driver_);
+    driver_ = hash(get_string(GL_VERSION), driver_);
+    enabled_ = true;
+}
+
+auto GLProgramCache::Load(
+    GLuint program,
+    std::size_t key,
+    const std::vector<ShaderInfo>& sources
+) -> bool {
+    if (!enabled_) return false;
+
+    const auto source = hash_sources(sources);
+    const auto path = EntryPath(key, source);
+    auto file = std::ifstream {path, std::ios::binary};
+    if (!file) return false;
+
+    auto header = Header {};
+    read_binary(file, header);
+    if (!file ||
+        std::memcmp(header.magic, Header {}.magic, 4) != 0 ||
+        header.version != Header {}.version ||
+        header.driver != driver_ ||
+        header.source != source) {
+        return false;
+    }
+
+    auto binary = std::vector<char>(header.size);
+    read_binary(file, binary, header.size);
+    if (!file) return false;
+
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(header.size));
+
+    auto success = GLint {0};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (success == GL_FALSE) {
+        Logger::Log(LogLevel::Warning, "The driver rejected cached shader program {}, recompiling", key);
+        auto error = std::error_code {};
+        fs::remove(path, error);
+        return false;
+    }
+
+    return true;
+}
+
+auto GLProgramCache::Store(
+    GLuint program,
+    std::size_t key,
+    const std::vector<ShaderInfo>& sources
+) -> void {
+    if (!enabled_) return;
+
+    auto size = GLint {0};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) return;
+
+    auto header = Header {
+        .driver = driver_,
+        .source = hash_sources(sources)
+    };
+    auto binary = std::vector<char>(static_cast<std::size_t>(size));
+    auto length = GLsizei {0};
+    auto format = GLenum {0};
+    glGetProgramBinary(program, size, &length, &format, binary.data());
+    header.format = format;
+    header.size = static_cast<uint32_t>(length);
+
+    // Entries are written to a temporary file first, so that a run that's
+    // interrupted, or a second instance, never reads a partial entry.
+    const auto path = EntryPath(key, header.source);
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        auto file = std::ofstream {temporary, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) {
+            Logger::Log(LogLevel::Warning, "Unable to write cached shader program {}", key);
+            return;
+        }
+    }
+
+    auto error = std::error_code {};
+    fs::rename(temporary, path, error);
+    if (error) fs::remove(temporary, error);
+}
+
+auto GLProgramCache::EntryPath(std::size_t key, uint64_t source) const -> fs::path {
+    return directory_ / std::format("{:016x}_{:016x}_{:016x}.bin", key, source, driver_);
+}
+
+}
\ No newline at end of file
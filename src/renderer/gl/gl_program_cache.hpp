@@ -0,0 +1,66 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "core/shader_library.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+namespace fs = std::filesystem;
+
+// Persists linked programs between runs, so that only the first run compiles
+// shaders from source. Entries are written with glGetProgramBinary and keyed
+// by the program key, a hash of the processed sources, and the vendor,
+// renderer and version strings of the driver, since a binary is only valid
+// for the driver that produced it. Drivers may still reject a binary, e.g.
+// after an update that kept the version string, so loading can always fail
+// and callers fall back to compiling from source.
+class GLProgramCache {
+public:
+    explicit GLProgramCache(const fs::path& directory);
+
+    // The cache is disabled when the driver supports no binary formats,
+    // or the directory can't be created.
+    [[nodiscard]] auto IsEnabled() const { return enabled_; }
+
+    // Loads the stored binary of the sources into the program. Returns false
+    // when there's no entry or the driver rejects it, in which case the
+    // program is left unlinked.
+    auto Load(GLuint program, std::size_t key, const std::vector<ShaderInfo>& sources) -> bool;
+
+    // Stores a linked program. The program must have been linked with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    auto Store(GLuint program, std::size_t key, const std::vector<ShaderInfo>& sources) -> void;
+
+private:
+    struct Header {
+        char magic[4] {'G', 'L', 'P', 'B'};
+        uint32_t version {1};
+        uint64_t driver {0};
+        uint64_t source {0};
+        uint32_t format {0};
+        uint32_t size {0};
+    };
+
+    fs::path directory_;
+
+    uint64_t driver_ {0};
+
+    bool enabled_ {false};
+
+    [[nodiscard]] auto EntryPath(std::size_t key, uint64_t source) const -> fs::path;
+};
+
+}
\ No newline at end of file
@@ -9,10 +9,42 @@
 
 #include "utilities/logger.hpp"
 
+#include <string_view>
 #include <vector>
 
 namespace gleam {
 
+namespace {
+
+auto has_parallel_compile() {
+    auto count = GLint {0};
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (auto i = 0; i < count; ++i) {
+        const auto name = std::string_view {
+            reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))
+        };
+        if (name == "GL_KHR_parallel_shader_compile" || name == "GL_ARB_parallel_shader_compile") {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+GLPrograms::GLPrograms(const Parameters& params) {
+    if (!params.cache_directory.empty()) {
+        cache_ = std::make_unique<GLProgramCache>(params.cache_directory);
+    }
+
+    if (params.parallel) {
+        parallel_ = has_parallel_compile();
+        if (!parallel_) {
+            Logger::Log(LogLevel::Warning, "Parallel shader compilation isn't supported, compiling on demand");
+        }
+    }
+}
+
 auto GLPrograms::GetProgram(const ProgramAttributes& attrs) -> GLProgram* {
     const auto& key = attrs.key;
     if (!programs_.contains(key)) {
@@ -21,16 +53,23 @@ auto GLPrograms::GetProgram(const ProgramAttributes& attrs) -> GLProgram* {
             return nullptr;
         }
 
-        programs_[key] = std::make_unique<GLProgram>(sources);
+        auto& program = programs_[key];
+        program = std::make_unique<GLProgram>(sources, cache_.get(), key, parallel_);
+        if (program->IsPending()) pending_.emplace_back(program.get());
 
         Logger::Log(
             LogLevel::Info,
             "Created a new shader program {}:{}",
-            key, Material::TypeToString(attrs.type)
+            key, attrs.depth_only ? "depth" : Material::TypeToString(attrs.type)
         );
 
     }
     return programs_[key].get();
 }
 
+auto GLPrograms::Poll() -> std::size_t {
+    std::erase_if(pending_, [](GLProgram* program) { return program->Poll(); });
+    return pending_.size();
+}
+
 }
\ No newline at end of file
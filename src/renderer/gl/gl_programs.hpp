@@ -10,20 +10,50 @@
 #include "core/program_attributes.hpp"
 #include "core/shader_library.hpp"
 #include "renderer/gl/gl_program.hpp"
+#include "renderer/gl/gl_program_cache.hpp"
 
+#include <cstddef>
+#include <filesystem>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace gleam {
 
 class GLPrograms {
 public:
+    struct Parameters {
+        // Linked programs are cached in the directory between runs,
+        // unless the path is empty (see GLProgramCache).
+        fs::path cache_directory {};
+        // Compiles programs in the background when the driver supports
+        // GL_KHR_parallel_shader_compile, instead of blocking the frame
+        // that first needs them.
+        bool parallel {false};
+    };
+
+    explicit GLPrograms(const Parameters& params);
+
+    // New programs are pending when compiled in the background. Pending
+    // programs are invalid, so the objects that use them are skipped.
     auto GetProgram(const ProgramAttributes& attrs) -> GLProgram*;
 
+    // Finishes the pending programs that the driver completed, without
+    // blocking, and returns the number of programs still pending.
+    auto Poll() -> std::size_t;
+
+    [[nodiscard]] auto IsParallel() const { return parallel_; }
+
 private:
     ShaderLibrary shader_lib_;
 
+    std::unique_ptr<GLProgramCache> cache_;
+
     std::unordered_map<std::size_t, std::unique_ptr<GLProgram>> programs_ {};
+
+    std::vector<GLProgram*> pending_;
+
+    bool parallel_ {false};
 };
 
 }
\ No newline at end of file
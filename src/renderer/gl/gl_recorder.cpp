@@ -0,0 +1,1220 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/gl/gl_recorder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gleam {
+
+namespace {
+
+using Args = std::array<int64_t, 4>;
+
+using enum GLRecorder::CommandType;
+
+// Bindings and state are tracked in a single map. Every key
+// combines the kind of state with up to two sub-keys, such as
+// a texture unit and a target, or a capability.
+enum class Slot : uint64_t {
+    ActiveTexture,
+    BlendEquation,
+    BlendFunc,
+    Buffer,
+    Capability,
+    ClearColor,
+    ColorMask,
+    CullFace,
+    DepthFunc,
+    DepthMask,
+    Framebuffer,
+    FrontFace,
+    IndexedBuffer,
+    PixelStore,
+    PolygonMode,
+    PolygonOffset,
+    Program,
+    Renderbuffer,
+    TexParameter,
+    Texture,
+    VertexArray,
+    VertexAttribArray,
+    VertexAttribDivisor,
+    Viewport
+};
+
+struct ProgramInfo {
+    std::vector<std::string> sources;
+    std::vector<std::pair<std::string, GLenum>> uniforms;
+    std::vector<std::string> blocks;
+    // Set when a program binary was rejected, until the program is linked
+    bool rejected {false};
+    // Completion status queries since the last link, which report
+    // the link as finished from the second query on
+    int polls {0};
+};
+
+// Reported through glGetStringi. glad fails to load unless at least one
+// extension is reported, and parallel compilation and anisotropic filtering
+// are reported so that asynchronous programs and anisotropy can be exercised.
+constexpr auto kExtensions = std::array {
+    "GL_GLEAM_recorder",
+    "GL_EXT_texture_filter_anisotropic",
+    "GL_KHR_parallel_shader_compile"
+};
+
+// GL_COMPLETION_STATUS_KHR, which glad doesn't define
+constexpr auto kCompletionStatus = GLenum {0x91B1};
+
+// GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, which glad doesn't define
+constexpr auto kMaxTextureMaxAnisotropy = GLenum {0x84FF};
+
+// Program binaries are the sources of the program, each followed by a null
+// character, after a magic string. Binaries in any other format are rejected.
+constexpr auto kBinaryFormat = GLenum {0x4752};
+constexpr auto kBinaryMagic = std::string_view {"GLREC", 6};
+
+struct Mapping {
+    GLuint buffer {0};
+    GLintptr offset {0};
+    GLsizeiptr length {0};
+    GLbitfield access {0};
+};
+
+struct Recorder {
+    std::vector<GLRecorder::Command> commands;
+    GLRecorder::Counters counters;
+
+    std::unordered_map<uint64_t, Args> state;
+    std::unordered_map<uint64_t, std::vector<std::byte>> uniform_values;
+    std::unordered_map<GLuint, std::vector<std::byte>> buffers;
+    std::unordered_map<GLuint, std::string> shaders;
+    std::unordered_map<GLuint, ProgramInfo> programs;
+    std::unordered_map<GLenum, Mapping> mappings;
+
+    GLuint next_name {1};
+    GLuint active_unit {0};
+    GLuint program {0};
+    GLuint vertex_array {0};
+};
+
+auto recorder() -> Recorder& {
+    static auto instance = Recorder {};
+    return instance;
+}
+
+auto key(Slot slot, uint64_t a = 0, uint64_t b = 0) -> uint64_t {
+    return std::to_underlying(slot) << 56 | (a & 0xFFFFFF) << 32 | (b & 0xFFFFFFFF);
+}
+
+auto bits(GLfloat value) -> int64_t {
+    return std::bit_cast<int32_t>(value);
+}
+
+auto record(GLRecorder::CommandType type, const char* function, const Args& args = {}) {
+    auto& r = recorder();
+    r.commands.emplace_back(type, function, args);
+    ++r.counters.commands;
+}
+
+// Records a bind or state change, and counts it as redundant
+// when the tracked value under the key is already the same.
+auto track(
+    GLRecorder::CommandType type,
+    const char* function,
+    uint64_t slot_key,
+    const Args& value,
+    const Args& args
+) {
+    auto& r = recorder();
+    auto& total = type == Bind ? r.counters.binds : r.counters.state_changes;
+    auto& redundant = type == Bind ? r.counters.redundant_binds : r.counters.redundant_state_changes;
+
+    ++total;
+    auto [it, inserted] = r.state.try_emplace(slot_key, value);
+    const auto is_redundant = !inserted && it->second == value;
+    if (is_redundant) ++redundant;
+    it->second = value;
+
+    record(type, function, args);
+    r.commands.back().redundant = is_redundant;
+}
+
+auto state_change(const char* function, const Args& args) {
+    ++recorder().counters.state_changes;
+    record(State, function, args);
+}
+
+auto query() {
+    ++recorder().counters.queries;
+}
+
+auto buffer_key(GLenum target) {
+    // Element array bindings are part of the vertex array state
+    const auto vertex_array = target == GL_ELEMENT_ARRAY_BUFFER ? recorder().vertex_array : 0;
+    return key(Slot::Buffer, vertex_array, target);
+}
+
+auto tracked(uint64_t slot_key) -> GLuint {
+    const auto& state = recorder().state;
+    const auto it = state.find(slot_key);
+    return it != state.end() ? static_cast<GLuint>(it->second[0]) : 0;
+}
+
+auto generate(GLsizei n, GLuint* names, const char* function) {
+    auto& r = recorder();
+    for (auto i = 0; i < n; ++i) {
+        names[i] = r.next_name++;
+    }
+    record(Resource, function, {n});
+}
+
+// Drops bindings of a deleted object, since GL unbinds it as well
+auto forget(std::initializer_list<Slot> slots, GLuint name) {
+    std::erase_if(recorder().state, [&](const auto& entry) {
+        const auto slot = static_cast<Slot>(entry.first >> 56);
+        return std::ranges::find(slots, slot) != slots.end() && entry.second[0] == name;
+    });
+}
+
+auto copy_name(std::string_view name, GLsizei size, GLsizei* length, GLchar* out) {
+    if (out == nullptr || size <= 0) return;
+    const auto n = std::min(static_cast<std::size_t>(size - 1), name.size());
+    std::memcpy(out, name.data(), n);
+    out[n] = '\0';
+    if (length != nullptr) *length = static_cast<GLsizei>(n);
+}
+
+#pragma region Reflection
+
+auto uniform_type(std::string_view type) -> GLenum {
+    static const auto types = std::unordered_map<std::string_view, GLenum> {
+        {"bool", GL_BOOL},
+        {"float", GL_FLOAT},
+        {"int", GL_INT},
+        {"mat3", GL_FLOAT_MAT3},
+        {"mat4", GL_FLOAT_MAT4},
+        {"sampler2D", GL_SAMPLER_2D},
+        {"sampler2DArray", GL_SAMPLER_2D_ARRAY},
+        {"samplerBuffer", GL_SAMPLER_BUFFER},
+        {"samplerCube", GL_SAMPLER_CUBE},
+        {"usamplerBuffer", GL_UNSIGNED_INT_SAMPLER_BUFFER},
+        {"vec2", GL_FLOAT_VEC2},
+        {"vec3", GL_FLOAT_VEC3},
+        {"vec4", GL_FLOAT_VEC4}
+    };
+    const auto it = types.find(type);
+    return it != types.end() ? it->second : GL_NONE;
+}
+
+// Splits GLSL source into identifiers and single punctuation characters,
+// skipping comments. Preprocessor conditionals aren't evaluated, so every
+// declaration in the source is reported as active.
+auto tokenize(std::string_view source) {
+    auto tokens = std::vector<std::string_view> {};
+    auto i = std::size_t {0};
+    while (i < source.size()) {
+        const auto c = source[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (source.substr(i, 2) == "//") {
+            i = std::min(source.find('\n', i), source.size());
+        } else if (source.substr(i, 2) == "/*") {
+            i = std::min(source.find("*/", i + 2), source.size() - 2) + 2;
+        } else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+            const auto start = i;
+            while (i < source.size() && (std::isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_')) {
+                ++i;
+            }
+            tokens.emplace_back(source.substr(start, i - start));
+        } else {
+            tokens.emplace_back(source.substr(i++, 1));
+        }
+    }
+    return tokens;
+}
+
+auto serialize(const ProgramInfo& program) {
+    auto binary = std::string {kBinaryMagic};
+    for (const auto& source : program.sources) {
+        binary += source;
+        binary += '\0';
+    }
+    return binary;
+}
+
+auto reflect(ProgramInfo& program) {
+    auto& uniforms = program.uniforms;
+    auto& blocks = program.blocks;
+    uniforms.clear();
+    blocks.clear();
+
+    for (const auto& source : program.sources) {
+        const auto tokens = tokenize(source);
+        for (auto i = std::size_t {0}; i + 2 < tokens.size(); ++i) {
+            if (tokens[i] != "uniform") continue;
+
+            auto j = i + 1;
+            while (j < tokens.size() && (tokens[j] == "lowp" || tokens[j] == "mediump" || tokens[j] == "highp")) {
+                ++j;
+            }
+            if (j + 1 >= tokens.size()) break;
+
+            if (tokens[j + 1] == "{") {
+                const auto name = std::string {tokens[j]};
+                if (std::ranges::find(blocks, name) == blocks.end()) blocks.emplace_back(name);
+                continue;
+            }
+
+            const auto type = uniform_type(tokens[j]);
+            if (type == GL_NONE) continue;
+
+            // Arrays are reported by the name of their first element
+            auto name = std::string {tokens[j + 1]};
+            if (j + 2 < tokens.size() && tokens[j + 2] == "[") name += "[0]";
+            const auto declared = std::ranges::any_of(uniforms, [&](const auto& u) {
+                return u.first == name;
+            });
+            if (!declared) uniforms.emplace_back(name, type);
+        }
+    }
+}
+
+#pragma endregion
+
+#pragma region Queries
+
+auto APIENTRY check_framebuffer_status(GLenum target) -> GLenum {
+    query();
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+auto APIENTRY get_error() -> GLenum {
+    query();
+    return GL_NO_ERROR;
+}
+
+auto APIENTRY get_integerv(GLenum pname, GLint* data) -> void {
+    query();
+    switch (pname) {
+        case GL_NUM_EXTENSIONS: *data = static_cast<GLint>(kExtensions.size()); break;
+        case GL_MAX_TEXTURE_BUFFER_SIZE: *data = 1 << 27; break;
+        case GL_MAX_TEXTURE_SIZE: *data = 16384; break;
+        case GL_NUM_PROGRAM_BINARY_FORMATS: *data = 1; break;
+        case GL_PROGRAM_BINARY_FORMATS: *data = kBinaryFormat; break;
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *data = 256; break;
+        default: *data = 0; break;
+    }
+}
+
+auto APIENTRY get_floatv(GLenum pname, GLfloat* data) -> void {
+    query();
+    switch (pname) {
+        case kMaxTextureMaxAnisotropy: *data = 16.0f; break;
+        default: *data = 0.0f; break;
+    }
+}
+
+auto APIENTRY get_string(GLenum name) -> const GLubyte* {
+    query();
+    const auto value = [name]() {
+        switch (name) {
+            case GL_VENDOR: return "Gleam";
+            case GL_RENDERER: return "Gleam GL Recorder";
+            case GL_VERSION: return "4.1 Gleam GL Recorder";
+            case GL_SHADING_LANGUAGE_VERSION: return "4.10";
+            default: return "";
+        }
+    }();
+    return reinterpret_cast<const GLubyte*>(value);
+}
+
+auto APIENTRY get_stringi(GLenum name, GLuint index) -> const GLubyte* {
+    query();
+    const auto value = name == GL_EXTENSIONS && index < kExtensions.size() ? kExtensions[index] : "";
+    return reinterpret_cast<const GLubyte*>(value);
+}
+
+auto APIENTRY get_shaderiv(GLuint shader, GLenum pname, GLint* params) -> void {
+    query();
+    *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+auto APIENTRY get_shader_info_log(GLuint shader, GLsizei size, GLsizei* length, GLchar* log) -> void {
+    query();
+    copy_name("", size, length, log);
+}
+
+auto APIENTRY get_programiv(GLuint program, GLenum pname, GLint* params) -> void {
+    query();
+    auto& info = recorder().programs[program];
+
+    // Name lengths include the null terminator
+    auto uniform_length = std::size_t {0};
+    for (const auto& [name, _] : info.uniforms) {
+        uniform_length = std::max(uniform_length, name.size() + 1);
+    }
+    auto block_length = std::size_t {0};
+    for (const auto& name : info.blocks) {
+        block_length = std::max(block_length, name.size() + 1);
+    }
+
+    switch (pname) {
+        case GL_LINK_STATUS: *params = info.rejected ? GL_FALSE : GL_TRUE; break;
+        case kCompletionStatus: *params = ++info.polls > 1 ? GL_TRUE : GL_FALSE; break;
+        case GL_PROGRAM_BINARY_LENGTH: *params = static_cast<GLint>(serialize(info).size()); break;
+        case GL_ACTIVE_UNIFORMS: *params = static_cast<GLint>(info.uniforms.size()); break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH: *params = static_cast<GLint>(uniform_length); break;
+        case GL_ACTIVE_UNIFORM_BLOCKS: *params = static_cast<GLint>(info.blocks.size()); break;
+        case GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH: *params = static_cast<GLint>(block_length); break;
+        default: *params = 0; break;
+    }
+}
+
+auto APIENTRY get_program_info_log(GLuint program, GLsizei size, GLsizei* length, GLchar* log) -> void {
+    query();
+    copy_name("", size, length, log);
+}
+
+auto APIENTRY get_active_uniform(
+    GLuint program,
+    GLuint index,
+    GLsizei size,
+    GLsizei* length,
+    GLint* count,
+    GLenum* type,
+    GLchar* name
+) -> void {
+    query();
+    const auto& uniform = recorder().programs[program].uniforms.at(index);
+    copy_name(uniform.first, size, length, name);
+    *count = 1;
+    *type = uniform.second;
+}
+
+auto APIENTRY get_active_uniformsiv(
+    GLuint program,
+    GLsizei count,
+    const GLuint* indices,
+    GLenum pname,
+    GLint* params
+) -> void {
+    query();
+    // Reflected uniforms never belong to a block, and other
+    // properties aren't read by the renderer.
+    for (auto i = 0; i < count; ++i) {
+        params[i] = pname == GL_UNIFORM_BLOCK_INDEX ? -1 : 0;
+    }
+}
+
+auto APIENTRY get_active_uniform_block_name(
+    GLuint program,
+    GLuint index,
+    GLsizei size,
+    GLsizei* length,
+    GLchar* name
+) -> void {
+    query();
+    copy_name(recorder().programs[program].blocks.at(index), size, length, name);
+}
+
+auto APIENTRY get_uniform_location(GLuint program, const GLchar* name) -> GLint {
+    query();
+    const auto& uniforms = recorder().programs[program].uniforms;
+    const auto it = std::ranges::find(uniforms, std::string_view {name}, [](const auto& u) {
+        return std::string_view {u.first};
+    });
+    return it != uniforms.end() ? static_cast<GLint>(it - uniforms.begin()) : -1;
+}
+
+auto APIENTRY get_program_binary(
+    GLuint program,
+    GLsizei size,
+    GLsizei* length,
+    GLenum* format,
+    void* binary
+) -> void {
+    query();
+    const auto data = serialize(recorder().programs[program]);
+    const auto n = std::min(data.size(), static_cast<std::size_t>(size));
+    std::memcpy(binary, data.data(), n);
+    if (length != nullptr) *length = static_cast<GLsizei>(n);
+    *format = kBinaryFormat;
+    recorder().counters.bytes_read += n;
+    record(Query, "glGetProgramBinary", {program, static_cast<int64_t>(n)});
+}
+
+auto APIENTRY get_query_objectuiv(GLuint id, GLenum pname, GLuint* params) -> void {
+    query();
+    record(Query, "glGetQueryObjectuiv", {id, pname});
+    // Nothing is rasterized, so every query is finished and passes
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 1;
+}
+
+#pragma endregion
+
+#pragma region Resources
+
+auto APIENTRY gen_buffers(GLsizei n, GLuint* buffers) -> void {
+    generate(n, buffers, "glGenBuffers");
+}
+
+auto APIENTRY gen_framebuffers(GLsizei n, GLuint* framebuffers) -> void {
+    generate(n, framebuffers, "glGenFramebuffers");
+}
+
+auto APIENTRY gen_queries(GLsizei n, GLuint* ids) -> void {
+    generate(n, ids, "glGenQueries");
+}
+
+auto APIENTRY gen_renderbuffers(GLsizei n, GLuint* renderbuffers) -> void {
+    generate(n, renderbuffers, "glGenRenderbuffers");
+}
+
+auto APIENTRY gen_textures(GLsizei n, GLuint* textures) -> void {
+    generate(n, textures, "glGenTextures");
+}
+
+auto APIENTRY gen_vertex_arrays(GLsizei n, GLuint* arrays) -> void {
+    generate(n, arrays, "glGenVertexArrays");
+}
+
+auto APIENTRY delete_buffers(GLsizei n, const GLuint* buffers) -> void {
+    for (auto i = 0; i < n; ++i) {
+        recorder().buffers.erase(buffers[i]);
+        forget({Slot::Buffer, Slot::IndexedBuffer}, buffers[i]);
+    }
+    record(Resource, "glDeleteBuffers", {n});
+}
+
+auto APIENTRY delete_framebuffers(GLsizei n, const GLuint* framebuffers) -> void {
+    for (auto i = 0; i < n; ++i) {
+        forget({Slot::Framebuffer}, framebuffers[i]);
+    }
+    record(Resource, "glDeleteFramebuffers", {n});
+}
+
+auto APIENTRY delete_queries(GLsizei n, const GLuint* ids) -> void {
+    record(Resource, "glDeleteQueries", {n});
+}
+
+auto APIENTRY delete_renderbuffers(GLsizei n, const GLuint* renderbuffers) -> void {
+    for (auto i = 0; i < n; ++i) {
+        forget({Slot::Renderbuffer}, renderbuffers[i]);
+    }
+    record(Resource, "glDeleteRenderbuffers", {n});
+}
+
+auto APIENTRY renderbuffer_storage(GLenum target, GLenum format, GLsizei width, GLsizei height) -> void {
+    record(Resource, "glRenderbufferStorage", {target, format, width, height});
+}
+
+auto APIENTRY renderbuffer_storage_multisample(
+    GLenum target,
+    GLsizei samples,
+    GLenum format,
+    GLsizei width,
+    GLsizei height
+) -> void {
+    record(Resource, "glRenderbufferStorageMultisample", {samples, format, width, height});
+}
+
+auto APIENTRY framebuffer_renderbuffer(
+    GLenum target,
+    GLenum attachment,
+    GLenum renderbuffer_target,
+    GLuint renderbuffer
+) -> void {
+    record(Resource, "glFramebufferRenderbuffer", {target, attachment, renderbuffer});
+}
+
+auto APIENTRY delete_textures(GLsizei n, const GLuint* textures) -> void {
+    for (auto i = 0; i < n; ++i) {
+        forget({Slot::Texture}, textures[i]);
+    }
+    record(Resource, "glDeleteTextures", {n});
+}
+
+auto APIENTRY create_shader(GLenum type) -> GLuint {
+    auto& r = recorder();
+    const auto shader = r.next_name++;
+    r.shaders[shader] = {};
+    record(Resource, "glCreateShader", {type, shader});
+    return shader;
+}
+
+auto APIENTRY shader_source(
+    GLuint shader,
+    GLsizei count,
+    const GLchar* const* strings,
+    const GLint* lengths
+) -> void {
+    auto& source = recorder().shaders[shader];
+    source.clear();
+    for (auto i = 0; i < count; ++i) {
+        lengths != nullptr && lengths[i] >= 0
+            ? source.append(strings[i], static_cast<std::size_t>(lengths[i]))
+            : source.append(strings[i]);
+    }
+    record(Resource, "glShaderSource", {shader, count});
+}
+
+auto APIENTRY compile_shader(GLuint shader) -> void {
+    record(Resource, "glCompileShader", {shader});
+}
+
+auto APIENTRY delete_shader(GLuint shader) -> void {
+    recorder().shaders.erase(shader);
+    record(Resource, "glDeleteShader", {shader});
+}
+
+auto APIENTRY create_program() -> GLuint {
+    auto& r = recorder();
+    const auto program = r.next_name++;
+    r.programs[program] = {};
+    record(Resource, "glCreateProgram", {program});
+    return program;
+}
+
+auto APIENTRY attach_shader(GLuint program, GLuint shader) -> void {
+    auto& r = recorder();
+    r.programs[program].sources.emplace_back(r.shaders[shader]);
+    record(Resource, "glAttachShader", {program, shader});
+}
+
+auto APIENTRY detach_shader(GLuint program, GLuint shader) -> void {
+    record(Resource, "glDetachShader", {program, shader});
+}
+
+auto APIENTRY bind_attrib_location(GLuint program, GLuint index, const GLchar* name) -> void {
+    record(Resource, "glBindAttribLocation", {program, index});
+}
+
+auto APIENTRY link_program(GLuint program) -> void {
+    auto& info = recorder().programs[program];
+    info.rejected = false;
+    info.polls = 0;
+    reflect(info);
+    record(Resource, "glLinkProgram", {program});
+}
+
+auto APIENTRY program_binary(GLuint program, GLenum format, const void* binary, GLsizei length) -> void {
+    auto& info = recorder().programs[program];
+    const auto data = std::string_view {static_cast<const char*>(binary), static_cast<std::size_t>(length)};
+    info.sources.clear();
+    info.rejected = format != kBinaryFormat || !data.starts_with(kBinaryMagic);
+    if (!info.rejected) {
+        auto start = kBinaryMagic.size();
+        for (auto end = data.find('\0', start); end != std::string_view::npos; end = data.find('\0', start)) {
+            info.sources.emplace_back(data.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+    reflect(info);
+    record(Resource, "glProgramBinary", {program, format, length});
+}
+
+auto APIENTRY program_parameteri(GLuint program, GLenum pname, GLint value) -> void {
+    record(Resource, "glProgramParameteri", {program, pname, value});
+}
+
+auto APIENTRY delete_program(GLuint program) -> void {
+    auto& r = recorder();
+    r.programs.erase(program);
+    std::erase_if(r.uniform_values, [program](const auto& entry) {
+        return entry.first >> 32 == program;
+    });
+    record(Resource, "glDeleteProgram", {program});
+}
+
+auto APIENTRY uniform_block_binding(GLuint program, GLuint index, GLuint binding) -> void {
+    record(Resource, "glUniformBlockBinding", {program, index, binding});
+}
+
+auto APIENTRY tex_buffer(GLenum target, GLenum format, GLuint buffer) -> void {
+    record(Resource, "glTexBuffer", {target, format, buffer});
+}
+
+auto APIENTRY fence_sync(GLenum condition, GLbitfield flags) -> GLsync {
+    const auto name = recorder().next_name++;
+    record(Resource, "glFenceSync", {condition, flags, name});
+    return reinterpret_cast<GLsync>(static_cast<uintptr_t>(name));
+}
+
+auto APIENTRY client_wait_sync(GLsync sync, GLbitfield flags, GLuint64 timeout) -> GLenum {
+    const auto name = static_cast<int64_t>(reinterpret_cast<uintptr_t>(sync));
+    record(Resource, "glClientWaitSync", {name, flags});
+    return GL_ALREADY_SIGNALED;
+}
+
+auto APIENTRY delete_sync(GLsync sync) -> void {
+    const auto name = static_cast<int64_t>(reinterpret_cast<uintptr_t>(sync));
+    record(Resource, "glDeleteSync", {name});
+}
+
+#pragma endregion
+
+#pragma region Bindings
+
+auto APIENTRY bind_buffer(GLenum target, GLuint buffer) -> void {
+    track(Bind, "glBindBuffer", buffer_key(target), {buffer}, {target, buffer});
+}
+
+auto APIENTRY bind_buffer_base(GLenum target, GLuint index, GLuint buffer) -> void {
+    // Binding to an indexed target also binds the buffer to the generic target
+    recorder().state[buffer_key(target)] = {buffer};
+    track(
+        Bind, "glBindBufferBase",
+        key(Slot::IndexedBuffer, index, target),
+        {buffer, 0, -1},
+        {target, index, buffer}
+    );
+}
+
+auto APIENTRY bind_buffer_range(
+    GLenum target,
+    GLuint index,
+    GLuint buffer,
+    GLintptr offset,
+    GLsizeiptr size
+) -> void {
+    recorder().state[buffer_key(target)] = {buffer};
+    track(
+        Bind, "glBindBufferRange",
+        key(Slot::IndexedBuffer, index, target),
+        {buffer, offset, size},
+        {target, index, buffer, offset}
+    );
+}
+
+auto APIENTRY bind_framebuffer(GLenum target, GLuint framebuffer) -> void {
+    // GL_FRAMEBUFFER binds both the draw and the read framebuffer
+    const auto draw = target != GL_READ_FRAMEBUFFER;
+    const auto read = target != GL_DRAW_FRAMEBUFFER;
+    if (draw && read) {
+        recorder().state[key(Slot::Framebuffer, 0, GL_READ_FRAMEBUFFER)] = {framebuffer};
+    }
+    track(
+        Bind, "glBindFramebuffer",
+        key(Slot::Framebuffer, 0, draw ? GL_DRAW_FRAMEBUFFER : GL_READ_FRAMEBUFFER),
+        {framebuffer},
+        {target, framebuffer}
+    );
+}
+
+auto APIENTRY bind_renderbuffer(GLenum target, GLuint renderbuffer) -> void {
+    track(Bind, "glBindRenderbuffer", key(Slot::Renderbuffer, 0, target), {renderbuffer}, {target, renderbuffer});
+}
+
+auto APIENTRY bind_texture(GLenum target, GLuint texture) -> void {
+    const auto unit = recorder().active_unit;
+    track(Bind, "glBindTexture", key(Slot::Texture, unit, target), {texture}, {target, texture, unit});
+}
+
+auto APIENTRY bind_vertex_array(GLuint array) -> void {
+    recorder().vertex_array = array;
+    track(Bind, "glBindVertexArray", key(Slot::VertexArray), {array}, {array});
+}
+
+auto APIENTRY use_program(GLuint program) -> void {
+    recorder().program = program;
+    track(Bind, "glUseProgram", key(Slot::Program), {program}, {program});
+}
+
+#pragma endregion
+
+#pragma region State
+
+auto APIENTRY active_texture(GLenum texture) -> void {
+    recorder().active_unit = texture - GL_TEXTURE0;
+    track(State, "glActiveTexture", key(Slot::ActiveTexture), {texture}, {texture});
+}
+
+auto APIENTRY enable(GLenum cap) -> void {
+    track(State, "glEnable", key(Slot::Capability, 0, cap), {GL_TRUE}, {cap});
+}
+
+auto APIENTRY disable(GLenum cap) -> void {
+    track(State, "glDisable", key(Slot::Capability, 0, cap), {GL_FALSE}, {cap});
+}
+
+auto APIENTRY color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) -> void {
+    const auto args = Args {r, g, b, a};
+    track(State, "glColorMask", key(Slot::ColorMask), args, args);
+}
+
+auto APIENTRY depth_func(GLenum func) -> void {
+    track(State, "glDepthFunc", key(Slot::DepthFunc), {func}, {func});
+}
+
+auto APIENTRY depth_mask(GLboolean flag) -> void {
+    track(State, "glDepthMask", key(Slot::DepthMask), {flag}, {flag});
+}
+
+auto APIENTRY blend_equation(GLenum mode) -> void {
+    track(State, "glBlendEquation", key(Slot::BlendEquation), {mode}, {mode});
+}
+
+auto APIENTRY blend_func(GLenum sfactor, GLenum dfactor) -> void {
+    track(State, "glBlendFunc", key(Slot::BlendFunc), {sfactor, dfactor}, {sfactor, dfactor});
+}
+
+auto APIENTRY clear_color(GLfloat r, GLfloat g, GLfloat b, GLfloat a) -> void {
+    const auto args = Args {bits(r), bits(g), bits(b), bits(a)};
+    track(State, "glClearColor", key(Slot::ClearColor), args, args);
+}
+
+auto APIENTRY polygon_offset(GLfloat factor, GLfloat units) -> void {
+    const auto args = Args {bits(factor), bits(units)};
+    track(State, "glPolygonOffset", key(Slot::PolygonOffset), args, args);
+}
+
+auto APIENTRY polygon_mode(GLenum face, GLenum mode) -> void {
+    track(State, "glPolygonMode", key(Slot::PolygonMode, 0, face), {mode}, {face, mode});
+}
+
+auto APIENTRY front_face(GLenum mode) -> void {
+    track(State, "glFrontFace", key(Slot::FrontFace), {mode}, {mode});
+}
+
+auto APIENTRY cull_face(GLenum mode) -> void {
+    track(State, "glCullFace", key(Slot::CullFace), {mode}, {mode});
+}
+
+auto APIENTRY viewport(GLint x, GLint y, GLsizei width, GLsizei height) -> void {
+    const auto args = Args {x, y, width, height};
+    track(State, "glViewport", key(Slot::Viewport), args, args);
+}
+
+auto APIENTRY pixel_storei(GLenum pname, GLint param) -> void {
+    track(State, "glPixelStorei", key(Slot::PixelStore, 0, pname), {param}, {pname, param});
+}
+
+auto APIENTRY tex_parameteri(GLenum target, GLenum pname, GLint param) -> void {
+    const auto texture = tracked(key(Slot::Texture, recorder().active_unit, target));
+    track(
+        State, "glTexParameteri",
+        key(Slot::TexParameter, texture, pname),
+        {param},
+        {target, pname, param}
+    );
+}
+
+auto APIENTRY tex_parameterf(GLenum target, GLenum pname, GLfloat param) -> void {
+    const auto texture = tracked(key(Slot::Texture, recorder().active_unit, target));
+    track(
+        State, "glTexParameterf",
+        key(Slot::TexParameter, texture, pname),
+        {bits(param)},
+        {target, pname, bits(param)}
+    );
+}
+
+auto APIENTRY enable_vertex_attrib_array(GLuint index) -> void {
+    const auto array = recorder().vertex_array;
+    track(State, "glEnableVertexAttribArray", key(Slot::VertexAttribArray, array, index), {GL_TRUE}, {index});
+}
+
+auto APIENTRY disable_vertex_attrib_array(GLuint index) -> void {
+    const auto array = recorder().vertex_array;
+    track(State, "glDisableVertexAttribArray", key(Slot::VertexAttribArray, array, index), {GL_FALSE}, {index});
+}
+
+auto APIENTRY vertex_attrib_divisor(GLuint index, GLuint divisor) -> void {
+    const auto array = recorder().vertex_array;
+    track(State, "glVertexAttribDivisor", key(Slot::VertexAttribDivisor, array, index), {divisor}, {index, divisor});
+}
+
+auto APIENTRY vertex_attrib_pointer(
+    GLuint index,
+    GLint size,
+    GLenum type,
+    GLboolean normalized,
+    GLsizei stride,
+    const void* pointer
+) -> void {
+    state_change("glVertexAttribPointer", {index, size, type, stride});
+}
+
+auto APIENTRY vertex_attrib3f(GLuint index, GLfloat x, GLfloat y, GLfloat z) -> void {
+    state_change("glVertexAttrib3f", {index, bits(x), bits(y), bits(z)});
+}
+
+#pragma endregion
+
+#pragma region Uploads
+
+auto APIENTRY buffer_data(GLenum target, GLsizeiptr size, const void* data, GLenum usage) -> void {
+    auto& r = recorder();
+    const auto buffer = tracked(buffer_key(target));
+    r.buffers[buffer].resize(static_cast<std::size_t>(size));
+    if (data != nullptr) r.counters.bytes_uploaded += static_cast<std::size_t>(size);
+    record(Upload, "glBufferData", {target, buffer, size, usage});
+}
+
+auto APIENTRY buffer_sub_data(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) -> void {
+    recorder().counters.bytes_uploaded += static_cast<std::size_t>(size);
+    record(Upload, "glBufferSubData", {target, tracked(buffer_key(target)), offset, size});
+}
+
+auto APIENTRY map_buffer_range(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) -> void* {
+    // Writes go to memory owned by the recorder, and
+    // ranges mapped for writing count as uploaded on unmap.
+    auto& r = recorder();
+    const auto buffer = tracked(buffer_key(target));
+    auto& storage = r.buffers[buffer];
+    const auto end = static_cast<std::size_t>(offset + length);
+    if (storage.size() < end) storage.resize(end);
+
+    r.mappings[target] = {buffer, offset, length, access};
+    return storage.data() + offset;
+}
+
+auto APIENTRY unmap_buffer(GLenum target) -> GLboolean {
+    auto& r = recorder();
+    const auto mapping = r.mappings[target];
+    r.mappings.erase(target);
+
+    if (mapping.access & GL_MAP_WRITE_BIT) {
+        r.counters.bytes_uploaded += static_cast<std::size_t>(mapping.length);
+    }
+    record(Upload, "glUnmapBuffer", {target, mapping.buffer, mapping.offset, mapping.length});
+    return GL_TRUE;
+}
+
+auto pixel_size(GLenum format, GLenum type) -> std::size_t {
+    const auto components = [format]() {
+        switch (format) {
+            case GL_RED: case GL_DEPTH_COMPONENT: return 1;
+            case GL_RG: return 2;
+            case GL_RGB: return 3;
+            default: return 4;
+        }
+    }();
+    const auto component_size = [type]() {
+        switch (type) {
+            case GL_UNSIGNED_BYTE: case GL_BYTE: return 1;
+            case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return 2;
+            default: return 4;
+        }
+    }();
+    return static_cast<std::size_t>(components * component_size);
+}
+
+auto APIENTRY tex_image_2d(
+    GLenum target,
+    GLint level,
+    GLint internal_format,
+    GLsizei width,
+    GLsizei height,
+    GLint border,
+    GLenum format,
+    GLenum type,
+    const void* pixels
+) -> void {
+    if (pixels != nullptr) {
+        recorder().counters.bytes_uploaded +=
+            static_cast<std::size_t>(width) * height * pixel_size(format, type);
+    }
+    record(Upload, "glTexImage2D", {target, level, width, height});
+}
+
+auto APIENTRY tex_image_3d(
+    GLenum target,
+    GLint level,
+    GLint internal_format,
+    GLsizei width,
+    GLsizei height,
+    GLsizei depth,
+    GLint border,
+    GLenum format,
+    GLenum type,
+    const void* pixels
+) -> void {
+    if (pixels != nullptr) {
+        recorder().counters.bytes_uploaded +=
+            static_cast<std::size_t>(width) * height * depth * pixel_size(format, type);
+    }
+    record(Upload, "glTexImage3D", {target, width, height, depth});
+}
+
+#pragma endregion
+
+#pragma region Uniforms
+
+auto set_uniform(const char* function, GLint location, const void* data, std::size_t size) {
+    auto& r = recorder();
+    ++r.counters.uniforms;
+
+    const auto slot = static_cast<uint64_t>(r.program) << 32 | static_cast<uint32_t>(location);
+    const auto bytes = static_cast<const std::byte*>(data);
+    auto& value = r.uniform_values[slot];
+    if (std::ranges::equal(value, std::span {bytes, size})) {
+        ++r.counters.redundant_uniforms;
+    } else {
+        value.assign(bytes, bytes + size);
+    }
+
+    record(Uniform, function, {location, r.program});
+}
+
+auto APIENTRY uniform1f(GLint location, GLfloat v0) -> void {
+    set_uniform("glUniform1f", location, &v0, sizeof(v0));
+}
+
+auto APIENTRY uniform1i(GLint location, GLint v0) -> void {
+    set_uniform("glUniform1i", location, &v0, sizeof(v0));
+}
+
+auto APIENTRY uniform2fv(GLint location, GLsizei count, const GLfloat* value) -> void {
+    set_uniform("glUniform2fv", location, value, sizeof(GLfloat) * 2 * count);
+}
+
+auto APIENTRY uniform3fv(GLint location, GLsizei count, const GLfloat* value) -> void {
+    set_uniform("glUniform3fv", location, value, sizeof(GLfloat) * 3 * count);
+}
+
+auto APIENTRY uniform4fv(GLint location, GLsizei count, const GLfloat* value) -> void {
+    set_uniform("glUniform4fv", location, value, sizeof(GLfloat) * 4 * count);
+}
+
+auto APIENTRY uniform_matrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) -> void {
+    set_uniform("glUniformMatrix3fv", location, value, sizeof(GLfloat) * 9 * count);
+}
+
+auto APIENTRY uniform_matrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) -> void {
+    set_uniform("glUniformMatrix4fv", location, value, sizeof(GLfloat) * 16 * count);
+}
+
+#pragma endregion
+
+#pragma region Draws
+
+auto draw(const char* function, const Args& args, GLsizei instances) {
+    auto& counters = recorder().counters;
+    ++counters.draws;
+    counters.instances += static_cast<std::size_t>(instances);
+    record(Draw, function, args);
+}
+
+auto APIENTRY clear(GLbitfield mask) -> void {
+    record(Clear, "glClear", {mask});
+}
+
+auto APIENTRY blit_framebuffer(
+    GLint src_x0, GLint src_y0, GLint src_x1, GLint src_y1,
+    GLint dst_x0, GLint dst_y0, GLint dst_x1, GLint dst_y1,
+    GLbitfield mask,
+    GLenum filter
+) -> void {
+    record(Copy, "glBlitFramebuffer", {dst_x1 - dst_x0, dst_y1 - dst_y0, mask, filter});
+}
+
+auto APIENTRY read_pixels(
+    GLint x,
+    GLint y,
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLenum type,
+    void* pixels
+) -> void {
+    // The renderer only reads RGBA8 pixels into pack buffers
+    recorder().counters.bytes_read += static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4;
+    record(Copy, "glReadPixels", {width, height, format, type});
+}
+
+auto APIENTRY draw_arrays(GLenum mode, GLint first, GLsizei count) -> void {
+    draw("glDrawArrays", {mode, first, count, 1}, 1);
+}
+
+auto APIENTRY draw_arrays_instanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) -> void {
+    draw("glDrawArraysInstanced", {mode, first, count, instances}, instances);
+}
+
+auto APIENTRY draw_elements(GLenum mode, GLsizei count, GLenum type, const void* indices) -> void {
+    draw("glDrawElements", {mode, count, type, 1}, 1);
+}
+
+auto APIENTRY draw_elements_instanced(
+    GLenum mode,
+    GLsizei count,
+    GLenum type,
+    const void* indices,
+    GLsizei instances
+) -> void {
+    draw("glDrawElementsInstanced", {mode, count, type, instances}, instances);
+}
+
+#pragma endregion
+
+#pragma region Occlusion
+
+auto APIENTRY begin_query(GLenum target, GLuint id) -> void {
+    record(Query, "glBeginQuery", {target, id});
+}
+
+auto APIENTRY end_query(GLenum target) -> void {
+    record(Query, "glEndQuery", {target});
+}
+
+auto APIENTRY begin_conditional_render(GLuint id, GLenum mode) -> void {
+    record(Query, "glBeginConditionalRender", {id, mode});
+}
+
+auto APIENTRY end_conditional_render() -> void {
+    record(Query, "glEndConditionalRender");
+}
+
+#pragma endregion
+
+template <typename F>
+auto entry(F* function) {
+    return reinterpret_cast<void*>(function);
+}
+
+// Entry points the renderer uses. Any other function is left unloaded.
+auto load(const char* name) -> void* {
+    static const auto functions = std::unordered_map<std::string_view, void*> {
+        {"glActiveTexture", entry(active_texture)},
+        {"glAttachShader", entry(attach_shader)},
+        {"glBeginConditionalRender", entry(begin_conditional_render)},
+        {"glBeginQuery", entry(begin_query)},
+        {"glBindAttribLocation", entry(bind_attrib_location)},
+        {"glBindBuffer", entry(bind_buffer)},
+        {"glBindBufferBase", entry(bind_buffer_base)},
+        {"glBindBufferRange", entry(bind_buffer_range)},
+        {"glBindFramebuffer", entry(bind_framebuffer)},
+        {"glBindRenderbuffer", entry(bind_renderbuffer)},
+        {"glBindTexture", entry(bind_texture)},
+        {"glBindVertexArray", entry(bind_vertex_array)},
+        {"glBlendEquation", entry(blend_equation)},
+        {"glBlendFunc", entry(blend_func)},
+        {"glBlitFramebuffer", entry(blit_framebuffer)},
+        {"glBufferData", entry(buffer_data)},
+        {"glBufferSubData", entry(buffer_sub_data)},
+        {"glCheckFramebufferStatus", entry(check_framebuffer_status)},
+        {"glClear", entry(clear)},
+        {"glClearColor", entry(clear_color)},
+        {"glClientWaitSync", entry(client_wait_sync)},
+        {"glColorMask", entry(color_mask)},
+        {"glCompileShader", entry(compile_shader)},
+        {"glCreateProgram", entry(create_program)},
+        {"glCreateShader", entry(create_shader)},
+        {"glCullFace", entry(cull_face)},
+        {"glDeleteBuffers", entry(delete_buffers)},
+        {"glDeleteFramebuffers", entry(delete_framebuffers)},
+        {"glDeleteProgram", entry(delete_program)},
+        {"glDeleteQueries", entry(delete_queries)},
+        {"glDeleteRenderbuffers", entry(delete_renderbuffers)},
+        {"glDeleteShader", entry(delete_shader)},
+        {"glDeleteSync", entry(delete_sync)},
+        {"glDeleteTextures", entry(delete_textures)},
+        {"glDepthFunc", entry(depth_func)},
+        {"glDepthMask", entry(depth_mask)},
+        {"glDetachShader", entry(detach_shader)},
+        {"glDisable", entry(disable)},
+        {"glDisableVertexAttribArray", entry(disable_vertex_attrib_array)},
+        {"glDrawArrays", entry(draw_arrays)},
+        {"glDrawArraysInstanced", entry(draw_arrays_instanced)},
+        {"glDrawElements", entry(draw_elements)},
+        {"glDrawElementsInstanced", entry(draw_elements_instanced)},
+        {"glEnable", entry(enable)},
+        {"glEnableVertexAttribArray", entry(enable_vertex_attrib_array)},
+        {"glEndConditionalRender", entry(end_conditional_render)},
+        {"glEndQuery", entry(end_query)},
+        {"glFenceSync", entry(fence_sync)},
+        {"glFramebufferRenderbuffer", entry(framebuffer_renderbuffer)},
+        {"glFrontFace", entry(front_face)},
+        {"glGenBuffers", entry(gen_buffers)},
+        {"glGenFramebuffers", entry(gen_framebuffers)},
+        {"glGenQueries", entry(gen_queries)},
+        {"glGenRenderbuffers", entry(gen_renderbuffers)},
+        {"glGenTextures", entry(gen_textures)},
+        {"glGenVertexArrays", entry(gen_vertex_arrays)},
+        {"glGetActiveUniform", entry(get_active_uniform)},
+        {"glGetActiveUniformBlockName", entry(get_active_uniform_block_name)},
+        {"glGetActiveUniformsiv", entry(get_active_uniformsiv)},
+        {"glGetError", entry(get_error)},
+        {"glGetFloatv", entry(get_floatv)},
+        {"glGetIntegerv", entry(get_integerv)},
+        {"glGetProgramBinary", entry(get_program_binary)},
+        {"glGetProgramInfoLog", entry(get_program_info_log)},
+        {"glGetProgramiv", entry(get_programiv)},
+        {"glGetQueryObjectuiv", entry(get_query_objectuiv)},
+        {"glGetShaderInfoLog", entry(get_shader_info_log)},
+        {"glGetShaderiv", entry(get_shaderiv)},
+        {"glGetString", entry(get_string)},
+        {"glGetStringi", entry(get_stringi)},
+        {"glGetUniformLocation", entry(get_uniform_location)},
+        {"glLinkProgram", entry(link_program)},
+        {"glMapBufferRange", entry(map_buffer_range)},
+        {"glPixelStorei", entry(pixel_storei)},
+        {"glPolygonMode", entry(polygon_mode)},
+        {"glPolygonOffset", entry(polygon_offset)},
+        {"glProgramBinary", entry(program_binary)},
+        {"glProgramParameteri", entry(program_parameteri)},
+        {"glReadPixels", entry(read_pixels)},
+        {"glRenderbufferStorage", entry(renderbuffer_storage)},
+        {"glRenderbufferStorageMultisample", entry(renderbuffer_storage_multisample)},
+        {"glShaderSource", entry(shader_source)},
+        {"glTexBuffer", entry(tex_buffer)},
+        {"glTexImage2D", entry(tex_image_2d)},
+        {"glTexImage3D", entry(tex_image_3d)},
+        {"glTexParameterf", entry(tex_parameterf)},
+        {"glTexParameteri", entry(tex_parameteri)},
+        {"glUniform1f", entry(uniform1f)},
+        {"glUniform1i", entry(uniform1i)},
+        {"glUniform2fv", entry(uniform2fv)},
+        {"glUniform3fv", entry(uniform3fv)},
+        {"glUniform4fv", entry(uniform4fv)},
+        {"glUniformBlockBinding", entry(uniform_block_binding)},
+        {"glUniformMatrix3fv", entry(uniform_matrix3fv)},
+        {"glUniformMatrix4fv", entry(uniform_matrix4fv)},
+        {"glUnmapBuffer", entry(unmap_buffer)},
+        {"glUseProgram", entry(use_program)},
+        {"glVertexAttrib3f", entry(vertex_attrib3f)},
+        {"glVertexAttribDivisor", entry(vertex_attrib_divisor)},
+        {"glVertexAttribPointer", entry(vertex_attrib_pointer)},
+        {"glViewport", entry(viewport)}
+    };
+
+    const auto it = functions.find(name);
+    return it != functions.end() ? it->second : nullptr;
+}
+
+}
+
+auto GLRecorder::Install() -> bool {
+    return gladLoadGLLoader(load) != 0;
+}
+
+auto GLRecorder::GetCommands() -> std::span<const Command> {
+    return recorder().commands;
+}
+
+auto GLRecorder::GetCounters() -> const Counters& {
+    return recorder().counters;
+}
+
+auto GLRecorder::Reset() -> void {
+    auto& r = recorder();
+    r.commands.clear();
+    r.counters = {};
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace gleam {
+
+// Recording backend for the GL renderer. Install() points the GL entry points
+// at functions that log every call into memory instead of executing it, so
+// the renderer runs without a context, e.g. on CI machines without GPUs.
+// Queries return values that let the renderer proceed: shaders compile,
+// programs report the uniforms and uniform blocks declared in their source,
+// program binaries hold the sources, so they can be loaded back, and
+// asynchronous links complete on the second completion status query.
+//
+// The recorder tracks the bindings and fixed-function state it has seen, so
+// calls that don't change anything are counted as redundant.
+class GLRecorder {
+public:
+    enum class CommandType {
+        Bind,
+        Clear,
+        Copy,
+        Draw,
+        Query,
+        Resource,
+        State,
+        Uniform,
+        Upload
+    };
+
+    // Integer arguments are stored as is and float arguments as their bit
+    // patterns. Pointer arguments, such as the data of an upload, are dropped.
+    // Binds and state changes that set the value already set are redundant.
+    struct Command {
+        CommandType type;
+        const char* function {nullptr};
+        std::array<int64_t, 4> args {};
+        bool redundant {false};
+    };
+
+    struct Counters {
+        std::size_t commands {0};
+        std::size_t draws {0};
+        std::size_t instances {0};
+        std::size_t binds {0};
+        std::size_t redundant_binds {0};
+        std::size_t state_changes {0};
+        std::size_t redundant_state_changes {0};
+        std::size_t uniforms {0};
+        std::size_t redundant_uniforms {0};
+        std::size_t bytes_uploaded {0};
+        std::size_t bytes_read {0};
+        std::size_t queries {0};
+    };
+
+    // Replaces the GL entry points for the rest of the process,
+    // so it can't be combined with a real context.
+    static auto Install() -> bool;
+
+    [[nodiscard]] static auto GetCommands() -> std::span<const Command>;
+
+    [[nodiscard]] static auto GetCounters() -> const Counters&;
+
+    // Clears the command log and counters. Tracked objects and state are
+    // kept, so redundant calls are still detected across a reset.
+    static auto Reset() -> void;
+};
+
+}
\ No newline at end of file
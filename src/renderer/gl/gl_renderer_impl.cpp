@@ -12,66 +12,171 @@
 #include "gleam/materials/sprite_material.hpp"
 #include "gleam/materials/unlit_material.hpp"
 #include "gleam/math/vector3.hpp"
-#include "gleam/nodes/fog.hpp"
-#include "gleam/nodes/instanced_mesh.hpp"
-#include "gleam/nodes/sprite.hpp"
+#include "gleam/nodes/mesh.hpp"
 
 #include "core/program_attributes.hpp"
-#include "core/render_lists.hpp"
+#include "nodes/renderable_impl.hpp"
 #include "utilities/logger.hpp"
 
+#include <utility>
+
 #include <glad/glad.h>
 
 namespace gleam {
 
-Renderer::Impl::Impl(const Renderer::Parameters& params)
-  : params_(params),
-    render_lists_(std::make_unique<RenderLists>()) {
+namespace {
+
+auto collect_nodes(Node* node, std::vector<Renderable*>& renderables, GLLights::State& lights) -> void {
+    if (node->IsRenderable() && Renderable::CanRender(static_cast<Renderable*>(node))) {
+        renderables.emplace_back(static_cast<Renderable*>(node));
+    }
+    if (node->GetNodeType() == NodeType::LightNode) {
+        lights.AddLight(static_cast<Light*>(node), Matrix4::Identity());
+    }
+    for (const auto& child : node->Children()) {
+        collect_nodes(child.get(), renderables, lights);
+    }
+}
+
+}
+
+Renderer::GLImpl::GLImpl(const Renderer::Parameters& params)
+  : Renderer::Impl(params),
+    programs_({
+        .cache_directory = params.shader_cache,
+        .parallel = params.async_shaders
+    }),
+    textures_({.anisotropy = params.anisotropy}) {
+    if (params.offscreen) {
+        framebuffer_ = std::make_unique<GLFramebuffer>(GLFramebuffer::Parameters {
+            .width = params.width,
+            .height = params.height,
+            .samples = params.samples
+        });
+    }
+    if (params.occlusion_queries) {
+        occlusion_ = std::make_unique<GLOcclusionQueries>();
+    }
+    if (params.depth_prepass) {
+        prepass_ = std::make_unique<GLDepthPrepass>();
+    }
     state_.SetViewport(0, 0, params.width, params.height);
 }
 
-auto Renderer::Impl::RenderObjects(Scene* scene, Camera* camera) -> void {
-    camera_ubo_.Update(camera->projection_transform, camera->view_transform);
+auto Renderer::GLImpl::RenderObjects(const Frame& frame) -> void {
+    const auto& render_lists = frame.render_lists;
+
+    programs_.Poll();
+    camera_ubo_.Update(frame.projection, frame.view);
+    fog_.Update(frame.scene->fog.get());
+    materials_.BeginFrame();
+    if (occlusion_) occlusion_->BeginFrame();
+
+    buffers_.UploadInstances(
+        render_lists.InstanceTransforms(),
+        render_lists.InstanceNormals(),
+        render_lists.InstanceLayers()
+    );
+    WriteObjects(frame);
+
+    // Objects are written in submission order, so the
+    // object index of each draw is its position in the frame.
+    auto object_index = 0;
+    if (prepass_) {
+        prepass_->BeginDepthPass(state_);
+        prepassed_.assign(render_lists.OpaqueBatches().size(), false);
+        for (const auto& batch : render_lists.OpaqueBatches()) {
+            if (GLDepthPrepass::IsCandidate(batch.renderable)) {
+                prepassed_[object_index] = RenderDepth(batch, object_index, frame);
+            }
+            ++object_index;
+        }
+        prepass_->BeginColorPass(state_);
+        object_index = 0;
+    }
+
+    for (const auto& batch : render_lists.OpaqueBatches()) {
+        if (prepass_) {
+            prepass_->SetDepthState(state_, prepassed_[object_index]);
+        }
+        RenderObject(batch, object_index++, frame);
+    }
+
+    if (prepass_) {
+        prepass_->EndColorPass(state_);
+        depth_prepass_stats_per_frame_ = prepass_->Stats();
+    }
 
-    for (auto renderable : render_lists_->Opaque()) {
-        RenderObject(renderable, scene, camera);
+    if (occlusion_) {
+        occlusion_->Query(state_, buffers_, frame.projection * frame.view);
     }
 
-    if (!render_lists_->Transparent().empty()) state_.SetDepthMask(false);
-    for (auto renderable : render_lists_->Transparent()) {
-        RenderObject(renderable, scene, camera);
+    if (!render_lists.Transparent().empty()) state_.SetDepthMask(false);
+    for (auto renderable : render_lists.Transparent()) {
+        RenderObject({renderable}, object_index++, frame);
     }
 
     state_.SetDepthMask(true);
+    objects_.EndFrame();
 
     rendered_objects_per_frame_ = rendered_objects_counter_;
     rendered_objects_counter_ = 0;
+
+    const auto& counters = state_.GetCounters();
+    state_cache_stats_per_frame_ = {.calls = counters.calls, .skipped = counters.skipped};
+    state_.ResetCounters();
 }
 
-auto Renderer::Impl::RenderObject(Renderable* renderable, Scene* scene, Camera* camera) -> void {
-    auto geometry = renderable->GetGeometry().get();
-    auto material = renderable->GetMaterial().get();
-    auto attrs = ProgramAttributes {renderable, {
-        .directional = lights_.directional,
-        .point = lights_.point,
-        .spot = lights_.spot
-    }, scene};
-
-    auto program = programs_.GetProgram(attrs);
-    if (!program->IsValid()) {
+auto Renderer::GLImpl::WriteObjects(const Frame& frame) -> void {
+    const auto transforms = frame.render_lists.Transforms();
+    objects_.BeginFrame(state_, transforms.size());
+
+    for (const auto& transform : transforms) {
+        objects_.Push(transform);
+    }
+
+    objects_.Upload(state_, std::to_underlying(GLTextureMapType::ObjectData));
+}
+
+auto Renderer::GLImpl::RenderObject(
+    const RenderLists::RenderBatch& batch,
+    int object_index,
+    const Frame& frame
+) -> void {
+    // Draws past the capacity of the object data buffer have no transform
+    if (!objects_.Contains(object_index)) return;
+
+    auto renderable = batch.renderable;
+    auto program = GetProgram(renderable, object_index, frame, batch.instance_count > 0);
+    if (!program || !program->IsValid()) {
+        return;
+    }
+
+    // Meshes hidden in the previous frame are skipped before any state is set
+    const auto queried = IsQueried(batch);
+    if (queried && !occlusion_->BeginDraw(
+        renderable,
+        frame.render_lists.Transforms()[object_index],
+        frame.render_lists.LocalBoxes()[object_index]
+    )) {
         return;
     }
 
+    auto attrs = &renderable->impl_->draw.attrs.value();
+    auto geometry = renderable->GetGeometry().get();
+    auto material = renderable->GetMaterial().get();
+
     state_.ProcessMaterial(material);
+    materials_.Bind(state_, renderable->GetMaterial());
     if (material->wireframe && Renderable::IsMeshType(renderable)) {
         const auto mesh = static_cast<Mesh*>(renderable);
-        buffers_.Bind(mesh->GetWireframeGeometry());
+        buffers_.Bind(state_, mesh->GetWireframeGeometry());
         geometry = mesh->GetWireframeGeometry().get();
     } else {
-        buffers_.Bind(renderable->GetGeometry());
+        buffers_.Bind(state_, renderable->GetGeometry());
     }
 
-    SetUniforms(program, &attrs, renderable, camera, scene);
+    SetUniforms(program, attrs, batch, object_index, frame);
 
     state_.UseProgram(program->Id());
     program->UpdateUniforms();
@@ -84,86 +189,216 @@ auto Renderer::Impl::RenderObject(Renderable* renderable, Scene* scene, Camera*
         primitive = GL_LINE_LOOP;
     }
 
+    DrawGeometry(batch, object_index, frame, geometry, primitive);
+
+    if (queried) occlusion_->EndDraw();
+
+    rendered_objects_counter_ += batch.instance_count > 0 ? batch.instance_count : 1;
+}
+
+auto Renderer::GLImpl::RenderDepth(
+    const RenderLists::RenderBatch& batch,
+    int object_index,
+    const Frame& frame
+) -> bool {
+    if (!objects_.Contains(object_index)) return false;
+
+    auto renderable = batch.renderable;
+    auto program = GetProgram(renderable, object_index, frame, batch.instance_count > 0);
+    if (!program || !program->IsValid()) {
+        return false;
+    }
+
+    // Draws whose depth program is still compiling are
+    // shaded with a regular depth test in the color pass.
+    auto depth_program = programs_.GetProgram(renderable->impl_->draw.attrs->DepthOnly());
+    if (!depth_program || !depth_program->IsValid()) {
+        return false;
+    }
+
+    // The occlusion result is resolved here and reused by the color pass
+    const auto queried = IsQueried(batch);
+    if (queried && !occlusion_->BeginDraw(
+        renderable,
+        frame.render_lists.Transforms()[object_index],
+        frame.render_lists.LocalBoxes()[object_index]
+    )) {
+        return false;
+    }
+
+    auto object_data = GLTextureMapType::ObjectData;
+
+    state_.ProcessMaterial(renderable->GetMaterial().get());
+    buffers_.Bind(state_, renderable->GetGeometry());
+
+    depth_program->SetUniform(Uniform::ObjectData, &object_data);
+    depth_program->SetUniform(Uniform::ObjectIndex, &object_index);
+
+    state_.UseProgram(depth_program->Id());
+    depth_program->UpdateUniforms();
+
+    DrawGeometry(batch, object_index, frame, renderable->GetGeometry().get(), GL_TRIANGLES);
+
+    if (queried) occlusion_->EndDraw();
+    return true;
+}
+
+auto Renderer::GLImpl::DrawGeometry(
+    const RenderLists::RenderBatch& batch,
+    int object_index,
+    const Frame& frame,
+    const Geometry* geometry,
+    unsigned int primitive
+) -> void {
     const auto index_size = geometry->IndexData().size();
     const auto vertex_size = geometry->VertexCount();
 
-    if (renderable->GetNodeType() != NodeType::InstancedMeshNode) {
+    if (batch.instance_count > 0) {
+        buffers_.BindInstances(state_, batch.first_instance);
+
         index_size
-            ? glDrawElements(primitive, index_size, GL_UNSIGNED_INT, nullptr)
-            : glDrawArrays(primitive, 0, vertex_size);
+            ? glDrawElementsInstanced(primitive, index_size, GL_UNSIGNED_INT, nullptr, batch.instance_count)
+            : glDrawArraysInstanced(primitive, 0, vertex_size, batch.instance_count);
+        return;
     }
 
-    if (renderable->GetNodeType() == NodeType::InstancedMeshNode) {
-        const auto instanced = static_cast<InstancedMesh*>(renderable);
-        const auto count = instanced->Count();
-        buffers_.BindInstancedMesh(instanced);
+    // Instanced meshes are drawn from the frame's copy of their instance
+    // data, since the next frame may already be changing them.
+    const auto& state = frame.render_lists.DrawStates()[object_index];
+    if (state.instance_data >= 0) {
+        const auto& instances = frame.render_lists.Instances()[state.instance_data];
+        const auto count = instances.transforms.size();
+        buffers_.BindInstancedMesh(instances);
 
         index_size
             ? glDrawElementsInstanced(primitive, index_size, GL_UNSIGNED_INT, nullptr, count)
             : glDrawArraysInstanced(primitive, 0, vertex_size, count);
+        return;
     }
 
-    rendered_objects_counter_++;
+    index_size
+        ? glDrawElements(primitive, index_size, GL_UNSIGNED_INT, nullptr)
+        : glDrawArrays(primitive, 0, vertex_size);
 }
 
-auto Renderer::Impl::SetUniforms(
+auto Renderer::GLImpl::IsQueried(const RenderLists::RenderBatch& batch) const -> bool {
+    return occlusion_ &&
+        batch.instance_count == 0 &&
+        GLOcclusionQueries::IsCandidate(batch.renderable);
+}
+
+auto Renderer::GLImpl::GetProgram(
+    Renderable* renderable,
+    int object_index,
+    const Frame& frame,
+    bool batched
+) -> GLProgram* {
+    auto& cache = renderable->impl_->draw;
+    const auto scene = frame.scene;
+    const auto geometry = renderable->GetGeometry();
+    const auto material = renderable->GetMaterial();
+
+    // Light counts are rounded up, so lights moving around the
+    // scene rarely change the program a renderable is drawn with.
+    const auto& assignment = frame.object_lights.Assignments()[object_index];
+    const auto lights = ProgramAttributes::LightsCounter {
+        .directional = ProgramAttributes::LightBucket(frame.lights.directional, GLLights::kMaxLights),
+        .local = ProgramAttributes::LightBucket(assignment.count, ObjectLights::kMaxLightsPerObject),
+        .clustered = assignment.clustered
+    };
+
+    const auto environment = static_cast<uint32_t>(
+        lights.directional |
+        lights.local << 8 |
+        lights.clustered << 16 |
+        (scene->fog != nullptr) << 24 |
+        batched << 25
+    );
+
+    if (cache.IsCurrent(geometry, material, environment)) {
+        return cache.program;
+    }
+
+    cache.attrs.emplace(renderable, lights, scene, batched);
+    cache.program = programs_.GetProgram(cache.attrs.value());
+    cache.Track(geometry, material, environment);
+
+    return cache.program;
+}
+
+auto Renderer::GLImpl::SetUniforms(
     GLProgram* program,
     ProgramAttributes* attrs,
-    Renderable* renderable,
-    Camera* camera,
-    Scene* scene
+    const RenderLists::RenderBatch& batch,
+    int object_index,
+    const Frame& frame
 ) -> void {
+    auto renderable = batch.renderable;
     auto material = renderable->GetMaterial().get();
-    auto model = renderable->GetWorldTransform();
+    auto object_data = GLTextureMapType::ObjectData;
     auto resolution = Vector2(params_.width, params_.height);
 
-    program->SetUniform(Uniform::Model, &model);
-    program->SetUniform(Uniform::Opacity, &material->opacity);
+    // Model and normal matrices are read from the frame's object data
+    // buffer (see GLObjects), so each draw only passes its index.
+    program->SetUniform(Uniform::ObjectData, &object_data);
+    program->SetUniform(Uniform::ObjectIndex, &object_index);
     program->SetUniform(Uniform::Resolution, &resolution);
 
-    if (auto fog = scene->fog.get()) {
-        auto type = fog->GetType();
-        program->SetUniform(Uniform::FogType, &type);
-        if (type == FogType::LinearFog) {
-            auto f = static_cast<LinearFog*>(fog);
-            program->SetUniform(Uniform::FogColor, &f->color);
-            program->SetUniform(Uniform::FogNear, &f->near);
-            program->SetUniform(Uniform::FogFar, &f->far);
+    // Material values such as colors, opacity and the texture transform are
+    // stored in the material's uniform block (see GLMaterials), and fog in a
+    // per-scene block. Only per-object values and samplers are set here.
+
+    if (attrs->type == MaterialType::PhongMaterial) {
+        auto m = static_cast<PhongMaterial*>(material);
+        if (frame.lights.HasLights()) {
+            program->SetUniform(Uniform::AmbientLight, &frame.lights.ambient_light);
         }
 
-        if (type == FogType::ExponentialFog) {
-            auto f = static_cast<ExponentialFog*>(fog);
-            program->SetUniform(Uniform::FogColor, &f->color);
-            program->SetUniform(Uniform::FogDensity, &f->density);
+        if (attrs->num_object_lights > 0 || attrs->clustered_lights) {
+            auto light_data = GLTextureMapType::LightData;
+            auto light_indices = GLTextureMapType::LightIndices;
+            program->SetUniform(Uniform::LightData, &light_data);
+            program->SetUniform(Uniform::LightIndices, &light_indices);
         }
-    }
 
-    if (attrs->type == MaterialType::PhongMaterial) {
-        auto m = static_cast<PhongMaterial*>(material);
-        if (lights_.HasLights()) {
-            program->SetUniform(Uniform::AmbientLight, &lights_.ambient_light);
-            program->SetUniform(Uniform::MaterialDiffuseColor, &m->color);
-            program->SetUniform(Uniform::MaterialSpecularColor, &m->specular);
-            program->SetUniform(Uniform::MaterialShininess, &m->shininess);
+        if (attrs->num_object_lights > 0) {
+            const auto& assignment = frame.object_lights.Assignments()[object_index];
+            auto offset = lights_.ObjectIndicesOffset() + static_cast<int>(assignment.offset);
+            auto count = static_cast<int>(assignment.count);
+            program->SetUniform(Uniform::ObjectLightOffset, &offset);
+            program->SetUniform(Uniform::ObjectLightCount, &count);
+        }
+
+        if (attrs->clustered_lights) {
+            auto light_clusters = GLTextureMapType::LightClusters;
+            program->SetUniform(Uniform::LightClusters, &light_clusters);
         }
 
         if (attrs->albedo_map) {
             auto map_type = GLTextureMapType::AlbedoMap;
-            textures_.Bind(m->albedo_map, map_type);
-            const auto& transform = m->albedo_map->GetTransform();
+            textures_.Bind(state_, m->albedo_map, map_type);
             program->SetUniform(Uniform::AlbedoMap, &map_type);
-            program->SetUniform(Uniform::TextureTransform, &transform);
         }
 
         if (attrs->alpha_map) {
             auto map_type = GLTextureMapType::AlphaMap;
-            textures_.Bind(m->alpha_map, map_type);
+            textures_.Bind(state_, m->alpha_map, map_type);
             program->SetUniform(Uniform::AlphaMap, &map_type);
         }
     }
 
     if (attrs->type == MaterialType::ShaderMaterial) {
         auto m = static_cast<ShaderMaterial*>(material);
+
+        // Custom shaders that declare these as plain uniforms, rather than
+        // reading them through the snippets, still receive their values.
+        if (program->HasUnknownUniform("u_Model")) {
+            program->SetUnknownUniform("u_Model", &frame.render_lists.Transforms()[object_index]);
+        }
+        if (program->HasUnknownUniform("u_Opacity")) {
+            program->SetUnknownUniform("u_Opacity", &material->opacity);
+        }
+
         for (const auto& [name, value] : m->uniforms) {
             program->SetUnknownUniform(name, &value);
         }
@@ -171,73 +406,126 @@ auto Renderer::Impl::SetUniforms(
 
     if (attrs->type == MaterialType::SpriteMaterial) {
         auto m = static_cast<SpriteMaterial*>(material);
-        auto r = static_cast<Sprite*>(renderable);
+        const auto& state = frame.render_lists.DrawStates()[object_index];
 
-        program->SetUniform(Uniform::Anchor, &r->anchor);
-        program->SetUniform(Uniform::Color, &m->color);
-        program->SetUniform(Uniform::Rotation, &r->rotation);
+        program->SetUniform(Uniform::Anchor, &state.anchor);
+        program->SetUniform(Uniform::Rotation, &state.rotation);
 
         if (attrs->albedo_map) {
             auto map_type = GLTextureMapType::AlbedoMap;
-            textures_.Bind(m->albedo_map, map_type);
-            const auto& transform = m->albedo_map->GetTransform();
+            textures_.Bind(state_, m->albedo_map, map_type);
             program->SetUniform(Uniform::AlbedoMap, &map_type);
-            program->SetUniform(Uniform::TextureTransform, &transform);
         }
 
         if (attrs->alpha_map) {
             auto map_type = GLTextureMapType::AlphaMap;
-            textures_.Bind(m->alpha_map, map_type);
+            textures_.Bind(state_, m->alpha_map, map_type);
             program->SetUniform(Uniform::AlphaMap, &map_type);
         }
     }
 
     if (attrs->type == MaterialType::UnlitMaterial) {
         auto m = static_cast<UnlitMaterial*>(material);
-        program->SetUniform(Uniform::Color, &m->color);
 
         if (attrs->albedo_map) {
             auto map_type = GLTextureMapType::AlbedoMap;
-            textures_.Bind(m->albedo_map, map_type);
-            const auto& transform = m->albedo_map->GetTransform();
+            textures_.Bind(state_, m->albedo_map, map_type);
             program->SetUniform(Uniform::AlbedoMap, &map_type);
-            program->SetUniform(Uniform::TextureTransform, &transform);
         }
 
         if (attrs->alpha_map) {
             auto map_type = GLTextureMapType::AlphaMap;
-            textures_.Bind(m->alpha_map, map_type);
+            textures_.Bind(state_, m->alpha_map, map_type);
             program->SetUniform(Uniform::AlphaMap, &map_type);
         }
     }
 }
 
-auto Renderer::Impl::ProcessLights(Camera* camera) -> void {
-    lights_.Reset();
+auto Renderer::GLImpl::Submit() -> void {
+    if (framebuffer_) framebuffer_->Bind();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    const auto& frame = FrontFrame();
+    if (frame.scene != nullptr) {
+        if (frame.lights.HasLights()) {
+            lights_.Update(state_, frame.lights, frame.clusters, frame.object_lights, params_.width, params_.height);
+        }
+        RenderObjects(frame);
+    }
+
+    if (framebuffer_) framebuffer_->Resolve();
 
-    for(auto light : render_lists_->Lights()) {
-        lights_.AddLight(light, camera);
+    if (capture_) {
+        // Polling first frees the buffers of finished frames for this one
+        capture_->Poll(on_frame_captured_, submitted_frames_, false);
+        capture_->Read(framebuffer_ ? framebuffer_->ResolvedId() : 0, submitted_frames_);
     }
 
-    if (lights_.HasLights()) lights_.Update();
+    ++submitted_frames_;
 }
 
-auto Renderer::Impl::Render(Scene* scene, Camera* camera) -> void {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+auto Renderer::GLImpl::SetClearColor(const Color& color) -> void {
+    state_.SetClearColor(color);
+}
+
+auto Renderer::GLImpl::StartCapture(const OnFrameCaptured& callback) -> void {
+    StopCapture();
+    on_frame_captured_ = callback;
+    capture_ = std::make_unique<GLFrameCapture>(params_.width, params_.height);
+}
 
-    scene->UpdateTransformHierarchy();
-    camera->SetViewTransform();
+auto Renderer::GLImpl::StopCapture() -> void {
+    if (!capture_) return;
 
-    render_lists_->ProcessScene(scene, camera);
-    ProcessLights(camera);
+    capture_->Poll(on_frame_captured_, submitted_frames_, true);
+    capture_stats_ = capture_->Stats();
+    capture_.reset();
+    on_frame_captured_ = nullptr;
+}
 
-    RenderObjects(scene, camera);
+auto Renderer::GLImpl::CaptureStats() const -> FrameCaptureStats {
+    return capture_ ? capture_->Stats() : capture_stats_;
 }
 
-auto Renderer::Impl::SetClearColor(const Color& color) -> void {
-    state_.SetClearColor(color);
+auto Renderer::GLImpl::Precompile(Scene* scene) -> void {
+    auto lights = GLLights::State {};
+    auto renderables = std::vector<Renderable*> {};
+    for (const auto& child : scene->Children()) {
+        collect_nodes(child.get(), renderables, lights);
+    }
+
+    // Which lights reach a renderable depends on where things are when it's
+    // drawn, so every light count it may be assigned is compiled.
+    using LightsCounter = ProgramAttributes::LightsCounter;
+    const auto directional = ProgramAttributes::LightBucket(lights.directional, GLLights::kMaxLights);
+    auto counters = std::vector<LightsCounter> {{.directional = directional}};
+    if (lights.HasLocalLights()) {
+        for (auto local = 1u; local <= ObjectLights::kMaxLightsPerObject; local *= 2) {
+            counters.emplace_back(directional, static_cast<uint8_t>(local));
+        }
+        counters.push_back({.directional = directional, .clustered = true});
+    }
+
+    for (auto renderable : renderables) {
+        const auto batchable = RenderLists::CanBatch(renderable);
+        for (const auto batched : {false, true}) {
+            if (batched && !batchable) continue;
+            for (const auto& counter : counters) {
+                const auto attrs = ProgramAttributes {renderable, counter, scene, batched};
+                programs_.GetProgram(attrs);
+                if (prepass_ && GLDepthPrepass::IsCandidate(renderable)) {
+                    programs_.GetProgram(attrs.DepthOnly());
+                }
+            }
+        }
+    }
+}
+
+auto Renderer::GLImpl::PendingPrograms() -> std::size_t {
+    return programs_.Poll();
 }
 
-Renderer::Impl::~Impl() = default;
+Renderer::GLImpl::~GLImpl() = default;
 
 }
\ No newline at end of file
@@ -7,69 +7,122 @@
 
 #pragma once
 
-#include "core/renderer.hpp"
+#include "core/renderer_impl.hpp"
 
 #include "gleam/nodes/renderable.hpp"
 
+#include "core/render_lists.hpp"
+
 #include "renderer/gl/gl_buffers.hpp"
 #include "renderer/gl/gl_camera.hpp"
+#include "renderer/gl/gl_depth_prepass.hpp"
+#include "renderer/gl/gl_fog.hpp"
+#include "renderer/gl/gl_frame_capture.hpp"
+#include "renderer/gl/gl_framebuffer.hpp"
 #include "renderer/gl/gl_lights.hpp"
+#include "renderer/gl/gl_materials.hpp"
+#include "renderer/gl/gl_objects.hpp"
+#include "renderer/gl/gl_occlusion_queries.hpp"
 #include "renderer/gl/gl_programs.hpp"
 #include "renderer/gl/gl_state.hpp"
 #include "renderer/gl/gl_textures.hpp"
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace gleam {
 
-class RenderLists;
-
-class Renderer::Impl {
+class Renderer::GLImpl : public Renderer::Impl {
 public:
-    explicit Impl(const Renderer::Parameters& params);
+    explicit GLImpl(const Renderer::Parameters& params);
+
+    auto Submit() -> void override;
+
+    auto SetClearColor(const Color& color) -> void override;
+
+    auto StartCapture(const OnFrameCaptured& callback) -> void override;
 
-    Impl(const Impl&) = delete;
-    Impl(Impl&&) = delete;
-    Impl& operator=(const Impl&) = delete;
-    Impl& operator=(Impl&&) = delete;
+    auto StopCapture() -> void override;
 
-    auto Render(Scene* scene, Camera* camera) -> void;
+    [[nodiscard]] auto CaptureStats() const -> FrameCaptureStats override;
 
-    auto SetClearColor(const Color& color) -> void;
+    auto Precompile(Scene* scene) -> void override;
 
-    [[nodiscard]] auto RenderedObjectsPerFrame() const {
-        return rendered_objects_per_frame_;
-    }
+    [[nodiscard]] auto PendingPrograms() -> std::size_t override;
 
-    ~Impl();
+    ~GLImpl() override;
 
 private:
     GLBuffers buffers_;
     GLCamera camera_ubo_;
+    GLFog fog_;
     GLLights lights_;
+    GLMaterials materials_;
+    GLObjects objects_;
     GLPrograms programs_;
     GLState state_;
     GLTextures textures_;
 
-    Renderer::Parameters params_;
+    std::unique_ptr<GLFramebuffer> framebuffer_;
+
+    std::unique_ptr<GLOcclusionQueries> occlusion_;
+
+    std::unique_ptr<GLDepthPrepass> prepass_;
+
+    // Opaque draws whose depth was written in the pre-pass, by object index
+    std::vector<bool> prepassed_;
+
+    std::unique_ptr<GLFrameCapture> capture_;
 
-    std::unique_ptr<RenderLists> render_lists_;
+    OnFrameCaptured on_frame_captured_;
+
+    FrameCaptureStats capture_stats_;
+
+    std::uint64_t submitted_frames_ {0};
 
     size_t rendered_objects_counter_ {0};
-    size_t rendered_objects_per_frame_ {0};
 
-    auto ProcessLights(Camera* camera) -> void;
+    auto RenderObjects(const Frame& frame) -> void;
+
+    auto WriteObjects(const Frame& frame) -> void;
+
+    auto GetProgram(
+        Renderable* renderable,
+        int object_index,
+        const Frame& frame,
+        bool batched
+    ) -> GLProgram*;
+
+    auto RenderObject(
+        const RenderLists::RenderBatch& batch,
+        int object_index,
+        const Frame& frame
+    ) -> void;
 
-    auto RenderObjects(Scene* scene, Camera* camera) -> void;
+    auto RenderDepth(
+        const RenderLists::RenderBatch& batch,
+        int object_index,
+        const Frame& frame
+    ) -> bool;
+
+    auto DrawGeometry(
+        const RenderLists::RenderBatch& batch,
+        int object_index,
+        const Frame& frame,
+        const Geometry* geometry,
+        unsigned int primitive
+    ) -> void;
 
-    auto RenderObject(Renderable* renderable, Scene* scene, Camera* camera) -> void;
+    [[nodiscard]] auto IsQueried(const RenderLists::RenderBatch& batch) const -> bool;
 
     auto SetUniforms(
         GLProgram* program,
         ProgramAttributes* attrs,
-        Renderable* renderable,
-        Camera* camera,
-        Scene* scene
+        const RenderLists::RenderBatch& batch,
+        int object_index,
+        const Frame& frame
     ) -> void;
 };
 
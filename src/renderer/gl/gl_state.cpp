@@ -7,113 +7,241 @@
 
 #include "renderer/gl/gl_state.hpp"
 
-#include <glad/glad.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
 
 namespace gleam {
 
+namespace {
+
+constexpr auto kFeatureTokens = std::array<GLenum, std::to_underlying(GLState::Feature::Length)> {
+    GL_BLEND,
+    GL_CULL_FACE,
+    GL_DEPTH_TEST,
+    GL_POLYGON_OFFSET_FILL
+};
+
+}
+
 auto GLState::ProcessMaterial(const Material* material) -> void {
-    SetBackfaceCulling(!material->two_sided);
-    SetDepthTest(material->depth_test);
+    SetFeature(Feature::CullFace, !material->two_sided);
+    SetFeature(Feature::DepthTest, material->depth_test);
     SetPolygonOffset(material->polygon_offset_factor, material->polygon_offset_units);
     SetBlending(!material->transparent ? Blending::None : material->blending);
 }
 
-auto GLState::Enable(int token) -> void {
-    if (!features_.contains(token) || !features_[token]) {
-        glEnable(token);
-        features_[token] = true;
+auto GLState::Track(bool changed) -> bool {
+    ++counters_.calls;
+    if (!changed) ++counters_.skipped;
+    return changed;
+}
+
+auto GLState::Enable(Feature feature) -> void {
+    SetFeature(feature, true);
+}
+
+auto GLState::Disable(Feature feature) -> void {
+    SetFeature(feature, false);
+}
+
+auto GLState::SetFeature(Feature feature, bool enabled) -> void {
+    const auto index = std::to_underlying(feature);
+    if (Track(features_.test(index) != enabled)) {
+        const auto token = kFeatureTokens[index];
+        enabled ? glEnable(token) : glDisable(token);
+        features_.set(index, enabled);
     }
 }
 
-auto GLState::Disable(int token) -> void {
-    if (features_.contains(token) && features_[token]) {
-        glDisable(token);
-        features_[token] = false;
+auto GLState::SetViewport(int x, int y, int width, int height) -> void {
+    const auto viewport = std::array {x, y, width, height};
+    if (Track(curr_viewport_ != viewport)) {
+        glViewport(x, y, width, height);
+        curr_viewport_ = viewport;
     }
 }
 
-auto GLState::SetViewport(int x, int y, int width, int height) const -> void {
-    glViewport(x, y, width, height);
+auto GLState::SetColorMask(bool enabled) -> void {
+    if (Track(curr_color_mask_ != enabled)) {
+        const auto mask = enabled ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+        curr_color_mask_ = enabled;
+    }
 }
 
-auto GLState::SetBackfaceCulling(bool enabled) -> void {
-    enabled ? Enable(GL_CULL_FACE) : Disable(GL_CULL_FACE);
+auto GLState::SetCullFace(GLenum mode) -> void {
+    if (Track(curr_cull_face_ != mode)) {
+        glCullFace(mode);
+        curr_cull_face_ = mode;
+    }
 }
 
-auto GLState::SetDepthTest(bool enabled) -> void {
-    enabled ? Enable(GL_DEPTH_TEST) : Disable(GL_DEPTH_TEST);
+auto GLState::SetDepthFunc(GLenum func) -> void {
+    if (Track(curr_depth_func_ != func)) {
+        glDepthFunc(func);
+        curr_depth_func_ = func;
+    }
 }
 
 auto GLState::SetDepthMask(bool enabled) -> void {
-    if (curr_depth_mask_ != enabled) {
+    if (Track(curr_depth_mask_ != enabled)) {
         glDepthMask(enabled ? GL_TRUE : GL_FALSE);
         curr_depth_mask_ = enabled;
     }
 }
 
-auto GLState::UseProgram(unsigned int program_id) -> void {
-    if (curr_program_ != program_id) {
+auto GLState::UseProgram(GLuint program_id) -> void {
+    if (Track(curr_program_ != program_id)) {
         glUseProgram(program_id);
         curr_program_ = program_id;
     }
 }
 
+auto GLState::BindVertexArray(GLuint vao) -> void {
+    if (Track(curr_vao_ != vao)) {
+        glBindVertexArray(vao);
+        curr_vao_ = vao;
+    }
+}
+
+auto GLState::BindUniformBufferRange(
+    GLuint index,
+    GLuint buffer,
+    GLintptr offset,
+    GLsizeiptr size
+) -> void {
+    auto& range = uniform_buffers_[index];
+    const auto changed = range.buffer != buffer || range.offset != offset || range.size != size;
+    if (Track(changed)) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+        range = {buffer, offset, size};
+    }
+}
+
+auto GLState::ActiveTexture(GLuint unit) -> void {
+    if (Track(curr_texture_unit_ != unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        curr_texture_unit_ = unit;
+    }
+}
+
+auto GLState::BindTexture(GLuint unit, GLenum target, GLuint texture) -> void {
+    const auto slot = std::distance(
+        kTextureTargets.begin(),
+        std::ranges::find(kTextureTargets, target)
+    );
+    auto& bound = textures_[unit][slot];
+    if (Track(bound != texture)) {
+        ActiveTexture(unit);
+        glBindTexture(target, texture);
+        bound = texture;
+    }
+}
+
+auto GLState::BindTexture(GLenum target, GLuint texture) -> void {
+    BindTexture(curr_texture_unit_, target, texture);
+}
+
+auto GLState::ForgetTexture(GLuint texture) -> void {
+    for (auto& unit : textures_) {
+        std::ranges::replace(unit, texture, GLuint {0});
+    }
+}
+
 auto GLState::SetPolygonOffset(float factor, float units) -> void {
-    if (factor != 0.0f || units != 0.0f) {
-        Enable(GL_POLYGON_OFFSET_FILL);
+    const auto enabled = factor != 0.0f || units != 0.0f;
+    SetFeature(Feature::PolygonOffsetFill, enabled);
+    if (!enabled) return;
+
+    const auto changed = curr_polygon_offset_factor_ != factor || curr_polygon_offset_units_ != units;
+    if (Track(changed)) {
         glPolygonOffset(factor, units);
-    } else {
-        Disable(GL_POLYGON_OFFSET_FILL);
+        curr_polygon_offset_factor_ = factor;
+        curr_polygon_offset_units_ = units;
+    }
+}
+
+auto GLState::SetBlendEquation(GLenum mode) -> void {
+    if (Track(curr_blend_equation_ != mode)) {
+        glBlendEquation(mode);
+        curr_blend_equation_ = mode;
+    }
+}
+
+auto GLState::SetBlendFunc(GLenum src, GLenum dst) -> void {
+    if (Track(curr_blend_src_ != src || curr_blend_dst_ != dst)) {
+        glBlendFunc(src, dst);
+        curr_blend_src_ = src;
+        curr_blend_dst_ = dst;
     }
 }
 
 auto GLState::SetBlending(Blending blending) -> void {
-    if (curr_blending_ != blending) {
-        if (blending == Blending::None) {
-            Disable(GL_BLEND);
-        } else {
-            Enable(GL_BLEND);
-            switch (blending) {
-            case Blending::Normal:
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-                break;
-            case Blending::Additive:
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-                break;
-            case Blending::Subtractive:
-                glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-                break;
-            case Blending::Multiply:
-                glBlendFunc(GL_ZERO, GL_SRC_COLOR);
-                break;
-            case Blending::None:
-                break;
-            }
-        }
-        curr_blending_ = blending;
+    SetFeature(Feature::Blend, blending != Blending::None);
+
+    switch (blending) {
+    case Blending::Normal:
+        SetBlendEquation(GL_FUNC_ADD);
+        SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+    case Blending::Additive:
+        SetBlendEquation(GL_FUNC_ADD);
+        SetBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        break;
+    case Blending::Subtractive:
+        SetBlendEquation(GL_FUNC_ADD);
+        SetBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+        break;
+    case Blending::Multiply:
+        SetBlendEquation(GL_FUNC_ADD);
+        SetBlendFunc(GL_ZERO, GL_SRC_COLOR);
+        break;
+    case Blending::None:
+        break;
     }
 }
 
 auto GLState::SetClearColor(const Color& color) -> void {
-    if (curr_clear_color_ != color) {
+    if (Track(curr_clear_color_ != color)) {
         glClearColor(color.r, color.g, color.b, 1.0f);
         curr_clear_color_ = color;
     }
 }
 
 auto GLState::Reset() -> void {
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_POLYGON_OFFSET_FILL);
+    for (const auto token : kFeatureTokens) {
+        glDisable(token);
+    }
     glFrontFace(GL_CCW);
+    glCullFace(GL_BACK);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-    features_.clear();
-
-    curr_blending_ = Blending::None;
-    curr_depth_mask_ = false;
-    curr_wireframe_mode_ = false;
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunc(GL_ONE, GL_ZERO);
+    glPolygonOffset(0.0f, 0.0f);
+    glUseProgram(0);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+
+    features_.reset();
+    textures_ = {};
+    uniform_buffers_ = {};
+
+    curr_color_mask_ = true;
+    curr_cull_face_ = GL_BACK;
+    curr_depth_func_ = GL_LESS;
+    curr_depth_mask_ = true;
+    curr_blend_equation_ = GL_FUNC_ADD;
+    curr_blend_src_ = GL_ONE;
+    curr_blend_dst_ = GL_ZERO;
+    curr_polygon_offset_factor_ = 0.0f;
+    curr_polygon_offset_units_ = 0.0f;
     curr_program_ = 0;
+    curr_vao_ = 0;
+    curr_texture_unit_ = 0;
 }
 
 }
\ No newline at end of file
@@ -10,47 +10,150 @@
 #include <gleam/materials/material.hpp>
 #include <gleam/math/color.hpp>
 
-#include <memory>
-#include <unordered_map>
+#include <array>
+#include <bitset>
+#include <cstddef>
+
+#include <glad/glad.h>
 
 namespace gleam {
 
+// Shadow copy of the GL state the renderer changes. Every call compares the
+// requested value with the last one set and skips the driver call when they
+// match, so the rest of the renderer can set what a draw needs without
+// tracking what the previous draw left behind.
+//
+// The cache assumes all changes to the tracked state go through it. Objects
+// that are bound when they're created, such as textures and vertex arrays,
+// are bound through it as well, and deleted textures are forgotten.
 class GLState {
 public:
+    enum class Feature {
+        Blend,
+        CullFace,
+        DepthTest,
+        PolygonOffsetFill,
+        Length
+    };
+
+    // Calls made to the cache, and how many of them were redundant
+    // and never reached the driver, since the last ResetCounters().
+    struct Counters {
+        std::size_t calls {0};
+        std::size_t skipped {0};
+    };
+
+    static constexpr auto kTextureUnits = std::size_t {16};
+
+    static constexpr auto kUniformBindings = std::size_t {16};
+
     auto ProcessMaterial(const Material* material) -> void;
 
+    auto Enable(Feature feature) -> void;
+
+    auto Disable(Feature feature) -> void;
+
+    auto SetBlendEquation(GLenum mode) -> void;
+
+    auto SetBlendFunc(GLenum src, GLenum dst) -> void;
+
     auto SetClearColor(const Color& color) -> void;
 
+    auto SetColorMask(bool enabled) -> void;
+
+    auto SetCullFace(GLenum mode) -> void;
+
+    auto SetDepthFunc(GLenum func) -> void;
+
     auto SetDepthMask(bool enabled) -> void;
 
-    auto SetViewport(int x, int y, int width, int height) const -> void;
+    auto SetPolygonOffset(float factor, float units) -> void;
+
+    auto SetViewport(int x, int y, int width, int height) -> void;
+
+    auto UseProgram(GLuint program_id) -> void;
+
+    auto BindVertexArray(GLuint vao) -> void;
 
-    auto UseProgram(unsigned int program_id) -> void;
+    [[nodiscard]] auto VertexArray() const { return curr_vao_; }
+
+    auto BindUniformBufferRange(
+        GLuint index,
+        GLuint buffer,
+        GLintptr offset,
+        GLsizeiptr size
+    ) -> void;
+
+    auto ActiveTexture(GLuint unit) -> void;
+
+    // Binds the texture to the unit, which is made active
+    // only when the texture isn't bound to it already.
+    auto BindTexture(GLuint unit, GLenum target, GLuint texture) -> void;
+
+    // Binds the texture to the active unit, e.g. to specify a new texture
+    auto BindTexture(GLenum target, GLuint texture) -> void;
+
+    // Deleted textures are unbound from every unit by the driver, and
+    // their names may be reused, so their bindings are cleared here too.
+    auto ForgetTexture(GLuint texture) -> void;
+
+    [[nodiscard]] auto GetCounters() const -> const Counters& { return counters_; }
+
+    auto ResetCounters() -> void { counters_ = {}; }
 
     auto Reset() -> void;
 
 private:
-    std::unordered_map<int, bool> features_;
+    struct BufferRange {
+        GLuint buffer {0};
+        GLintptr offset {0};
+        GLsizeiptr size {0};
+    };
+
+    // Texture targets the renderer binds, each with its own binding per unit
+    static constexpr auto kTextureTargets = std::array<GLenum, 3> {
+        GL_TEXTURE_2D,
+        GL_TEXTURE_2D_ARRAY,
+        GL_TEXTURE_BUFFER
+    };
 
-    Blending curr_blending_ {Blending::None};
+    // Every feature starts disabled, like a new context
+    std::bitset<static_cast<std::size_t>(Feature::Length)> features_;
+
+    std::array<std::array<GLuint, kTextureTargets.size()>, kTextureUnits> textures_ {};
+
+    std::array<BufferRange, kUniformBindings> uniform_buffers_ {};
+
+    Counters counters_;
 
     Color curr_clear_color_ {0.0f, 0.0f, 0.0f};
 
-    bool curr_backface_culling_ {false};
-    bool curr_depth_mask_ {false};
-    bool curr_wireframe_mode_ {false};
+    std::array<int, 4> curr_viewport_ {};
 
-    unsigned int curr_program_ = 0;
+    bool curr_color_mask_ {true};
+    bool curr_depth_mask_ {true};
 
-    auto Enable(int token) -> void;
+    // Zero until the first call, which always sets the value
+    GLenum curr_depth_func_ {0};
+    GLenum curr_blend_equation_ {0};
+    GLenum curr_blend_src_ {0};
+    GLenum curr_blend_dst_ {0};
 
-    auto Disable(int token) -> void;
+    GLenum curr_cull_face_ {GL_BACK};
 
-    auto SetBackfaceCulling(bool enabled) -> void;
+    float curr_polygon_offset_factor_ {0.0f};
+    float curr_polygon_offset_units_ {0.0f};
 
-    auto SetDepthTest(bool enabled) -> void;
+    GLuint curr_program_ {0};
 
-    auto SetPolygonOffset(float factor, float units) -> void;
+    GLuint curr_vao_ {0};
+
+    GLuint curr_texture_unit_ {0};
+
+    // Counts the call, and returns true if it changes the state
+    auto Track(bool changed) -> bool;
+
+    auto SetFeature(Feature feature, bool enabled) -> void;
 
     auto SetBlending(Blending blending) -> void;
 };
@@ -8,66 +8,142 @@
 #include "renderer/gl/gl_textures.hpp"
 
 #include "gleam/textures/texture_2d.hpp"
+#include "gleam/textures/texture_array.hpp"
 
 #include "utilities/logger.hpp"
 
+#include <algorithm>
+#include <string_view>
 #include <utility>
 
 namespace gleam {
 
+namespace {
+
+// GL_TEXTURE_MAX_ANISOTROPY and GL_MAX_TEXTURE_MAX_ANISOTROPY, core in 4.6
+// and defined by the anisotropic filtering extensions, which glad doesn't load
+constexpr auto kTextureMaxAnisotropy = GLenum {0x84FE};
+constexpr auto kMaxTextureMaxAnisotropy = GLenum {0x84FF};
+
+auto has_anisotropic_filtering() {
+    auto count = GLint {0};
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (auto i = 0; i < count; ++i) {
+        const auto name = std::string_view {
+            reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))
+        };
+        if (name == "GL_EXT_texture_filter_anisotropic" || name == "GL_ARB_texture_filter_anisotropic") {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto texture_target(const Texture* texture) -> GLenum {
+    return texture->GetType() == TextureType::TextureArray
+        ? GL_TEXTURE_2D_ARRAY
+        : GL_TEXTURE_2D;
+}
+
+}
+
+GLTextures::GLTextures(const Parameters& params) {
+    if (params.anisotropy > 1.0f) {
+        if (!has_anisotropic_filtering()) {
+            Logger::Log(LogLevel::Warning, "Anisotropic filtering isn't supported, filtering trilinearly");
+            return;
+        }
+        auto max_anisotropy = GLfloat {1.0f};
+        glGetFloatv(kMaxTextureMaxAnisotropy, &max_anisotropy);
+        anisotropy_ = std::clamp(params.anisotropy, 1.0f, max_anisotropy);
+    }
+}
+
 auto GLTextures::Bind(
+    GLState& state,
     const std::shared_ptr<Texture>& texture,
     GLTextureMapType map_type
 ) -> void {
-    auto tex_unit = std::to_underlying(map_type);
-    glActiveTexture(GL_TEXTURE0 + tex_unit);
+    const auto tex_unit = static_cast<GLuint>(std::to_underlying(map_type));
 
     auto tex_id = texture->renderer_id;
     if (tex_id == 0) {
-        tex_id = GenerateTexture(texture.get());
+        tex_id = GenerateTexture(state, texture.get(), tex_unit);
         textures_.emplace_back(texture);
     }
 
-    if (tex_id == current_texture_ids_[tex_unit]) return;
-
-    glBindTexture(GL_TEXTURE_2D, tex_id);
-    current_texture_ids_[tex_unit] = tex_id;
+    state.BindTexture(tex_unit, texture_target(texture.get()), tex_id);
 }
 
-auto GLTextures::GenerateTexture(Texture* texture) const -> GLuint {
+auto GLTextures::GenerateTexture(GLState& state, Texture* texture, GLuint unit) const -> GLuint {
+    const auto target = texture_target(texture);
     auto& tex_id = texture->renderer_id;
     glGenTextures(1, &tex_id);
-    glBindTexture(GL_TEXTURE_2D, tex_id);
+    // Specified on the unit it's drawn with, so it's bound there already
+    state.BindTexture(unit, target, tex_id);
 
-    // Currently, the engine only supports 2D textures.
+    // Texture arrays are stacks of 2D textures, so both share the image data
     auto texture_2d = static_cast<Texture2D*>(texture);
 
     // Safe defaults for arbitrary row strides
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_RGBA8, // Guaranteed by asset builder
-        texture_2d->width,
-        texture_2d->height,
-        0,
-        GL_RGBA,
-        GL_UNSIGNED_BYTE,
-        texture_2d->data.data()
-    );
-
-    // Complete without mipmaps
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // Levels are stored one after the other, and the levels of
+    // texture arrays hold the data of every layer
+    const auto levels = std::max(texture_2d->mip_levels, 1u);
+    const auto layers = target == GL_TEXTURE_2D_ARRAY
+        ? static_cast<TextureArray*>(texture)->layers
+        : 1u;
+    auto offset = std::size_t {0};
+    for (auto level = 0u; level < levels; ++level) {
+        const auto width = std::max(texture_2d->width >> level, 1u);
+        const auto height = std::max(texture_2d->height >> level, 1u);
+        const auto data = texture_2d->data.data() + offset;
+        if (target == GL_TEXTURE_2D_ARRAY) {
+            glTexImage3D(
+                GL_TEXTURE_2D_ARRAY,
+                level,
+                GL_RGBA8, // Guaranteed by asset builder
+                width,
+                height,
+                layers,
+                0,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                data
+            );
+        } else {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                level,
+                GL_RGBA8, // Guaranteed by asset builder
+                width,
+                height,
+                0,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                data
+            );
+        }
+        offset += texture_2d->MipLevelSize(level) * layers;
+    }
+
+    // Complete with the levels it has. Textures without a mip chain
+    // are filtered bilinearly, and the rest trilinearly.
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels - 1));
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (anisotropy_ > 1.0f) {
+        glTexParameterf(target, kTextureMaxAnisotropy, anisotropy_);
+    }
 
     if (glGetError() != GL_NO_ERROR) {
         Logger::Log(LogLevel::Error, "OpenGL error failed to generate texture");
     }
 
-    texture->OnDispose([this](Disposable* target) {
+    texture->OnDispose([&state](Disposable* target) {
+        state.ForgetTexture(static_cast<Texture*>(target)->renderer_id);
         glDeleteTextures(1, &(static_cast<Texture*>(target)->renderer_id));
         Logger::Log(LogLevel::Info, "Texture buffer cleared {}", *static_cast<Texture*>(target));
     });
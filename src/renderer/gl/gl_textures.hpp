@@ -9,6 +9,8 @@
 
 #include "gleam/textures/texture.hpp"
 
+#include "renderer/gl/gl_state.hpp"
+
 #include <array>
 #include <memory>
 #include <string_view>
@@ -21,12 +23,22 @@ namespace gleam {
 
 enum class GLTextureMapType {
     AlbedoMap = 0,
-    AlphaMap = 1
+    AlphaMap = 1,
+    LightIndices = 12,
+    LightClusters = 13,
+    LightData = 14,
+    ObjectData = 15
 };
 
 class GLTextures {
 public:
-    GLTextures() = default;
+    struct Parameters {
+        // Maximum anisotropy of texture filtering, clamped to what the driver
+        // supports. Values above 1 require GL_EXT_texture_filter_anisotropic.
+        float anisotropy {1.0f};
+    };
+
+    explicit GLTextures(const Parameters& params);
 
     GLTextures(const GLTextures&) = delete;
     GLTextures(GLTextures&&) = delete;
@@ -34,18 +46,21 @@ public:
     GLTextures& operator=(GLTextures&&) = delete;
 
     auto Bind(
+        GLState& state,
         const std::shared_ptr<Texture>& texture,
         GLTextureMapType map_type
     ) -> void;
 
     ~GLTextures();
 
+    [[nodiscard]] auto Anisotropy() const { return anisotropy_; }
+
 private:
     std::vector<std::weak_ptr<Texture>> textures_;
 
-    std::array<GLuint, 16> current_texture_ids_ {};
+    float anisotropy_ {1.0f};
 
-    auto GenerateTexture(Texture* texture) const -> GLuint;
+    auto GenerateTexture(GLState& state, Texture* texture, GLuint unit) const -> GLuint;
 };
 
 }
\ No newline at end of file
@@ -26,6 +26,7 @@ enum class UniformType {
     Matrix3,
     Matrix4,
     Sampler2D,
+    SamplerBuffer,
     Vector2,
     Vector3,
     Vector4,
@@ -37,20 +38,15 @@ enum class Uniform {
     AlphaMap,
     AmbientLight,
     Anchor,
-    Color,
-    FogColor,
-    FogDensity,
-    FogFar,
-    FogNear,
-    FogType,
-    MaterialDiffuseColor,
-    MaterialShininess,
-    MaterialSpecularColor,
-    Model,
-    Opacity,
+    LightClusters,
+    LightData,
+    LightIndices,
+    ObjectData,
+    ObjectIndex,
+    ObjectLightCount,
+    ObjectLightOffset,
     Resolution,
     Rotation,
-    TextureTransform,
     KnownUniformsLength
 };
 
@@ -60,20 +56,15 @@ constexpr auto get_uniform_loc(std::string_view str) {
     if (str == "u_AlphaMap") return static_cast<int>(AlphaMap);
     if (str == "u_AmbientLight") return static_cast<int>(AmbientLight);
     if (str == "u_Anchor") return static_cast<int>(Anchor);
-    if (str == "u_Color") return static_cast<int>(Color);
-    if (str == "u_Fog.Color") return static_cast<int>(FogColor);
-    if (str == "u_Fog.Density") return static_cast<int>(FogDensity);
-    if (str == "u_Fog.Far") return static_cast<int>(FogFar);
-    if (str == "u_Fog.Near") return static_cast<int>(FogNear);
-    if (str == "u_Fog.Type") return static_cast<int>(FogType);
-    if (str == "u_Material.DiffuseColor") return static_cast<int>(MaterialDiffuseColor);
-    if (str == "u_Material.Shininess") return static_cast<int>(MaterialShininess);
-    if (str == "u_Material.SpecularColor") return static_cast<int>(MaterialSpecularColor);
-    if (str == "u_Model") return static_cast<int>(Model);
-    if (str == "u_Opacity") return static_cast<int>(Opacity);
+    if (str == "u_LightClusters") return static_cast<int>(LightClusters);
+    if (str == "u_LightData") return static_cast<int>(LightData);
+    if (str == "u_LightIndices") return static_cast<int>(LightIndices);
+    if (str == "u_ObjectData") return static_cast<int>(ObjectData);
+    if (str == "u_ObjectIndex") return static_cast<int>(ObjectIndex);
+    if (str == "u_ObjectLightCount") return static_cast<int>(ObjectLightCount);
+    if (str == "u_ObjectLightOffset") return static_cast<int>(ObjectLightOffset);
     if (str == "u_Resolution") return static_cast<int>(Resolution);
     if (str == "u_Rotation") return static_cast<int>(Rotation);
-    if (str == "u_TextureTransform") return static_cast<int>(TextureTransform);
     return -1;
 }
 
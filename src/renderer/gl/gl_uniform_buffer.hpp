@@ -19,6 +19,9 @@ namespace gleam {
 enum class UniformBuffer {
     Camera,
     Lights,
+    Material,
+    Fog,
+    Clusters,
     KnownUniformBuffersLength
 };
 
@@ -26,6 +29,9 @@ constexpr auto get_uniform_block_loc(std::string_view str) {
     using enum UniformBuffer;
     if (str == "ub_Camera") return static_cast<int>(Camera);
     if (str == "ub_Lights") return static_cast<int>(Lights);
+    if (str == "ub_Material") return static_cast<int>(Material);
+    if (str == "ub_Fog") return static_cast<int>(Fog);
+    if (str == "ub_Clusters") return static_cast<int>(Clusters);
     return -1;
 }
 
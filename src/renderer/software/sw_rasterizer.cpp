@@ -0,0 +1,406 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/software/sw_rasterizer.hpp"
+
+#include "gleam/math/utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace gleam {
+
+namespace {
+
+// Smallest depth difference resolvable in a 24-bit depth buffer,
+// which is what polygon offset units are expressed in.
+constexpr auto kDepthResolution = 1.0f / 16'777'216.0f;
+
+auto parallel_for(
+    JobSystem* jobs,
+    std::size_t count,
+    std::size_t grain,
+    const std::function<void(std::size_t begin, std::size_t end)>& fn
+) {
+    if (jobs != nullptr) {
+        jobs->ParallelFor(count, grain, fn);
+    } else {
+        fn(0, count);
+    }
+}
+
+auto pack(const Vector4& color) -> uint32_t {
+    const auto channel = [](float c) {
+        return static_cast<uint32_t>(math::Clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(color.x) |
+        channel(color.y) << 8 |
+        channel(color.z) << 16 |
+        channel(color.w) << 24;
+}
+
+auto unpack(uint32_t color) -> Vector4 {
+    constexpr auto scale = 1.0f / 255.0f;
+    return {
+        static_cast<float>(color & 0xFF) * scale,
+        static_cast<float>(color >> 8 & 0xFF) * scale,
+        static_cast<float>(color >> 16 & 0xFF) * scale,
+        static_cast<float>(color >> 24 & 0xFF) * scale
+    };
+}
+
+auto blend(Blending blending, const Vector4& src, const Vector4& dst) -> Vector4 {
+    switch (blending) {
+        case Blending::Normal: return src * src.w + dst * (1.0f - src.w);
+        case Blending::Additive: return src * src.w + dst;
+        case Blending::Subtractive: return dst * (Vector4 {1.0f} - src);
+        case Blending::Multiply: return dst * src;
+        case Blending::None: break;
+    }
+    return src;
+}
+
+auto lerp(const SWRasterizer::Vertex& a, const SWRasterizer::Vertex& b, float t) {
+    return SWRasterizer::Vertex {
+        .clip = Lerp(a.clip, b.clip, t),
+        .position = Lerp(a.position, b.position, t),
+        .normal = Lerp(a.normal, b.normal, t),
+        .uv = Lerp(a.uv, b.uv, t),
+        .color = Lerp(a.color, b.color, t)
+    };
+}
+
+// Distance to the near plane in clip space, positive when inside
+auto near_distance(const SWRasterizer::Vertex& v) {
+    return v.clip.z + v.clip.w;
+}
+
+}
+
+SWRasterizer::SWRasterizer(int width, int height, JobSystem* jobs)
+  : jobs_(jobs),
+    width_(width),
+    height_(height),
+    tiles_x_((width + kTileSize - 1) / kTileSize),
+    tiles_y_((height + kTileSize - 1) / kTileSize) {
+    const auto pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    color_.resize(pixels);
+    depth_.resize(pixels);
+    bins_.resize(static_cast<std::size_t>(tiles_x_ * tiles_y_));
+}
+
+auto SWRasterizer::Clear(const Color& color) -> void {
+    std::ranges::fill(color_, pack({color.r, color.g, color.b, 1.0f}));
+    std::ranges::fill(depth_, 1.0f);
+}
+
+auto SWRasterizer::Begin(std::span<const SWDraw> draws) -> void {
+    draws_ = draws;
+    if (draw_triangles_.size() < draws.size()) draw_triangles_.resize(draws.size());
+    for (auto& triangles : draw_triangles_) triangles.clear();
+}
+
+auto SWRasterizer::AddTriangles(
+    std::size_t draw,
+    std::span<const Vertex> vertices,
+    std::span<const unsigned int> indices
+) -> void {
+    const auto count = indices.empty() ? vertices.size() : indices.size();
+    const auto vertex = [&](std::size_t i) -> const Vertex& {
+        return indices.empty() ? vertices[i] : vertices[indices[i]];
+    };
+
+    for (auto i = std::size_t {0}; i + 2 < count; i += 3) {
+        const auto& a = vertex(i);
+        const auto& b = vertex(i + 1);
+        const auto& c = vertex(i + 2);
+
+        const auto da = near_distance(a);
+        const auto db = near_distance(b);
+        const auto dc = near_distance(c);
+
+        if (da >= 0.0f && db >= 0.0f && dc >= 0.0f) {
+            SetupTriangle(draw, a, b, c);
+            continue;
+        }
+        if (da < 0.0f && db < 0.0f && dc < 0.0f) continue;
+
+        // Clips the triangle against the near plane, which leaves a
+        // triangle or a quad. The far plane is handled per fragment.
+        auto polygon = std::array<Vertex, 4> {};
+        auto n = 0;
+        const auto input = std::array<std::pair<const Vertex*, float>, 3> {{
+            {&a, da}, {&b, db}, {&c, dc}
+        }};
+        for (auto j = 0; j < 3; ++j) {
+            const auto [curr, d_curr] = input[j];
+            const auto [next, d_next] = input[(j + 1) % 3];
+            if (d_curr >= 0.0f) polygon[n++] = *curr;
+            if ((d_curr >= 0.0f) != (d_next >= 0.0f)) {
+                polygon[n++] = lerp(*curr, *next, d_curr / (d_curr - d_next));
+            }
+        }
+
+        for (auto j = 1; j + 1 < n; ++j) {
+            SetupTriangle(draw, polygon[0], polygon[j], polygon[j + 1]);
+        }
+    }
+}
+
+auto SWRasterizer::SetupTriangle(
+    std::size_t draw,
+    const Vertex& a,
+    const Vertex& b,
+    const Vertex& c
+) -> void {
+    const auto& state = draws_[draw];
+    auto vertices = std::array<const Vertex*, 3> {&a, &b, &c};
+    auto triangle = Triangle {};
+
+    for (auto i = 0; i < 3; ++i) {
+        const auto& clip = vertices[i]->clip;
+        const auto inv_w = 1.0f / clip.w;
+        triangle.inv_w[i] = inv_w;
+        triangle.screen[i] = {
+            (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(width_),
+            (clip.y * inv_w * 0.5f + 0.5f) * static_cast<float>(height_),
+            clip.z * inv_w * 0.5f + 0.5f
+        };
+    }
+
+    const auto& s = triangle.screen;
+    auto area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[1].y - s[0].y) * (s[2].x - s[0].x);
+    if (area == 0.0f || !std::isfinite(area)) return;
+
+    // Counter-clockwise triangles are front facing. Back faces are
+    // rewound, so every triangle is rasterized with a positive area.
+    triangle.front_facing = area > 0.0f;
+    if (!triangle.front_facing) {
+        if (state.cull_back_faces) return;
+        std::swap(vertices[1], vertices[2]);
+        std::swap(triangle.inv_w[1], triangle.inv_w[2]);
+        std::swap(triangle.screen[1], triangle.screen[2]);
+        area = -area;
+    }
+
+    const auto min_x = std::min({s[0].x, s[1].x, s[2].x});
+    const auto max_x = std::max({s[0].x, s[1].x, s[2].x});
+    const auto min_y = std::min({s[0].y, s[1].y, s[2].y});
+    const auto max_y = std::max({s[0].y, s[1].y, s[2].y});
+    if (max_x < 0.0f || max_y < 0.0f) return;
+    if (min_x > static_cast<float>(width_) || min_y > static_cast<float>(height_)) return;
+
+    for (auto i = 0; i < 3; ++i) {
+        const auto& v = *vertices[i];
+        const auto inv_w = triangle.inv_w[i];
+        triangle.position[i] = v.position * inv_w;
+        triangle.normal[i] = v.normal * inv_w;
+        triangle.uv[i] = v.uv * inv_w;
+        triangle.color[i] = v.color * inv_w;
+    }
+
+    // Same orientation as a face normal derived from screen-space
+    // derivatives, i.e. always facing the camera.
+    const auto& p = vertices;
+    auto face_normal = Normalize(Cross(p[1]->position - p[0]->position, p[2]->position - p[0]->position));
+    if (Dot(face_normal, p[0]->position) > 0.0f) face_normal *= -1.0f;
+    triangle.face_normal = face_normal;
+
+    if (state.polygon_offset_factor != 0.0f || state.polygon_offset_units != 0.0f) {
+        const auto dz1 = s[1].z - s[0].z;
+        const auto dz2 = s[2].z - s[0].z;
+        const auto dzdx = (dz1 * (s[2].y - s[0].y) - dz2 * (s[1].y - s[0].y)) / area;
+        const auto dzdy = (dz2 * (s[1].x - s[0].x) - dz1 * (s[2].x - s[0].x)) / area;
+        triangle.depth_offset =
+            state.polygon_offset_factor * std::max(std::abs(dzdx), std::abs(dzdy)) +
+            state.polygon_offset_units * kDepthResolution;
+    }
+
+    triangle.draw = static_cast<uint32_t>(draw);
+    draw_triangles_[draw].emplace_back(triangle);
+}
+
+auto SWRasterizer::Rasterize() -> void {
+    Bin();
+
+    parallel_for(jobs_, bins_.size(), 1, [this](std::size_t begin, std::size_t end) {
+        for (auto tile = begin; tile < end; ++tile) {
+            RasterizeTile(static_cast<int>(tile));
+        }
+    });
+}
+
+auto SWRasterizer::Bin() -> void {
+    triangles_.clear();
+    for (auto& bin : bins_) bin.clear();
+
+    for (auto draw = std::size_t {0}; draw < draws_.size(); ++draw) {
+        for (const auto& triangle : draw_triangles_[draw]) {
+            const auto& s = triangle.screen;
+            const auto tile = [](float v, int tiles) {
+                return std::clamp(static_cast<int>(v) / kTileSize, 0, tiles - 1);
+            };
+            const auto tx0 = tile(std::min({s[0].x, s[1].x, s[2].x}), tiles_x_);
+            const auto tx1 = tile(std::max({s[0].x, s[1].x, s[2].x}), tiles_x_);
+            const auto ty0 = tile(std::min({s[0].y, s[1].y, s[2].y}), tiles_y_);
+            const auto ty1 = tile(std::max({s[0].y, s[1].y, s[2].y}), tiles_y_);
+
+            const auto index = static_cast<uint32_t>(triangles_.size());
+            triangles_.emplace_back(triangle);
+            for (auto ty = ty0; ty <= ty1; ++ty) {
+                for (auto tx = tx0; tx <= tx1; ++tx) {
+                    bins_[ty * tiles_x_ + tx].emplace_back(index);
+                }
+            }
+        }
+    }
+}
+
+auto SWRasterizer::RasterizeTile(int tile) -> void {
+    const auto tile_x = (tile % tiles_x_) * kTileSize;
+    const auto tile_y = (tile / tiles_x_) * kTileSize;
+    const auto tile_x1 = std::min(tile_x + kTileSize, width_);
+    const auto tile_y1 = std::min(tile_y + kTileSize, height_);
+
+    for (const auto index : bins_[tile]) {
+        const auto& triangle = triangles_[index];
+        const auto& s = triangle.screen;
+
+        // Pixels whose centers may be covered, clipped to the tile
+        const auto x0 = std::max(tile_x, static_cast<int>(std::floor(std::min({s[0].x, s[1].x, s[2].x}))));
+        const auto x1 = std::min(tile_x1, static_cast<int>(std::ceil(std::max({s[0].x, s[1].x, s[2].x}))));
+        const auto y0 = std::max(tile_y, static_cast<int>(std::floor(std::min({s[0].y, s[1].y, s[2].y}))));
+        const auto y1 = std::min(tile_y1, static_cast<int>(std::ceil(std::max({s[0].y, s[1].y, s[2].y}))));
+        if (x0 >= x1 || y0 >= y1) continue;
+
+        RasterizeTriangle(triangle, x0, y0, x1, y1);
+    }
+}
+
+auto SWRasterizer::RasterizeTriangle(
+    const Triangle& triangle,
+    int x0,
+    int y0,
+    int x1,
+    int y1
+) -> void {
+    const auto& draw = draws_[triangle.draw];
+    const auto& s = triangle.screen;
+
+    // Edge i is opposite vertex i, so its edge function evaluated at
+    // a pixel is proportional to the pixel's barycentric weight of i.
+    auto a = std::array<float, 3> {};
+    auto b = std::array<float, 3> {};
+    auto c = std::array<float, 3> {};
+    auto on_edge = std::array<int32_t, 3> {};
+    for (auto i = 0; i < 3; ++i) {
+        const auto& from = s[(i + 1) % 3];
+        const auto& to = s[(i + 2) % 3];
+        a[i] = from.y - to.y;
+        b[i] = to.x - from.x;
+        c[i] = -(a[i] * from.x + b[i] * from.y);
+        // Pixels on shared edges belong to the triangle on the top or left
+        on_edge[i] = a[i] > 0.0f || (a[i] == 0.0f && b[i] < 0.0f);
+    }
+
+    const auto inv_area = 1.0f / (c[0] + a[0] * s[0].x + b[0] * s[0].y);
+    const auto z0 = s[0].z + triangle.depth_offset;
+    const auto dz1 = (s[1].z - s[0].z) * inv_area;
+    const auto dz2 = (s[2].z - s[0].z) * inv_area;
+
+    const auto depth_write = draw.depth_test && draw.depth_write;
+    // Without a depth test every depth is closer than the stored one
+    const auto depth_bias = draw.depth_test ? 0.0f : std::numeric_limits<float>::infinity();
+
+    // Coverage and depth are resolved for a whole span first, and only the
+    // surviving pixels are shaded. The span loop combines 32-bit comparison
+    // masks with bitwise operators, without branches or conversions to
+    // float, so GCC vectorizes it at -O3 (check with -fopt-info-vec).
+    // Shading runs the material model per pixel and stays scalar.
+    std::array<float, kTileSize> w1_span;
+    std::array<float, kTileSize> w2_span;
+    std::array<float, kTileSize> z_span;
+    std::array<int32_t, kTileSize> covered;
+
+    const auto [a0, a1, a2] = a;
+    const auto [on_edge0, on_edge1, on_edge2] = on_edge;
+
+    const auto n = x1 - x0;
+    const auto px0 = static_cast<float>(x0) + 0.5f;
+
+    for (auto y = y0; y < y1; ++y) {
+        const auto row = static_cast<std::size_t>(y) * static_cast<std::size_t>(width_);
+        const auto py = static_cast<float>(y) + 0.5f;
+        const auto e0 = a[0] * px0 + b[0] * py + c[0];
+        const auto e1 = a[1] * px0 + b[1] * py + c[1];
+        const auto e2 = a[2] * px0 + b[2] * py + c[2];
+        const auto* depth_row = depth_.data() + row + x0;
+
+        for (auto i = 0; i < n; ++i) {
+            const auto fi = static_cast<float>(i);
+            const auto w0 = e0 + a0 * fi;
+            const auto w1 = e1 + a1 * fi;
+            const auto w2 = e2 + a2 * fi;
+            const auto z = z0 + w1 * dz1 + w2 * dz2;
+
+            const auto inside =
+                ((w0 > 0.0f) | ((w0 == 0.0f) & on_edge0)) &
+                ((w1 > 0.0f) | ((w1 == 0.0f) & on_edge1)) &
+                ((w2 > 0.0f) | ((w2 == 0.0f) & on_edge2));
+            const auto in_range = (z >= 0.0f) & (z <= 1.0f);
+            const auto passed = z < depth_row[i] + depth_bias;
+
+            w1_span[i] = w1;
+            w2_span[i] = w2;
+            z_span[i] = z;
+            covered[i] = inside & in_range & passed;
+        }
+
+        for (auto i = 0; i < n; ++i) {
+            if (!covered[i]) continue;
+
+            const auto b1 = w1_span[i] * inv_area;
+            const auto b2 = w2_span[i] * inv_area;
+            const auto b0 = 1.0f - b1 - b2;
+            const auto w = 1.0f / (
+                b0 * triangle.inv_w[0] +
+                b1 * triangle.inv_w[1] +
+                b2 * triangle.inv_w[2]
+            );
+
+            const auto interpolate = [&](const auto& attribute) {
+                return (attribute[0] * b0 + attribute[1] * b1 + attribute[2] * b2) * w;
+            };
+
+            auto fragment = SWFragment {
+                .position = interpolate(triangle.position),
+                .normal = draw.flat_shaded ? triangle.face_normal : interpolate(triangle.normal),
+                .uv = interpolate(triangle.uv),
+                .color = interpolate(triangle.color),
+                .front_facing = triangle.front_facing
+            };
+
+            const auto pixel = row + static_cast<std::size_t>(x0 + i);
+            auto color = ShadeFragment(draw, fragment);
+            if (draw.blending != Blending::None) {
+                color = blend(draw.blending, color, unpack(color_[pixel]));
+            }
+
+            color_[pixel] = pack(color);
+            if (depth_write) depth_[pixel] = z_span[i];
+        }
+    }
+}
+
+auto SWRasterizer::Pixels() const -> std::span<const uint8_t> {
+    return {reinterpret_cast<const uint8_t*>(color_.data()), color_.size() * sizeof(uint32_t)};
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/core/job_system.hpp"
+#include "gleam/math/color.hpp"
+#include "gleam/math/vector2.hpp"
+#include "gleam/math/vector3.hpp"
+#include "gleam/math/vector4.hpp"
+
+#include "renderer/software/sw_shading.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gleam {
+
+// Tiled triangle rasterizer. Triangles are set up per draw, which is safe to
+// do from several threads as long as each draw is set up by a single one.
+// Rasterize() then bins them into screen tiles and processes the tiles in
+// parallel. Every tile draws its triangles in submission order, so depth
+// ties and blending resolve the same way they do on the GPU.
+//
+// The framebuffer follows GL conventions: the first row is the bottom of the
+// image, depth ranges from 0 to 1, and the depth test passes on less.
+class SWRasterizer {
+public:
+    static constexpr auto kTileSize = 64;
+
+    // Output of the vertex stage. Attributes are in view space.
+    struct Vertex {
+        Vector4 clip {0.0f};
+        Vector3 position {0.0f};
+        Vector3 normal {0.0f};
+        Vector2 uv {0.0f};
+        Vector3 color {1.0f};
+    };
+
+    SWRasterizer(int width, int height, JobSystem* jobs);
+
+    auto Clear(const Color& color) -> void;
+
+    // Starts a frame with the given draws. The draws must stay alive
+    // and unchanged until Rasterize() returns.
+    auto Begin(std::span<const SWDraw> draws) -> void;
+
+    auto AddTriangles(
+        std::size_t draw,
+        std::span<const Vertex> vertices,
+        std::span<const unsigned int> indices
+    ) -> void;
+
+    auto Rasterize() -> void;
+
+    // RGBA8 pixels, starting at the bottom row
+    [[nodiscard]] auto Pixels() const -> std::span<const uint8_t>;
+
+    [[nodiscard]] auto Width() const { return width_; }
+
+    [[nodiscard]] auto Height() const { return height_; }
+
+    // Triangles that reached the raster stage in the last frame,
+    // after culling and clipping.
+    [[nodiscard]] auto TriangleCount() const { return triangles_.size(); }
+
+private:
+    // Screen-space triangle with attributes premultiplied by 1/w,
+    // so they can be interpolated with perspective correction.
+    struct Triangle {
+        std::array<Vector3, 3> screen {};
+        std::array<float, 3> inv_w {};
+        std::array<Vector3, 3> position {};
+        std::array<Vector3, 3> normal {};
+        std::array<Vector2, 3> uv {};
+        std::array<Vector3, 3> color {};
+        Vector3 face_normal {0.0f};
+        float depth_offset {0.0f};
+        uint32_t draw {0};
+        bool front_facing {true};
+    };
+
+    std::vector<uint32_t> color_;
+    std::vector<float> depth_;
+
+    std::span<const SWDraw> draws_;
+
+    std::vector<std::vector<Triangle>> draw_triangles_;
+
+    std::vector<Triangle> triangles_;
+
+    std::vector<std::vector<uint32_t>> bins_;
+
+    JobSystem* jobs_ {nullptr};
+
+    int width_ {0};
+    int height_ {0};
+
+    int tiles_x_ {0};
+    int tiles_y_ {0};
+
+    auto SetupTriangle(std::size_t draw, const Vertex& a, const Vertex& b, const Vertex& c) -> void;
+
+    auto Bin() -> void;
+
+    auto RasterizeTile(int tile) -> void;
+
+    auto RasterizeTriangle(const Triangle& triangle, int x0, int y0, int x1, int y1) -> void;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,344 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/software/sw_renderer_impl.hpp"
+
+#include "gleam/geometries/geometry.hpp"
+#include "gleam/materials/phong_material.hpp"
+#include "gleam/materials/unlit_material.hpp"
+#include "gleam/nodes/fog.hpp"
+#include "gleam/textures/texture_array.hpp"
+
+#include "utilities/logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace gleam {
+
+namespace {
+
+auto to_vector(const Color& color) {
+    return Vector3 {color.r, color.g, color.b};
+}
+
+auto to_texture(const Texture2D* texture, float layer) {
+    if (texture == nullptr || texture->data.empty()) return SWTexture {};
+    auto data = texture->data.data();
+
+    // Layers are stored one after the other, and clamped to the array like in GL
+    if (texture->GetType() == TextureType::TextureArray) {
+        const auto last = static_cast<float>(static_cast<const TextureArray*>(texture)->layers - 1);
+        const auto index = static_cast<std::size_t>(std::clamp(std::round(layer), 0.0f, last));
+        data += index * texture->width * texture->height * 4;
+    }
+
+    return SWTexture {
+        .data = data,
+        .width = static_cast<int>(texture->width),
+        .height = static_cast<int>(texture->height)
+    };
+}
+
+auto is_supported(Renderable* renderable) {
+    const auto material = renderable->GetMaterial().get();
+    const auto type = material->GetType();
+    return
+        (type == MaterialType::PhongMaterial || type == MaterialType::UnlitMaterial) &&
+        renderable->GetGeometry()->primitive == GeometryPrimitiveType::Triangles &&
+        !material->wireframe;
+}
+
+// Offsets of the vertex attributes in the interleaved vertex data, in floats,
+// or -1 for attributes the geometry doesn't have.
+struct VertexLayout {
+    int position {-1};
+    int normal {-1};
+    int uv {-1};
+    int color {-1};
+    std::size_t stride {0};
+};
+
+auto vertex_layout(const Geometry* geometry) {
+    auto layout = VertexLayout {};
+    auto offset = 0;
+    for (const auto& attribute : geometry->Attributes()) {
+        switch (attribute.type) {
+            case VertexAttributeType::Position: layout.position = offset; break;
+            case VertexAttributeType::Normal: layout.normal = offset; break;
+            case VertexAttributeType::UV: layout.uv = offset; break;
+            case VertexAttributeType::Color: layout.color = offset; break;
+            default: break;
+        }
+        offset += static_cast<int>(attribute.item_size);
+    }
+    layout.stride = static_cast<std::size_t>(offset);
+    return layout;
+}
+
+}
+
+Renderer::SoftwareImpl::SoftwareImpl(const Renderer::Parameters& params)
+  : Renderer::Impl(params),
+    rasterizer_(params.width, params.height, params.jobs) {}
+
+auto Renderer::SoftwareImpl::Submit() -> void {
+    rasterizer_.Clear(clear_color_);
+    draws_.clear();
+    sources_.clear();
+
+    const auto& frame = FrontFrame();
+    if (frame.scene != nullptr) {
+        const auto& render_lists = frame.render_lists;
+
+        if (const auto fog = frame.scene->fog.get()) {
+            fog_.type = std::to_underlying(fog->GetType());
+            fog_.color = to_vector(fog->color);
+            if (fog->GetType() == FogType::LinearFog) {
+                fog_.near = static_cast<const LinearFog*>(fog)->near;
+                fog_.far = static_cast<const LinearFog*>(fog)->far;
+            }
+            if (fog->GetType() == FogType::ExponentialFog) {
+                fog_.density = static_cast<const ExponentialFog*>(fog)->density;
+            }
+        }
+
+        // Object indices follow the submission order of the GL backend
+        auto object_index = std::size_t {0};
+        // Draws sample a single texture layer, so batches of materials that
+        // differ in their layer are split into runs of instances sharing one.
+        const auto layers = render_lists.InstanceLayers();
+        for (const auto& batch : render_lists.OpaqueBatches()) {
+            auto first = batch.first_instance;
+            const auto end = first + batch.instance_count;
+            while (first < end) {
+                auto last = first + 1;
+                while (last < end && layers[last] == layers[first]) ++last;
+                AddDraw(batch.renderable, object_index, first, last - first, frame, layers[first]);
+                first = last;
+            }
+            if (batch.instance_count == 0) {
+                AddDraw(batch.renderable, object_index, 0, 0, frame);
+            }
+            ++object_index;
+        }
+        for (auto renderable : render_lists.Transparent()) {
+            AddDraw(renderable, object_index++, 0, 0, frame);
+        }
+    }
+
+    rasterizer_.Begin(draws_);
+    if (vertices_.size() < draws_.size()) vertices_.resize(draws_.size());
+
+    const auto process = [&](std::size_t begin, std::size_t end) {
+        for (auto draw = begin; draw < end; ++draw) ProcessVertices(draw, frame);
+    };
+    if (params_.jobs != nullptr) {
+        params_.jobs->ParallelFor(draws_.size(), 1, process);
+    } else {
+        process(0, draws_.size());
+    }
+
+    rasterizer_.Rasterize();
+
+    auto rendered_objects = std::size_t {0};
+    for (const auto& source : sources_) {
+        rendered_objects += source.instancing && source.instance_count > 0 ? source.instance_count : 1;
+    }
+    rendered_objects_per_frame_ = rendered_objects;
+
+    if (on_frame_captured_) Capture();
+
+    ++submitted_frames_;
+}
+
+auto Renderer::SoftwareImpl::AddDraw(
+    Renderable* renderable,
+    std::size_t object_index,
+    std::size_t first_instance,
+    std::size_t instance_count,
+    const Frame& frame,
+    float layer_offset
+) -> void {
+    if (!is_supported(renderable)) {
+        if (!warned_unsupported_) {
+            Logger::Log(LogLevel::Warning, "Software renderer skips lines, wireframes, sprites and shader materials");
+            warned_unsupported_ = true;
+        }
+        return;
+    }
+
+    const auto& lights = frame.lights;
+    const auto batched = instance_count > 0;
+    const auto attrs = ProgramAttributes {renderable, {
+        .directional = lights.directional,
+        .clustered = lights.HasLocalLights()
+    }, frame.scene, batched};
+
+    auto material = renderable->GetMaterial().get();
+    auto draw = SWDraw {
+        .type = attrs.type,
+        .opacity = material->opacity,
+        .lights = &lights,
+        .fog = attrs.fog ? &fog_ : nullptr,
+        .blending = material->transparent ? material->blending : Blending::None,
+        .polygon_offset_factor = material->polygon_offset_factor,
+        .polygon_offset_units = material->polygon_offset_units,
+        .cull_back_faces = !attrs.two_sided,
+        .depth_test = material->depth_test,
+        .depth_write = !material->transparent,
+        .flat_shaded = attrs.flat_shaded,
+        .two_sided = attrs.two_sided
+    };
+
+    auto source = DrawSource {
+        .renderable = renderable,
+        .model = frame.render_lists.Transforms()[object_index],
+        .first_instance = first_instance,
+        .instance_count = instance_count,
+        .instancing = attrs.instancing,
+        .vertex_color = attrs.vertex_color
+    };
+
+    const auto& state = frame.render_lists.DrawStates()[object_index];
+    if (state.instance_data >= 0) {
+        source.instances = &frame.render_lists.Instances()[state.instance_data];
+    }
+
+    if (attrs.type == MaterialType::PhongMaterial) {
+        auto m = static_cast<PhongMaterial*>(material);
+        draw.color = to_vector(m->color);
+        draw.specular = to_vector(m->specular);
+        draw.shininess = m->shininess;
+        const auto layer = static_cast<float>(m->texture_layer) + layer_offset;
+        if (attrs.albedo_map) draw.albedo_map = to_texture(m->albedo_map.get(), layer);
+        if (attrs.alpha_map) draw.alpha_map = to_texture(m->alpha_map.get(), layer);
+        if (m->albedo_map) source.texture_transform = m->albedo_map->GetTransform();
+    }
+
+    if (attrs.type == MaterialType::UnlitMaterial) {
+        auto m = static_cast<UnlitMaterial*>(material);
+        draw.color = to_vector(m->color);
+        const auto layer = static_cast<float>(m->texture_layer) + layer_offset;
+        if (attrs.albedo_map) draw.albedo_map = to_texture(m->albedo_map.get(), layer);
+        if (attrs.alpha_map) draw.alpha_map = to_texture(m->alpha_map.get(), layer);
+        if (m->albedo_map) source.texture_transform = m->albedo_map->GetTransform();
+    }
+
+    draws_.emplace_back(draw);
+    sources_.emplace_back(source);
+}
+
+auto Renderer::SoftwareImpl::ProcessVertices(std::size_t draw, const Frame& frame) -> void {
+    const auto& source = sources_[draw];
+    const auto renderable = source.renderable;
+    const auto geometry = renderable->GetGeometry().get();
+    const auto layout = vertex_layout(geometry);
+    const auto vertex_count = geometry->VertexCount();
+    if (layout.position < 0 || vertex_count == 0) return;
+
+    const auto& data = geometry->VertexData();
+    const auto& indices = geometry->IndexData();
+    const auto& render_lists = frame.render_lists;
+    auto& vertices = vertices_[draw];
+    vertices.resize(vertex_count);
+
+    const auto transform = [&](const Matrix4& model, const Matrix3& normal_matrix, const Vector3& color) {
+        const auto model_view = frame.view * model;
+        for (auto i = std::size_t {0}; i < vertex_count; ++i) {
+            const auto* v = data.data() + i * layout.stride;
+            auto& out = vertices[i];
+
+            const auto position = model_view * Vector4 {v[layout.position], v[layout.position + 1], v[layout.position + 2], 1.0f};
+            out.position = {position.x, position.y, position.z};
+            out.clip = frame.projection * position;
+            out.normal = layout.normal >= 0
+                ? Normalize(normal_matrix * Vector3 {v[layout.normal], v[layout.normal + 1], v[layout.normal + 2]})
+                : Vector3 {0.0f};
+            if (layout.uv >= 0) {
+                const auto uv = source.texture_transform * Vector3 {v[layout.uv], v[layout.uv + 1], 1.0f};
+                out.uv = {uv.x, uv.y};
+            }
+            out.color = color;
+            if (source.vertex_color && layout.color >= 0) {
+                out.color *= Vector3 {v[layout.color], v[layout.color + 1], v[layout.color + 2]};
+            }
+        }
+        rasterizer_.AddTriangles(draw, vertices, indices);
+    };
+
+    // The normal matrix of the object is applied before the view rotation,
+    // and the instance's after it, as in vert_main_varyings.glsl.
+    const auto view_normal = Matrix3(frame.view) * NormalMatrix(source.model);
+
+    if (source.instance_count > 0) {
+        const auto transforms = render_lists.InstanceTransforms();
+        const auto normals = render_lists.InstanceNormals();
+        for (auto i = source.first_instance; i < source.first_instance + source.instance_count; ++i) {
+            transform(source.model * transforms[i], view_normal * normals[i], Vector3 {1.0f});
+        }
+        return;
+    }
+
+    if (source.instances != nullptr) {
+        const auto& instances = *source.instances;
+        for (auto i = std::size_t {0}; i < instances.transforms.size(); ++i) {
+            transform(
+                source.model * instances.transforms[i],
+                view_normal * instances.normals[i],
+                to_vector(instances.colors[i])
+            );
+        }
+        return;
+    }
+
+    transform(source.model, view_normal, Vector3 {1.0f});
+}
+
+auto Renderer::SoftwareImpl::Capture() -> void {
+    const auto pixels = rasterizer_.Pixels();
+    auto captured = CapturedFrame {
+        .frame = submitted_frames_,
+        .width = rasterizer_.Width(),
+        .height = rasterizer_.Height(),
+        .pixels = {pixels.begin(), pixels.end()}
+    };
+
+    // Frames are read from memory right after they're drawn,
+    // so captures have no latency and are never dropped.
+    ++capture_stats_.captured;
+    const auto elapsed = capture_timer_.GetElapsedSeconds();
+    if (elapsed > 0.0) {
+        capture_stats_.frames_per_second = static_cast<double>(capture_stats_.captured) / elapsed;
+    }
+
+    on_frame_captured_(std::move(captured));
+}
+
+auto Renderer::SoftwareImpl::SetClearColor(const Color& color) -> void {
+    clear_color_ = color;
+}
+
+auto Renderer::SoftwareImpl::StartCapture(const OnFrameCaptured& callback) -> void {
+    on_frame_captured_ = callback;
+    capture_stats_ = {};
+    capture_timer_.Start();
+}
+
+auto Renderer::SoftwareImpl::StopCapture() -> void {
+    on_frame_captured_ = nullptr;
+}
+
+auto Renderer::SoftwareImpl::CaptureStats() const -> FrameCaptureStats {
+    return capture_stats_;
+}
+
+Renderer::SoftwareImpl::~SoftwareImpl() = default;
+
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "core/renderer_impl.hpp"
+
+#include "gleam/core/timer.hpp"
+#include "gleam/math/color.hpp"
+#include "gleam/math/matrix3.hpp"
+#include "gleam/math/matrix4.hpp"
+#include "gleam/nodes/renderable.hpp"
+
+#include "core/program_attributes.hpp"
+
+#include "renderer/software/sw_rasterizer.hpp"
+#include "renderer/software/sw_shading.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace gleam {
+
+// Renders on the CPU, for machines without a GPU. Draws go through the same
+// render lists as the GL backend, and the unlit and phong shaders are ported
+// to C++ (see ShadeFragment). Vertices are processed in parallel per draw and
+// pixels per screen tile. Lines, wireframes, sprites and shader materials
+// aren't supported and are skipped.
+//
+// There is no window surface to present to, so frames are only available
+// through StartCapture(), which delivers every frame as soon as it's drawn.
+class Renderer::SoftwareImpl : public Renderer::Impl {
+public:
+    explicit SoftwareImpl(const Renderer::Parameters& params);
+
+    auto Submit() -> void override;
+
+    auto SetClearColor(const Color& color) -> void override;
+
+    auto StartCapture(const OnFrameCaptured& callback) -> void override;
+
+    auto StopCapture() -> void override;
+
+    [[nodiscard]] auto CaptureStats() const -> FrameCaptureStats override;
+
+    ~SoftwareImpl() override;
+
+private:
+    // Inputs of the vertex stage of a draw
+    struct DrawSource {
+        Renderable* renderable {nullptr};
+        Matrix4 model {1.0f};
+        Matrix3 texture_transform {1.0f};
+        std::size_t first_instance {0};
+        std::size_t instance_count {0};
+        const RenderLists::InstanceData* instances {nullptr};
+        bool instancing {false};
+        bool vertex_color {false};
+    };
+
+    SWRasterizer rasterizer_;
+
+    SWFog fog_;
+
+    Color clear_color_ {0x000000};
+
+    std::vector<SWDraw> draws_;
+
+    std::vector<DrawSource> sources_;
+
+    std::vector<std::vector<SWRasterizer::Vertex>> vertices_;
+
+    OnFrameCaptured on_frame_captured_;
+
+    FrameCaptureStats capture_stats_;
+
+    Timer capture_timer_ {false};
+
+    std::uint64_t submitted_frames_ {0};
+
+    bool warned_unsupported_ {false};
+
+    // The layer offset is added to the material's texture layer
+    auto AddDraw(
+        Renderable* renderable,
+        std::size_t object_index,
+        std::size_t first_instance,
+        std::size_t instance_count,
+        const Frame& frame,
+        float layer_offset = 0.0f
+    ) -> void;
+
+    auto ProcessVertices(std::size_t draw, const Frame& frame) -> void;
+
+    auto Capture() -> void;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "renderer/software/sw_shading.hpp"
+
+#include "gleam/math/utilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gleam {
+
+namespace {
+
+constexpr auto kInv255 = 1.0f / 255.0f;
+
+auto smoothstep(float edge0, float edge1, float x) {
+    const auto t = math::Clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+auto clamp(const Vector3& v) {
+    return Vector3 {
+        math::Clamp(v.x, 0.0f, 1.0f),
+        math::Clamp(v.y, 0.0f, 1.0f),
+        math::Clamp(v.z, 0.0f, 1.0f)
+    };
+}
+
+auto to_vector(const Color& color) {
+    return Vector3 {color.r, color.g, color.b};
+}
+
+auto texel(const SWTexture& texture, int x, int y) {
+    // Repeat wrapping
+    x %= texture.width;
+    y %= texture.height;
+    if (x < 0) x += texture.width;
+    if (y < 0) y += texture.height;
+
+    const auto p = texture.data + (static_cast<std::size_t>(y) * texture.width + x) * 4;
+    return Vector4 {
+        static_cast<float>(p[0]),
+        static_cast<float>(p[1]),
+        static_cast<float>(p[2]),
+        static_cast<float>(p[3])
+    };
+}
+
+auto phong_shading(
+    const SWDraw& draw,
+    const Vector3& light_dir,
+    const Vector3& light_color,
+    const Vector3& normal,
+    const Vector3& view_dir,
+    const Vector3& diffuse_color
+) {
+    const auto diffuse_factor = std::max(Dot(light_dir, normal), 0.0f);
+    auto output = light_color * diffuse_color * diffuse_factor;
+
+    // Lights facing away from the surface contribute no specular highlight
+    if (diffuse_factor > 0.0f) {
+        const auto halfway = Normalize(light_dir + view_dir);
+        const auto specular = std::pow(
+            std::max(Dot(halfway, normal), 0.0f),
+            std::max(draw.shininess, 1.0f)
+        );
+        output += light_color * draw.specular * specular;
+    }
+
+    return output;
+}
+
+auto attenuation(float dist, const Vector4& factors) {
+    constexpr auto floor = GLLights::kAttenuationFloor;
+    const auto denominator = factors.y + factors.z * dist + factors.w * dist * dist;
+    const auto factor = math::Clamp(1.0f / std::max(denominator, 0.01f), floor, 1.0f);
+    return (factor - floor) / (1.0f - floor);
+}
+
+// Every fragment loops over every light, there are no clusters to consult
+auto process_lights(
+    const SWDraw& draw,
+    const SWFragment& fragment,
+    const Vector3& normal,
+    const Vector3& diffuse_color
+) {
+    const auto view_dir = Normalize(fragment.position * -1.0f);
+    auto output = Vector3 {0.0f};
+
+    for (auto i = 0u; i < draw.lights->directional; ++i) {
+        const auto& light = draw.lights->lights.lights[i];
+        output += phong_shading(draw, light.direction, to_vector(light.color), normal, view_dir, diffuse_color);
+    }
+
+    for (const auto& light : draw.lights->local_lights) {
+        const auto position = Vector3 {light.position.x, light.position.y, light.position.z};
+        const auto direction = Vector3 {light.direction.x, light.direction.y, light.direction.z};
+        auto color = Vector3 {light.color.x, light.color.y, light.color.z};
+
+        const auto to_light = position - fragment.position;
+        const auto dist = to_light.Length();
+        const auto light_dir = Normalize(to_light);
+
+        if (light.position.w == 3.0f /* spot light */) {
+            const auto angle_cos = Dot(light_dir, direction);
+            if (angle_cos <= light.direction.w) continue;
+            color *= smoothstep(light.direction.w, light.attenuation.x, angle_cos);
+        }
+
+        output += phong_shading(draw, light_dir, color, normal, view_dir, diffuse_color) *
+            attenuation(dist, light.attenuation);
+    }
+
+    return output;
+}
+
+auto apply_fog(const SWFog& fog, Vector3& color, float depth) {
+    auto factor = 0.0f;
+    if (fog.type == 0) factor = smoothstep(fog.near, fog.far, depth);
+    if (fog.type == 1) factor = 1.0f - std::exp(-fog.density * fog.density * depth * depth);
+    color = Lerp(color, fog.color, factor);
+}
+
+}
+
+auto SWTexture::Sample(const Vector2& uv) const -> Vector4 {
+    // Texel centers are at half-integer coordinates, as in GL_LINEAR
+    const auto x = uv.x * static_cast<float>(width) - 0.5f;
+    const auto y = uv.y * static_cast<float>(height) - 0.5f;
+    const auto x0 = std::floor(x);
+    const auto y0 = std::floor(y);
+    const auto fx = x - x0;
+    const auto fy = y - y0;
+    const auto ix = static_cast<int>(x0);
+    const auto iy = static_cast<int>(y0);
+
+    const auto bottom = Lerp(texel(*this, ix, iy), texel(*this, ix + 1, iy), fx);
+    const auto top = Lerp(texel(*this, ix, iy + 1), texel(*this, ix + 1, iy + 1), fx);
+    return Lerp(bottom, top, fy) * kInv255;
+}
+
+auto ShadeFragment(const SWDraw& draw, const SWFragment& fragment) -> Vector4 {
+    auto diffuse_color = draw.color * fragment.color;
+    auto opacity = draw.opacity;
+
+    if (draw.albedo_map.data != nullptr) {
+        const auto sample = draw.albedo_map.Sample(fragment.uv);
+        diffuse_color *= Vector3 {sample.x, sample.y, sample.z};
+        opacity *= sample.w;
+    }
+
+    if (draw.alpha_map.data != nullptr) {
+        opacity *= draw.alpha_map.Sample(fragment.uv).x;
+    }
+
+    auto output_color = diffuse_color;
+    if (draw.type == MaterialType::PhongMaterial) {
+        auto normal = Normalize(fragment.normal);
+        if (draw.two_sided && !draw.flat_shaded && !fragment.front_facing) {
+            normal *= -1.0f;
+        }
+
+        output_color = diffuse_color * to_vector(draw.lights->ambient_light);
+        if (draw.lights->directional > 0 || draw.lights->HasLocalLights()) {
+            output_color += process_lights(draw, fragment, normal, diffuse_color);
+            output_color = clamp(output_color);
+        }
+    }
+
+    if (draw.fog != nullptr) {
+        apply_fog(*draw.fog, output_color, -fragment.position.z);
+    }
+
+    output_color = clamp(output_color);
+    return {output_color.x, output_color.y, output_color.z, math::Clamp(opacity, 0.0f, 1.0f)};
+}
+
+}
\ No newline at end of file
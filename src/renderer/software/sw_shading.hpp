@@ -0,0 +1,80 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#pragma once
+
+#include "gleam/materials/material.hpp"
+#include "gleam/math/vector2.hpp"
+#include "gleam/math/vector3.hpp"
+#include "gleam/math/vector4.hpp"
+
+#include "renderer/gl/gl_lights.hpp"
+
+#include <cstdint>
+
+namespace gleam {
+
+// RGBA8 texture sampled with bilinear filtering and repeat wrapping,
+// which matches the sampler state of textures in the GL backend.
+struct SWTexture {
+    const uint8_t* data {nullptr};
+    int width {0};
+    int height {0};
+
+    [[nodiscard]] auto Sample(const Vector2& uv) const -> Vector4;
+};
+
+struct SWFog {
+    int type {0}; // 0 = linear, 1 = exponential
+    Vector3 color {Vector3::Zero()};
+    float near {0.0f};
+    float far {0.0f};
+    float density {0.0f};
+};
+
+// Per-draw inputs of the fragment stage, the native counterpart of
+// the uniforms and preprocessor flags of the unlit and phong shaders.
+struct SWDraw {
+    MaterialType type {MaterialType::UnlitMaterial};
+
+    Vector3 color {1.0f};
+    Vector3 specular {0.0f};
+    float opacity {1.0f};
+    float shininess {1.0f};
+
+    SWTexture albedo_map;
+    SWTexture alpha_map;
+
+    const GLLights::State* lights {nullptr};
+    const SWFog* fog {nullptr};
+
+    Blending blending {Blending::None};
+
+    float polygon_offset_factor {0.0f};
+    float polygon_offset_units {0.0f};
+
+    bool cull_back_faces {true};
+    bool depth_test {true};
+    bool depth_write {true};
+    bool flat_shaded {false};
+    bool two_sided {false};
+};
+
+// Interpolated varyings of a single fragment, in view space
+struct SWFragment {
+    Vector3 position;
+    Vector3 normal;
+    Vector2 uv;
+    Vector3 color;
+    bool front_facing {true};
+};
+
+// Returns the color and opacity of a fragment, as computed by the fragment
+// shaders in src/shaders. Flat shaded draws pass their face normal.
+[[nodiscard]] auto ShadeFragment(const SWDraw& draw, const SWFragment& fragment) -> Vector4;
+
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#version 410 core
+
+#extension GL_GOOGLE_include_directive : enable
+
+#pragma inject_attributes
+
+void main() {}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 410 core
+
+#extension GL_GOOGLE_include_directive : enable
+
+#pragma inject_attributes
+
+#include "snippets/vert_global_params.glsl"
+
+// Position-only variant of the material vertex shaders, used by the depth
+// pre-pass. The position is computed with the same expressions as in
+// vert_main_varyings.glsl, so that with invariant gl_Position both programs
+// produce the same depth for a vertex.
+void main() {
+    mat4 model_view = u_View * objectModel();
+
+    #ifdef USE_INSTANCING
+        model_view *= a_InstanceTransform;
+    #endif
+
+    gl_Position = u_Projection * (model_view * vec4(a_Position, 1.0));
+}
\ No newline at end of file
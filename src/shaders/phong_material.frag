@@ -9,13 +9,6 @@ precision mediump float;
 #include "snippets/frag_global_params.glsl"
 #include "snippets/frag_global_fog.glsl"
 
-struct PhongMaterial {
-    vec3 DiffuseColor;
-    vec3 SpecularColor;
-    float Shininess;
-};
-
-uniform PhongMaterial u_Material;
 uniform vec3 u_AmbientLight;
 
 vec3 phongShading(
@@ -32,17 +25,21 @@ vec3 phongShading(
     vec3 specular = vec3(0.0);
     if (diffuse_factor > 0.0) {
         vec3 halfway = normalize(light_dir + v_ViewDir);
-        specular = light_color * u_Material.SpecularColor *
-            pow(max(dot(halfway, normal), 0.0), max(u_Material.Shininess, 1.0));
+        specular = light_color * u_SpecularColor *
+            pow(max(dot(halfway, normal), 0.0), max(u_Shininess, 1.0));
     }
 
     return diffuse + specular;
 }
 
+#if NUM_OBJECT_LIGHTS > 0 || defined(USE_CLUSTERED_LIGHTS)
+    #define USE_LOCAL_LIGHTS
+#endif
+
 #if NUM_LIGHTS > 0
 
 struct Light {
-    int Type; // 1 = directional, 2 = point, 3 = spot
+    int Type; // 1 = directional
     vec3 Color;
     vec3 Position;
     vec3 Direction;
@@ -53,41 +50,99 @@ struct Light {
     float Quadratic;
 };
 
+// NUM_LIGHTS is the light count rounded up, lights past u_NumLights are unused
 layout(std140) uniform ub_Lights {
+    int u_NumLights;
     Light u_Lights[NUM_LIGHTS];
 };
 
-float attenuation(in float dist, in Light light) {
-    float denominator = light.Base +
-                        light.Linear * dist +
-                        light.Quadratic * (dist * dist);
-    return clamp(1.0 / max(denominator, 0.01), 0.02, 1.0);
-}
-
 vec3 processLights(const in vec3 normal, const in vec3 diffuse_color) {
     vec3 output_color = vec3(0.0);
     for (int i = 0; i < NUM_LIGHTS; i++) {
-        Light light = u_Lights[i];
-
-        if (light.Type == 1 /* directional light */) {
-            output_color += phongShading(light.Direction, light.Color, normal, diffuse_color);
-        }
-
-        if (light.Type == 2 /* point light */) {
-            vec3 light_dir = normalize(light.Position - v_Position.xyz);
-            float dist = length(light.Position - v_Position.xyz);
-            output_color += attenuation(dist, light) * phongShading(light_dir, light.Color, normal, diffuse_color);
-        }
-
-        if (light.Type == 3 /* spot light */) {
-            vec3 light_dir = normalize(light.Position - v_Position.xyz);
-            float dist = length(light.Position - v_Position.xyz);
-            float angle_cos = dot(light_dir, light.Direction);
-            if (angle_cos > light.ConeCos) {
-                vec3 spot_color = light.Color * smoothstep(light.ConeCos, light.PenumbraCos, angle_cos);
-                output_color += attenuation(dist, light) * phongShading(light_dir, spot_color, normal, diffuse_color);
-            }
-        }
+        if (i >= u_NumLights) break;
+        output_color += phongShading(u_Lights[i].Direction, u_Lights[i].Color, normal, diffuse_color);
+    }
+    return output_color;
+}
+
+#endif
+
+#ifdef USE_LOCAL_LIGHTS
+
+// Point and spot lights, four texels per light (see GLLights::BufferLight)
+uniform samplerBuffer u_LightData;
+
+// Light indices of the clusters, followed by the lights assigned to each draw
+uniform usamplerBuffer u_LightIndices;
+
+float attenuation(in float dist, in float base, in float linear, in float quadratic) {
+    float denominator = base + linear * dist + quadratic * (dist * dist);
+    float factor = clamp(1.0 / max(denominator, 0.01), 0.02, 1.0);
+
+    // Fades out to zero at the floor, which is the range the lights are assigned by
+    return (factor - 0.02) / 0.98;
+}
+
+vec3 processLocalLight(const in int index, const in vec3 normal, const in vec3 diffuse_color) {
+    int base = int(texelFetch(u_LightIndices, index).r) * 4;
+    vec4 position = texelFetch(u_LightData, base);
+    vec4 color = texelFetch(u_LightData, base + 1);
+    vec4 direction = texelFetch(u_LightData, base + 2);
+    vec4 factors = texelFetch(u_LightData, base + 3);
+
+    vec3 light_dir = normalize(position.xyz - v_Position.xyz);
+    float dist = length(position.xyz - v_Position.xyz);
+    vec3 light_color = color.rgb;
+
+    if (position.w == 3.0 /* spot light */) {
+        float angle_cos = dot(light_dir, direction.xyz);
+        if (angle_cos <= direction.w) return vec3(0.0);
+        light_color *= smoothstep(direction.w, factors.x, angle_cos);
+    }
+
+    float falloff = attenuation(dist, factors.y, factors.z, factors.w);
+    return falloff * phongShading(light_dir, light_color, normal, diffuse_color);
+}
+
+#endif
+
+#if NUM_OBJECT_LIGHTS > 0
+
+// Range of the draw's lights in u_LightIndices (see ObjectLights)
+uniform int u_ObjectLightOffset;
+uniform int u_ObjectLightCount;
+
+vec3 processObjectLights(const in vec3 normal, const in vec3 diffuse_color) {
+    vec3 output_color = vec3(0.0);
+    for (int i = 0; i < NUM_OBJECT_LIGHTS; i++) {
+        if (i >= u_ObjectLightCount) break;
+        output_color += processLocalLight(u_ObjectLightOffset + i, normal, diffuse_color);
+    }
+    return output_color;
+}
+
+#endif
+
+#ifdef USE_CLUSTERED_LIGHTS
+
+// Offset and count of every cluster's lights in u_LightIndices
+uniform usamplerBuffer u_LightClusters;
+
+layout(std140) uniform ub_Clusters {
+    vec4 u_ClusterScale; // tiles per pixel (xy), depth slice scale and bias (zw)
+    ivec4 u_ClusterGrid; // tiles (xy) and depth slices (z)
+};
+
+vec3 processClusteredLights(const in vec3 normal, const in vec3 diffuse_color) {
+    ivec2 tile = min(ivec2(gl_FragCoord.xy * u_ClusterScale.xy), u_ClusterGrid.xy - 1);
+    int slice = int(floor(log(v_ViewDepth) * u_ClusterScale.z + u_ClusterScale.w));
+    slice = clamp(slice, 0, u_ClusterGrid.z - 1);
+    int cluster = (slice * u_ClusterGrid.y + tile.y) * u_ClusterGrid.x + tile.x;
+    uvec2 range = texelFetch(u_LightClusters, cluster).xy;
+
+    vec3 output_color = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++) {
+        output_color += processLocalLight(int(range.x + i), normal, diffuse_color);
     }
     return output_color;
 }
@@ -97,7 +152,7 @@ vec3 processLights(const in vec3 normal, const in vec3 diffuse_color) {
 void main() {
     #include "snippets/frag_main_normal.glsl"
 
-    vec3 diffuse_color = u_Material.DiffuseColor;
+    vec3 diffuse_color = u_Color;
     float opacity = u_Opacity;
 
     #ifdef USE_INSTANCING
@@ -109,19 +164,30 @@ void main() {
     #endif
 
     #ifdef USE_ALBEDO_MAP
-        vec4 texture_sample = texture(u_AlbedoMap, v_TexCoord);
+        vec4 texture_sample = texture(u_AlbedoMap, ALBEDO_COORD);
         diffuse_color *= texture_sample.rgb;
         opacity *= texture_sample.a;
     #endif
 
     #ifdef USE_ALPHA_MAP
-        vec4 alpha_sample = texture(u_AlphaMap, v_TexCoord);
+        vec4 alpha_sample = texture(u_AlphaMap, ALPHA_COORD);
         opacity *= alpha_sample.r;
     #endif
 
     vec3 output_color = diffuse_color * u_AmbientLight;
     #if NUM_LIGHTS > 0
         output_color += processLights(normal, diffuse_color);
+    #endif
+
+    #if NUM_OBJECT_LIGHTS > 0
+        output_color += processObjectLights(normal, diffuse_color);
+    #endif
+
+    #ifdef USE_CLUSTERED_LIGHTS
+        output_color += processClusteredLights(normal, diffuse_color);
+    #endif
+
+    #if NUM_LIGHTS > 0 || defined(USE_LOCAL_LIGHTS)
         output_color = clamp(output_color, 0.0, 1.0);
     #endif
 
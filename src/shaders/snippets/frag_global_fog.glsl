@@ -15,15 +15,13 @@ applyFog function with the color and depth as arguments.
 
 #ifdef USE_FOG
 
-struct Fog {
+layout(std140) uniform ub_Fog {
     int Type; // 0 = linear, 1 = exponential
     vec3 Color;
     float Near;
     float Far;
     float Density;
-};
-
-uniform Fog u_Fog;
+} u_Fog;
 
 void applyFog(inout vec3 color, const in float depth) {
     float fog_factor = 0.0;
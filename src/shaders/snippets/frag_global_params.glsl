@@ -8,10 +8,15 @@ output color, varyings, and uniforms accessible within the fragment shader.
 @varying vec3 v_Normal - Normal vector (see frag_main_normal.glsl)
 @varying vec3 v_ViewDir - View direction vector
 @varying vec4 v_Position - Fragment position in view space
-@uniform vec3 u_Color - Base color of the fragment
-@uniform float u_Opacity - Fragment opacity
-@uniform sampler2D u_AlbedoMap - Base color texture map
-@uniform sampler2D u_AlphaMap - Opacity texture map
+@uniform vec3 u_Color - Base color of the fragment (ub_Material)
+@uniform float u_Opacity - Fragment opacity (ub_Material)
+@uniform vec3 u_SpecularColor - Specular color for lit materials (ub_Material)
+@uniform float u_Shininess - Specular exponent for lit materials (ub_Material)
+@uniform float u_TextureLayer - Layer sampled from texture array maps (ub_Material)
+@uniform sampler2D u_AlbedoMap - Base color texture map, or sampler2DArray
+@uniform sampler2D u_AlphaMap - Opacity texture map, or sampler2DArray
+@define ALBEDO_COORD - Coordinates to sample u_AlbedoMap with
+@define ALPHA_COORD - Coordinates to sample u_AlphaMap with
 
 */
 
@@ -31,7 +36,32 @@ in vec3 v_Normal;
 in vec3 v_ViewDir;
 in vec4 v_Position;
 
-uniform float u_Opacity;
-uniform vec3 u_Color;
-uniform sampler2D u_AlbedoMap;
-uniform sampler2D u_AlphaMap;
\ No newline at end of file
+#ifdef USE_TEXTURE_LAYER
+    flat in float v_TexLayer;
+#endif
+
+#ifdef USE_ALBEDO_ARRAY
+    uniform sampler2DArray u_AlbedoMap;
+    #define ALBEDO_COORD vec3(v_TexCoord, v_TexLayer)
+#else
+    uniform sampler2D u_AlbedoMap;
+    #define ALBEDO_COORD v_TexCoord
+#endif
+
+#ifdef USE_ALPHA_ARRAY
+    uniform sampler2DArray u_AlphaMap;
+    #define ALPHA_COORD vec3(v_TexCoord, v_TexLayer)
+#else
+    uniform sampler2D u_AlphaMap;
+    #define ALPHA_COORD v_TexCoord
+#endif
+
+// Must match the declaration in vert_global_params.glsl
+layout(std140) uniform ub_Material {
+    mat3 u_TextureTransform;
+    vec3 u_Color;
+    float u_Opacity;
+    vec3 u_SpecularColor;
+    float u_Shininess;
+    float u_TextureLayer;
+};
\ No newline at end of file
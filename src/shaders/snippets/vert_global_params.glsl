@@ -7,12 +7,17 @@ used in both the vertex and fragment shaders.
 @in vec3 a_Normal - Vertex normal
 @in vec2 a_TexCoord - Vertex texture coordinate
 @in mat4 a_InstanceTransform - Instance transformation matrix
-@uniform mat3 u_TextureTransform - Applies texture coordinate transformations
-@uniform mat4 u_Model - Model transformation matrix
+@in mat3 a_InstanceNormalMatrix - Instance normal matrix
+@in float a_InstanceLayer - Instance texture layer, added to u_TextureLayer
+@uniform mat3 u_TextureTransform - Applies texture coordinate transformations (ub_Material)
+@uniform float u_TextureLayer - Layer sampled from texture array maps (ub_Material)
+@uniform samplerBuffer u_ObjectData - Per-object model and normal matrices
+@uniform int u_ObjectIndex - Index of the current object in u_ObjectData
 @uniform mat4 u_Projection - Projection transformation matrix
 @uniform mat4 u_View - View transformation matrix
 @out float v_ViewDepth - Depth of the vertex in view space
 @out vec2 v_TexCoord - Transformed texture coordinates for the fragment shader
+@out float v_TexLayer - Layer of texture array maps for the fragment shader
 @out vec3 v_Normal - Transformed normal vector in view space
 @out vec3 v_ViewDir - View direction vector for lighting calculations
 @out vec4 v_Position - Vertex position in view space
@@ -25,6 +30,7 @@ in vec2 a_TexCoord;
 
 #ifdef USE_INSTANCING
     in mat4 a_InstanceTransform;
+    in mat3 a_InstanceNormalMatrix;
     in vec3 a_InstanceColor;
     out vec3 v_InstanceColor;
 #endif
@@ -34,8 +40,15 @@ in vec2 a_TexCoord;
     out vec3 v_Color;
 #endif
 
-uniform mat3 u_TextureTransform;
-uniform mat4 u_Model;
+#ifdef USE_TEXTURE_LAYER
+    #ifdef USE_INSTANCING
+        in float a_InstanceLayer;
+    #endif
+    flat out float v_TexLayer;
+#endif
+
+uniform samplerBuffer u_ObjectData;
+uniform int u_ObjectIndex;
 
 out float v_ViewDepth;
 out vec2 v_TexCoord;
@@ -43,7 +56,42 @@ out vec3 v_Normal;
 out vec3 v_ViewDir;
 out vec4 v_Position;
 
+// The depth pre-pass tests the color pass for equal depth, so positions
+// must not differ between programs that compute them the same way.
+invariant gl_Position;
+
 layout(std140) uniform ub_Camera {
     mat4 u_Projection;
     mat4 u_View;
-};
\ No newline at end of file
+};
+
+// Must match the declaration in frag_global_params.glsl
+layout(std140) uniform ub_Material {
+    mat3 u_TextureTransform;
+    vec3 u_Color;
+    float u_Opacity;
+    vec3 u_SpecularColor;
+    float u_Shininess;
+    float u_TextureLayer;
+};
+
+// Each object occupies seven texels in u_ObjectData: the columns
+// of its model matrix followed by those of its normal matrix.
+mat4 objectModel() {
+    int base = u_ObjectIndex * 7;
+    return mat4(
+        texelFetch(u_ObjectData, base),
+        texelFetch(u_ObjectData, base + 1),
+        texelFetch(u_ObjectData, base + 2),
+        texelFetch(u_ObjectData, base + 3)
+    );
+}
+
+mat3 objectNormalMatrix() {
+    int base = u_ObjectIndex * 7 + 4;
+    return mat3(
+        texelFetch(u_ObjectData, base).xyz,
+        texelFetch(u_ObjectData, base + 1).xyz,
+        texelFetch(u_ObjectData, base + 2).xyz
+    );
+}
\ No newline at end of file
@@ -6,10 +6,16 @@ and other global parameters shared between the vertex and fragment shaders.
 
 */
 
-mat4 model_view = u_View * u_Model;
+mat4 model = objectModel();
+mat4 model_view = u_View * model;
+
+// Normal matrices are computed on the CPU. The view transform is rigid,
+// so its rotation alone carries world-space normals into view space.
+mat3 normal_matrix = mat3(u_View) * objectNormalMatrix();
 
 #ifdef USE_INSTANCING
     model_view *= a_InstanceTransform;
+    normal_matrix *= a_InstanceNormalMatrix;
     v_InstanceColor = a_InstanceColor;
 #endif
 
@@ -17,7 +23,12 @@ mat4 model_view = u_View * u_Model;
     v_Color = a_Color;
 #endif
 
-mat3 normal_matrix = transpose(inverse(mat3(model_view)));
+#ifdef USE_TEXTURE_LAYER
+    v_TexLayer = u_TextureLayer;
+    #ifdef USE_INSTANCING
+        v_TexLayer += a_InstanceLayer;
+    #endif
+#endif
 
 v_Position = model_view * vec4(a_Position, 1.0);
 v_TexCoord = (u_TextureTransform * vec3(a_TexCoord, 1.0)).xy;
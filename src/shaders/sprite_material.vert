@@ -14,7 +14,7 @@ void main() {
     #include "snippets/vert_main_varyings.glsl"
 
     vec4 position = model_view[3];
-    vec2 scale = vec2(length(u_Model[0].xyz), length(u_Model[1].xyz));
+    vec2 scale = vec2(length(model[0].xyz), length(model[1].xyz));
 
     bool is_perspective = isPerspectiveMatrix(u_Projection);
     if (is_perspective) {
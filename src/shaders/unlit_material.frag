@@ -22,12 +22,12 @@ void main() {
     #endif
 
     #ifdef USE_ALBEDO_MAP
-        output_color *= texture(u_AlbedoMap, v_TexCoord).rgb;
-        opacity *= texture(u_AlbedoMap, v_TexCoord).a;
+        output_color *= texture(u_AlbedoMap, ALBEDO_COORD).rgb;
+        opacity *= texture(u_AlbedoMap, ALBEDO_COORD).a;
     #endif
 
     #ifdef USE_ALPHA_MAP
-        vec4 alpha_sample = texture(u_AlphaMap, v_TexCoord);
+        vec4 alpha_sample = texture(u_AlphaMap, ALPHA_COORD);
         opacity *= alpha_sample.r;
     #endif
 
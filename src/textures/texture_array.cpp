@@ -0,0 +1,67 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include "gleam/textures/texture_array.hpp"
+
+#include <algorithm>
+#include <format>
+#include <vector>
+
+namespace gleam {
+
+auto TextureArray::Pack(
+    std::span<const std::shared_ptr<Texture2D>> textures
+) -> std::expected<std::shared_ptr<TextureArray>, std::string> {
+    if (textures.empty()) {
+        return std::unexpected("A texture array needs at least one texture");
+    }
+
+    const auto& first = textures.front();
+    auto params = Parameters {
+        .width = first->width,
+        .height = first->height,
+        .layers = static_cast<unsigned>(textures.size()),
+        .mip_levels = first->mip_levels
+    };
+
+    for (auto i = std::size_t {0}; i < textures.size(); ++i) {
+        const auto& texture = textures[i];
+        if (texture->width != first->width || texture->height != first->height) {
+            return std::unexpected(std::format(
+                "Texture {} is {}x{}, expected {}x{} like the first texture",
+                i, texture->width, texture->height, first->width, first->height
+            ));
+        }
+
+        // Texture data is always RGBA8 (see asset_builder)
+        auto size = std::size_t {0};
+        for (auto level = 0u; level < texture->mip_levels; ++level) {
+            size += texture->MipLevelSize(level);
+        }
+        if (texture->data.size() != size) {
+            return std::unexpected(std::format("Texture {} has no RGBA8 data", i));
+        }
+
+        params.mip_levels = std::min(params.mip_levels, texture->mip_levels);
+    }
+
+    // Every layer of a mip level is stored before the next level, which is
+    // how a level of the array is specified, so each level is one upload.
+    auto offsets = std::vector<std::size_t>(textures.size(), 0);
+    for (auto level = 0u; level < params.mip_levels; ++level) {
+        const auto size = first->MipLevelSize(level);
+        for (auto i = std::size_t {0}; i < textures.size(); ++i) {
+            const auto begin = textures[i]->data.begin() + offsets[i];
+            params.data.insert(params.data.end(), begin, begin + size);
+            offsets[i] += size;
+        }
+    }
+
+    return Create(params);
+}
+
+}
\ No newline at end of file
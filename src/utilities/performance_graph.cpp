@@ -15,10 +15,14 @@ namespace gleam {
 
 auto PerformanceGraph::RenderGraph(const float viewport_width) const -> void {
     static const float kWindowWidth {250.0f};
-    static const float kWindowHeight {195.0f};
+    static const float kWindowHeight {212.0f};
+    static const float kLineHeight {17.0f};
 
 #ifdef GLEAM_USE_IMGUI
-    ImGui::SetNextWindowSize({kWindowWidth, kWindowHeight});
+    // Only shown when the depth pre-pass is enabled
+    const auto saved_fragments = saved_fragments_.LastValue() > 0.0f;
+
+    ImGui::SetNextWindowSize({kWindowWidth, kWindowHeight + (saved_fragments ? kLineHeight : 0.0f)});
     ImGui::SetNextWindowPos({viewport_width - kWindowWidth - 10.0f, 10.0f});
     ImGui::Begin("##Stats", nullptr,
         ImGuiWindowFlags_NoResize |
@@ -45,6 +49,14 @@ auto PerformanceGraph::RenderGraph(const float viewport_width) const -> void {
     );
     ImGui::PopStyleColor();
 
+    // frame time per stage
+    ImGui::Text(
+        "Update: %.1f Cull: %.1f Submit: %.1fms",
+        update_time_.LastValue(),
+        prepare_time_.LastValue(),
+        submit_time_.LastValue()
+    );
+
     // rendered objects
     ImGui::PushStyleColor(ImGuiCol_PlotHistogram, {0.20f, 0.40f, 0.70f, 1.0f});
     ImGui::Text("Rendered objects: %.0f", rendered_objects_.LastValue());
@@ -54,6 +66,11 @@ auto PerformanceGraph::RenderGraph(const float viewport_width) const -> void {
     );
     ImGui::PopStyleColor();
 
+    // fragments saved by the depth pre-pass
+    if (saved_fragments) {
+        ImGui::Text("Saved fragments: %.0f%%", saved_fragments_.LastValue());
+    }
+
     ImGui::End();
 #endif
 }
@@ -14,7 +14,11 @@ namespace gleam {
 enum class PerformanceMetric {
     FrameTime,
     FramesPerSecond,
-    RenderedObjects
+    RenderedObjects,
+    SavedFragments,
+    UpdateTime,
+    PrepareTime,
+    SubmitTime
 };
 
 class PerformanceGraph {
@@ -32,6 +36,18 @@ public:
         case RenderedObjects:
             rendered_objects_.Push(static_cast<float>(value));
             break;
+        case SavedFragments:
+            saved_fragments_.Push(static_cast<float>(value));
+            break;
+        case UpdateTime:
+            update_time_.Push(static_cast<float>(value));
+            break;
+        case PrepareTime:
+            prepare_time_.Push(static_cast<float>(value));
+            break;
+        case SubmitTime:
+            submit_time_.Push(static_cast<float>(value));
+            break;
         }
     }
 
@@ -41,6 +57,10 @@ private:
     DataSeries<float, 150> frame_time_;
     DataSeries<float, 150> frames_per_second_;
     DataSeries<float, 150> rendered_objects_;
+    DataSeries<float, 150> saved_fragments_;
+    DataSeries<float, 150> update_time_;
+    DataSeries<float, 150> prepare_time_;
+    DataSeries<float, 150> submit_time_;
 };
 
 }
\ No newline at end of file
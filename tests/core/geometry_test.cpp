@@ -93,6 +93,16 @@ TEST(Geometry, ReturnsFalseIfAttributeDoesNotExist) {
     EXPECT_FALSE(geometry->HasAttribute(UV));
 }
 
+TEST(Geometry, AddAttributeIncrementsVersion) {
+    auto geometry = gleam::Geometry::Create({
+        0.0f, 1.0f, 2.0f, 0.33f, 0.55f
+    });
+
+    const auto version = geometry->Version();
+    geometry->SetAttribute({.type = Position, .item_size = 3});
+    EXPECT_NE(geometry->Version(), version);
+}
+
 #pragma endregion
 
 #pragma region Vertex Count
@@ -159,6 +169,14 @@ TEST(Geometry, AddInternalAttributes) {
     EXPECT_DEATH({
         geometry->SetAttribute({.type = InstanceTransform, .item_size = 4});
     }, ".*attribute.type != InstanceTransform");
+
+    EXPECT_DEATH({
+        geometry->SetAttribute({.type = InstanceNormalMatrix, .item_size = 3});
+    }, ".*attribute.type != InstanceNormalMatrix");
+
+    EXPECT_DEATH({
+        geometry->SetAttribute({.type = InstanceLayer, .item_size = 1});
+    }, ".*attribute.type != InstanceLayer");
 }
 
 #pragma endregion
\ No newline at end of file
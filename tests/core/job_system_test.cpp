@@ -0,0 +1,155 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/core/job_system.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#pragma region Jobs
+
+TEST(JobSystem, RunsEveryJob) {
+    auto jobs = gleam::JobSystem {{.workers = 4}};
+    auto counter = gleam::JobSystem::Counter {};
+    auto calls = std::atomic<int> {0};
+
+    for (auto i = 0; i < 1000; ++i) {
+        jobs.Run([&calls]() { ++calls; }, &counter);
+    }
+    jobs.Wait(counter);
+
+    EXPECT_TRUE(counter.IsDone());
+    EXPECT_EQ(calls, 1000);
+}
+
+TEST(JobSystem, DefaultsToAtLeastOneWorker) {
+    auto jobs = gleam::JobSystem {};
+
+    EXPECT_GE(jobs.WorkerCount(), 1);
+}
+
+TEST(JobSystem, DependentJobRunsAfterDependency) {
+    auto jobs = gleam::JobSystem {{.workers = 4}};
+    auto first = gleam::JobSystem::Counter {};
+    auto second = gleam::JobSystem::Counter {};
+    auto finished = std::atomic<int> {0};
+    auto observed = std::atomic<int> {-1};
+
+    for (auto i = 0; i < 64; ++i) {
+        jobs.Run([&finished]() { ++finished; }, &first);
+    }
+    jobs.Run([&]() { observed = finished.load(); }, &second, &first);
+    jobs.Wait(second);
+
+    EXPECT_EQ(observed, 64);
+}
+
+TEST(JobSystem, NestedWaitDoesNotDeadlock) {
+    auto jobs = gleam::JobSystem {{.workers = 1}};
+    auto outer = gleam::JobSystem::Counter {};
+    auto calls = std::atomic<int> {0};
+
+    for (auto i = 0; i < 4; ++i) {
+        jobs.Run([&]() {
+            auto inner = gleam::JobSystem::Counter {};
+            for (auto j = 0; j < 8; ++j) {
+                jobs.Run([&calls]() { ++calls; }, &inner);
+            }
+            jobs.Wait(inner);
+        }, &outer);
+    }
+    jobs.Wait(outer);
+
+    EXPECT_EQ(calls, 32);
+}
+
+TEST(JobSystem, NestedWaitRunsDependenciesOnSingleWorker) {
+    auto jobs = gleam::JobSystem {{.workers = 1}};
+    auto order = std::vector<int> {};
+    auto outer = gleam::JobSystem::Counter {};
+
+    // The only worker waits, so the dependencies can only run inside Wait()
+    jobs.Run([&]() {
+        auto first = gleam::JobSystem::Counter {};
+        auto second = gleam::JobSystem::Counter {};
+        auto done = gleam::JobSystem::Counter {};
+        jobs.Run([&]() { order.push_back(1); }, &first);
+        jobs.Run([&]() { order.push_back(2); }, &second, &first);
+        jobs.Run([&]() { order.push_back(3); }, &done, &second);
+        jobs.Wait(done);
+    }, &outer);
+
+    // Not Wait(), which could run the outer job on this thread instead
+    while (!outer.IsDone()) std::this_thread::yield();
+
+    EXPECT_EQ(order, (std::vector<int> {1, 2, 3}));
+}
+
+TEST(JobSystem, WaitOnlyRunsJobsOfItsCounter) {
+    auto jobs = gleam::JobSystem {{.workers = 1}};
+    auto started = std::atomic<bool> {false};
+    auto release = std::atomic<bool> {false};
+    auto blocked = gleam::JobSystem::Counter {};
+    auto other = gleam::JobSystem::Counter {};
+    auto mine = gleam::JobSystem::Counter {};
+    auto other_ran = std::atomic<bool> {false};
+    auto mine_thread = std::thread::id {};
+
+    // Keeps the only worker busy, so queued jobs can only run on this thread
+    jobs.Run([&]() {
+        started = true;
+        while (!release) std::this_thread::yield();
+    }, &blocked);
+    while (!started) std::this_thread::yield();
+
+    jobs.Run([&]() { other_ran = true; }, &other);
+    jobs.RunBackground([&]() { other_ran = true; }, &other);
+    jobs.Run([&]() { mine_thread = std::this_thread::get_id(); }, &mine);
+    jobs.Wait(mine);
+
+    EXPECT_EQ(mine_thread, std::this_thread::get_id());
+    EXPECT_FALSE(other_ran);
+
+    release = true;
+    jobs.Wait(blocked);
+    jobs.Wait(other);
+    EXPECT_TRUE(other_ran);
+}
+
+#pragma endregion
+
+#pragma region Parallel For
+
+TEST(JobSystem, ParallelForVisitsEveryElementOnce) {
+    auto jobs = gleam::JobSystem {{.workers = 4}};
+    auto visits = std::vector<std::atomic<int>>(10007);
+
+    jobs.ParallelFor(visits.size(), 0, [&](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) ++visits[i];
+    });
+
+    for (const auto& visit : visits) {
+        EXPECT_EQ(visit, 1);
+    }
+}
+
+TEST(JobSystem, ParallelForRespectsGrain) {
+    auto jobs = gleam::JobSystem {{.workers = 2}};
+    auto chunks = std::atomic<int> {0};
+
+    jobs.ParallelFor(100, 30, [&](std::size_t begin, std::size_t end) {
+        EXPECT_LE(end - begin, 30);
+        ++chunks;
+    });
+
+    EXPECT_EQ(chunks, 4);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,107 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/cameras/perspective_camera.hpp>
+#include <gleam/core/job_system.hpp>
+#include <gleam/math/sphere.hpp>
+
+#include "core/light_clusters.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#pragma region Fixtures
+
+class LightClustersTest : public ::testing::Test {
+protected:
+    std::shared_ptr<gleam::PerspectiveCamera> camera = gleam::PerspectiveCamera::Create({
+        .fov = gleam::math::DegToRad(60.0f),
+        .aspect = 16.0f / 9.0f,
+        .near = 0.1f,
+        .far = 100.0f
+    });
+
+    auto Lights(const gleam::LightClusters& clusters, int x, int y, int slice) {
+        using gleam::LightClusters;
+        const auto cluster = clusters.Clusters()[(slice * LightClusters::kTilesY + y) * LightClusters::kTilesX + x];
+        const auto indices = clusters.Indices().subspan(cluster.offset, cluster.count);
+        return std::vector<uint32_t> {indices.begin(), indices.end()};
+    }
+};
+
+#pragma endregion
+
+#pragma region Binning
+
+TEST_F(LightClustersTest, LightIsBinnedIntoClustersAroundIt) {
+    auto clusters = gleam::LightClusters {};
+    const auto lights = std::vector<gleam::Sphere> {{{0.0f, 0.0f, -10.0f}, 0.5f}};
+
+    clusters.Build(lights, camera->projection_transform);
+
+    // The light sits on the corner between the four center tiles
+    const auto slice = clusters.Slice(10.0f);
+    EXPECT_EQ(Lights(clusters, 7, 4, slice), std::vector<uint32_t> {0});
+    EXPECT_EQ(Lights(clusters, 8, 4, slice), std::vector<uint32_t> {0});
+    EXPECT_TRUE(Lights(clusters, 0, 0, slice).empty());
+    EXPECT_TRUE(Lights(clusters, 7, 4, 0).empty());
+    EXPECT_LT(clusters.Indices().size(), 16);
+}
+
+TEST_F(LightClustersTest, LightsOutsideTheFrustumAreNotBinned) {
+    auto clusters = gleam::LightClusters {};
+    const auto lights = std::vector<gleam::Sphere> {
+        {{0.0f, 0.0f, 5.0f}, 1.0f},
+        {{0.0f, 0.0f, -500.0f}, 1.0f},
+        {{200.0f, 0.0f, -10.0f}, 1.0f}
+    };
+
+    clusters.Build(lights, camera->projection_transform);
+
+    EXPECT_TRUE(clusters.Indices().empty());
+}
+
+TEST_F(LightClustersTest, SlicesGrowExponentiallyWithDepth) {
+    auto clusters = gleam::LightClusters {};
+    clusters.Build({}, camera->projection_transform);
+
+    EXPECT_EQ(clusters.Slice(0.1f), 0);
+    EXPECT_EQ(clusters.Slice(100.0f), gleam::LightClusters::kSlices - 1);
+    EXPECT_LT(clusters.Slice(1.0f), clusters.Slice(10.0f));
+
+    // Equal depth ratios span the same number of slices, give or take rounding
+    EXPECT_NEAR(clusters.Slice(1.0f) - clusters.Slice(0.5f), clusters.Slice(20.0f) - clusters.Slice(10.0f), 1);
+}
+
+TEST_F(LightClustersTest, ParallelBinningMatchesSerial) {
+    auto jobs = gleam::JobSystem {{.workers = 3}};
+    auto serial = gleam::LightClusters {};
+    auto parallel = gleam::LightClusters {&jobs};
+
+    auto rng = std::mt19937 {7};
+    auto position = std::uniform_real_distribution<float> {-40.0f, 40.0f};
+    auto radius = std::uniform_real_distribution<float> {0.5f, 5.0f};
+    auto lights = std::vector<gleam::Sphere> {};
+    for (auto i = 0; i < 2000; ++i) {
+        lights.emplace_back(gleam::Vector3 {position(rng), position(rng), -std::abs(position(rng))}, radius(rng));
+    }
+
+    serial.Build(lights, camera->projection_transform);
+    parallel.Build(lights, camera->projection_transform);
+
+    ASSERT_FALSE(serial.Indices().empty());
+    EXPECT_TRUE(std::ranges::equal(serial.Indices(), parallel.Indices()));
+    EXPECT_TRUE(std::ranges::equal(serial.Clusters(), parallel.Clusters(), [](const auto& a, const auto& b) {
+        return a.offset == b.offset && a.count == b.count;
+    }));
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,146 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/core/job_system.hpp>
+#include <gleam/math/matrix4.hpp>
+#include <gleam/math/sphere.hpp>
+
+#include "core/object_lights.hpp"
+#include "core/program_attributes.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#pragma region Helpers
+
+namespace {
+
+auto assigned(const gleam::ObjectLights& lights, std::size_t object) {
+    const auto& assignment = lights.Assignments()[object];
+    const auto indices = lights.Indices().subspan(assignment.offset, assignment.count);
+    return std::vector<uint32_t> {indices.begin(), indices.end()};
+}
+
+}
+
+#pragma endregion
+
+#pragma region Assignment
+
+TEST(ObjectLights, AssignsLightsThatReachTheObject) {
+    auto lights = gleam::ObjectLights {};
+    const auto objects = std::vector<gleam::Sphere> {
+        {{0.0f, 0.0f, -10.0f}, 1.0f},
+        {{20.0f, 0.0f, -10.0f}, 1.0f}
+    };
+    const auto local = std::vector<gleam::Sphere> {
+        {{0.0f, 0.0f, -13.0f}, 2.5f},
+        {{0.0f, 0.0f, -14.0f}, 2.5f},
+        {{18.0f, 0.0f, -10.0f}, 1.5f}
+    };
+
+    lights.Assign(objects, gleam::Matrix4::Identity(), local);
+
+    EXPECT_EQ(assigned(lights, 0), std::vector<uint32_t> {0});
+    EXPECT_EQ(assigned(lights, 1), std::vector<uint32_t> {2});
+    EXPECT_FALSE(lights.HasClustered());
+}
+
+TEST(ObjectLights, TransformsObjectsIntoViewSpace) {
+    auto lights = gleam::ObjectLights {};
+    const auto objects = std::vector<gleam::Sphere> {{{0.0f, 0.0f, 0.0f}, 1.0f}};
+    const auto local = std::vector<gleam::Sphere> {{{0.0f, 0.0f, -10.0f}, 2.0f}};
+
+    lights.Assign(objects, gleam::Matrix4::Identity(), local);
+    EXPECT_TRUE(assigned(lights, 0).empty());
+
+    // A camera at z = 10 looking down the negative z-axis
+    lights.Assign(objects, gleam::Matrix4 {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, -10.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    }, local);
+    EXPECT_EQ(assigned(lights, 0), std::vector<uint32_t> {0});
+}
+
+TEST(ObjectLights, EmptyBoundsAreNeverLit) {
+    auto lights = gleam::ObjectLights {};
+    const auto objects = std::vector<gleam::Sphere> {{}};
+    const auto local = std::vector<gleam::Sphere> {{{0.0f, 0.0f, 0.0f}, 100.0f}};
+
+    lights.Assign(objects, gleam::Matrix4::Identity(), local);
+
+    EXPECT_EQ(lights.Assignments()[0].count, 0);
+    EXPECT_FALSE(lights.Assignments()[0].clustered);
+}
+
+TEST(ObjectLights, ObjectsReachedByTooManyLightsAreClustered) {
+    auto lights = gleam::ObjectLights {};
+    const auto objects = std::vector<gleam::Sphere> {{{0.0f, 0.0f, -10.0f}, 1.0f}};
+    auto local = std::vector<gleam::Sphere> {};
+    for (auto i = std::size_t {0}; i <= gleam::ObjectLights::kMaxLightsPerObject; ++i) {
+        local.emplace_back(gleam::Vector3 {0.0f, 0.0f, -10.0f}, 1.0f);
+    }
+
+    lights.Assign(objects, gleam::Matrix4::Identity(), local);
+
+    EXPECT_TRUE(lights.HasClustered());
+    EXPECT_TRUE(lights.Assignments()[0].clustered);
+    EXPECT_EQ(lights.Assignments()[0].count, 0);
+
+    local.pop_back();
+    lights.Assign(objects, gleam::Matrix4::Identity(), local);
+
+    EXPECT_FALSE(lights.HasClustered());
+    EXPECT_EQ(lights.Assignments()[0].count, gleam::ObjectLights::kMaxLightsPerObject);
+}
+
+TEST(ObjectLights, ParallelAssignmentMatchesSerial) {
+    auto jobs = gleam::JobSystem {{.workers = 3}};
+    auto serial = gleam::ObjectLights {};
+    auto parallel = gleam::ObjectLights {&jobs};
+
+    auto rng = std::mt19937 {11};
+    auto position = std::uniform_real_distribution<float> {-50.0f, 50.0f};
+    auto radius = std::uniform_real_distribution<float> {0.5f, 4.0f};
+    auto objects = std::vector<gleam::Sphere> {};
+    auto local = std::vector<gleam::Sphere> {};
+    for (auto i = 0; i < 1000; ++i) {
+        objects.emplace_back(gleam::Vector3 {position(rng), position(rng), position(rng)}, radius(rng));
+    }
+    for (auto i = 0; i < 300; ++i) {
+        local.emplace_back(gleam::Vector3 {position(rng), position(rng), position(rng)}, radius(rng));
+    }
+
+    serial.Assign(objects, gleam::Matrix4::Identity(), local);
+    parallel.Assign(objects, gleam::Matrix4::Identity(), local);
+
+    for (auto i = std::size_t {0}; i < objects.size(); ++i) {
+        EXPECT_EQ(assigned(serial, i), assigned(parallel, i));
+        EXPECT_EQ(serial.Assignments()[i].clustered, parallel.Assignments()[i].clustered);
+    }
+}
+
+#pragma endregion
+
+#pragma region Buckets
+
+TEST(ObjectLights, LightCountsAreRoundedUpToPowersOfTwo) {
+    using gleam::ProgramAttributes;
+
+    EXPECT_EQ(ProgramAttributes::LightBucket(0, 8), 0);
+    EXPECT_EQ(ProgramAttributes::LightBucket(1, 8), 1);
+    EXPECT_EQ(ProgramAttributes::LightBucket(3, 8), 4);
+    EXPECT_EQ(ProgramAttributes::LightBucket(5, 8), 8);
+    EXPECT_EQ(ProgramAttributes::LightBucket(9, 10), 10);
+}
+
+#pragma endregion
\ No newline at end of file
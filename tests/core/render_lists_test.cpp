@@ -0,0 +1,495 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/cameras/perspective_camera.hpp>
+#include <gleam/geometries/box_geometry.hpp>
+#include <gleam/geometries/plane_geometry.hpp>
+#include <gleam/lights/point_light.hpp>
+#include <gleam/materials/phong_material.hpp>
+#include <gleam/materials/unlit_material.hpp>
+#include <gleam/nodes/instanced_mesh.hpp>
+#include <gleam/nodes/mesh.hpp>
+#include <gleam/nodes/scene.hpp>
+#include <gleam/nodes/sprite.hpp>
+#include <gleam/textures/texture_array.hpp>
+
+#include "core/render_lists.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#pragma region Fixtures
+
+class RenderListsTest : public ::testing::Test {
+protected:
+    std::shared_ptr<gleam::Scene> scene = gleam::Scene::Create();
+
+    std::shared_ptr<gleam::PerspectiveCamera> camera = gleam::PerspectiveCamera::Create({
+        .fov = gleam::math::DegToRad(60.0f),
+        .aspect = 1.0f,
+        .near = 0.1f,
+        .far = 1000.0f
+    });
+
+    std::shared_ptr<gleam::BoxGeometry> geometry = gleam::BoxGeometry::Create();
+
+    gleam::JobSystem jobs {{.workers = 3}};
+
+    gleam::RenderLists render_lists {&jobs};
+
+    auto AddMesh(std::shared_ptr<gleam::Material> material, float z) {
+        auto mesh = gleam::Mesh::Create(geometry, material);
+        mesh->transform.SetPosition({0.0f, 0.0f, z});
+        scene->Add(mesh);
+        return mesh;
+    }
+
+    auto Process(gleam::RenderLists& lists) {
+        scene->UpdateTransformHierarchy();
+        camera->SetViewTransform();
+        lists.ProcessScene(scene.get(), camera.get());
+    }
+
+    auto Process() {
+        Process(render_lists);
+    }
+
+    static auto CountStateChanges(std::span<gleam::Renderable* const> list) {
+        auto changes = 0;
+        for (auto i = 1; i < list.size(); ++i) {
+            if (list[i]->GetMaterial() != list[i - 1]->GetMaterial()) ++changes;
+        }
+        return changes;
+    }
+};
+
+#pragma endregion
+
+#pragma region Opaque
+
+TEST_F(RenderListsTest, OpaqueGroupedByProgramAndMaterial) {
+    auto unlit_a = gleam::UnlitMaterial::Create();
+    auto unlit_b = gleam::UnlitMaterial::Create();
+    auto phong = gleam::PhongMaterial::Create();
+
+    for (auto i = 0; i < 12; ++i) {
+        const auto z = -2.0f - static_cast<float>(i);
+        if (i % 3 == 0) AddMesh(unlit_a, z);
+        if (i % 3 == 1) AddMesh(phong, z);
+        if (i % 3 == 2) AddMesh(unlit_b, z);
+    }
+
+    Process();
+
+    const auto opaque = render_lists.Opaque();
+    EXPECT_EQ(opaque.size(), 12);
+    EXPECT_EQ(CountStateChanges(opaque), 2);
+}
+
+TEST_F(RenderListsTest, OpaqueFrontToBackWithinState) {
+    auto material = gleam::UnlitMaterial::Create();
+    auto far = AddMesh(material, -20.0f);
+    auto near = AddMesh(material, -5.0f);
+    auto middle = AddMesh(material, -10.0f);
+
+    Process();
+
+    const auto opaque = render_lists.Opaque();
+    ASSERT_EQ(opaque.size(), 3);
+    EXPECT_EQ(opaque[0], near.get());
+    EXPECT_EQ(opaque[1], middle.get());
+    EXPECT_EQ(opaque[2], far.get());
+}
+
+#pragma endregion
+
+#pragma region Batching
+
+TEST_F(RenderListsTest, BatchesMeshesSharingGeometryAndMaterial) {
+    auto material = gleam::UnlitMaterial::Create();
+    for (auto i = 0; i < 8; ++i) {
+        AddMesh(material, -2.0f - static_cast<float>(i));
+    }
+
+    Process();
+
+    const auto batches = render_lists.OpaqueBatches();
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0].first_instance, 0);
+    EXPECT_EQ(batches[0].instance_count, 8);
+    EXPECT_EQ(render_lists.InstanceTransforms().size(), 8);
+    EXPECT_EQ(render_lists.InstanceNormals().size(), 8);
+}
+
+TEST_F(RenderListsTest, BatchInstancesFrontToBack) {
+    auto material = gleam::UnlitMaterial::Create();
+    AddMesh(material, -20.0f);
+    AddMesh(material, -5.0f);
+
+    Process();
+
+    const auto transforms = render_lists.InstanceTransforms();
+    ASSERT_EQ(transforms.size(), 2);
+    EXPECT_FLOAT_EQ(transforms[0](2, 3), -5.0f);
+    EXPECT_FLOAT_EQ(transforms[1](2, 3), -20.0f);
+}
+
+TEST_F(RenderListsTest, SplitsBatchesByMaterial) {
+    auto material_a = gleam::UnlitMaterial::Create();
+    auto material_b = gleam::UnlitMaterial::Create();
+    for (auto i = 0; i < 6; ++i) {
+        AddMesh(i % 2 ? material_a : material_b, -2.0f - static_cast<float>(i));
+    }
+
+    Process();
+
+    const auto batches = render_lists.OpaqueBatches();
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0].instance_count, 3);
+    EXPECT_EQ(batches[1].instance_count, 3);
+    EXPECT_EQ(batches[1].first_instance, 3);
+}
+
+TEST_F(RenderListsTest, DoesNotBatchSingleOrWireframeMeshes) {
+    auto single = gleam::UnlitMaterial::Create();
+    auto wireframe = gleam::UnlitMaterial::Create();
+    wireframe->wireframe = true;
+
+    AddMesh(single, -2.0f);
+    AddMesh(wireframe, -3.0f);
+    AddMesh(wireframe, -4.0f);
+
+    Process();
+
+    const auto batches = render_lists.OpaqueBatches();
+    ASSERT_EQ(batches.size(), 3);
+    for (const auto& batch : batches) {
+        EXPECT_EQ(batch.instance_count, 0);
+    }
+    EXPECT_TRUE(render_lists.InstanceTransforms().empty());
+}
+
+TEST_F(RenderListsTest, BatchesMaterialsThatOnlyDifferInTextureLayer) {
+    auto array = gleam::TextureArray::Create({
+        .width = 1,
+        .height = 1,
+        .layers = 4,
+        .data = std::vector<uint8_t>(16, 255)
+    });
+
+    auto tinted = gleam::UnlitMaterial::Create(0xFF0000);
+    tinted->albedo_map = array;
+    for (auto i = 0; i < 3; ++i) {
+        auto material = gleam::UnlitMaterial::Create();
+        material->albedo_map = array;
+        material->texture_layer = i + 1;
+        AddMesh(material, -2.0f - static_cast<float>(i));
+    }
+    AddMesh(tinted, -6.0f);
+
+    Process();
+
+    // Material keys are hashed, so the tinted mesh may sort on either side
+    const auto batches = render_lists.OpaqueBatches();
+    ASSERT_EQ(batches.size(), 2);
+    const auto batch = std::ranges::find_if(batches, [](const auto& b) {
+        return b.instance_count > 0;
+    });
+    ASSERT_NE(batch, batches.end());
+    EXPECT_EQ(batch->instance_count, 3);
+    EXPECT_EQ(batches[0].instance_count + batches[1].instance_count, 3);
+
+    // Layers are relative to the layer of the batch's material
+    const auto layers = render_lists.InstanceLayers();
+    ASSERT_EQ(layers.size(), 3);
+    EXPECT_FLOAT_EQ(layers[0], 0.0f);
+    EXPECT_FLOAT_EQ(layers[1], 1.0f);
+    EXPECT_FLOAT_EQ(layers[2], 2.0f);
+}
+
+TEST_F(RenderListsTest, KeepsMaterialsOnTheSameTextureArrayApart) {
+    auto array = gleam::TextureArray::Create({
+        .width = 1,
+        .height = 1,
+        .layers = 2,
+        .data = std::vector<uint8_t>(8, 255)
+    });
+
+    // Alternating in depth, so only the material keys keep each color together
+    for (auto i = 0; i < 6; ++i) {
+        auto material = gleam::UnlitMaterial::Create(i % 2 == 0 ? 0xFFFFFF : 0xFF0000);
+        material->albedo_map = array;
+        material->texture_layer = i / 2 % 2;
+        AddMesh(material, -2.0f - static_cast<float>(i));
+    }
+
+    Process();
+
+    const auto batches = render_lists.OpaqueBatches();
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0].instance_count, 3);
+    EXPECT_EQ(batches[1].instance_count, 3);
+}
+
+#pragma endregion
+
+#pragma region Transparent
+
+TEST_F(RenderListsTest, TransparentBackToFront) {
+    auto material_a = gleam::UnlitMaterial::Create();
+    auto material_b = gleam::PhongMaterial::Create();
+    material_a->transparent = true;
+    material_b->transparent = true;
+
+    auto near = AddMesh(material_a, -5.0f);
+    auto far = AddMesh(material_a, -20.0f);
+    auto middle = AddMesh(material_b, -10.0f);
+
+    Process();
+
+    const auto transparent = render_lists.Transparent();
+    ASSERT_EQ(transparent.size(), 3);
+    EXPECT_TRUE(render_lists.Opaque().empty());
+    EXPECT_EQ(transparent[0], far.get());
+    EXPECT_EQ(transparent[1], middle.get());
+    EXPECT_EQ(transparent[2], near.get());
+}
+
+#pragma endregion
+
+#pragma region Transforms
+
+TEST_F(RenderListsTest, TransformsFollowSubmissionOrder) {
+    auto batched = gleam::UnlitMaterial::Create();
+    auto single = gleam::PhongMaterial::Create();
+    auto transparent = gleam::UnlitMaterial::Create();
+    transparent->transparent = true;
+
+    AddMesh(batched, -2.0f);
+    AddMesh(batched, -3.0f);
+    auto single_mesh = AddMesh(single, -4.0f);
+    auto transparent_mesh = AddMesh(transparent, -5.0f);
+
+    Process();
+
+    const auto batches = render_lists.OpaqueBatches();
+    const auto transforms = render_lists.Transforms();
+    ASSERT_EQ(batches.size(), 2);
+    ASSERT_EQ(transforms.size(), 3);
+
+    for (auto i = 0; i < batches.size(); ++i) {
+        EXPECT_EQ(transforms[i], batches[i].instance_count > 0
+            ? gleam::Matrix4::Identity()
+            : single_mesh->GetWorldTransform()
+        );
+    }
+    EXPECT_EQ(transforms[2], transparent_mesh->GetWorldTransform());
+}
+
+TEST_F(RenderListsTest, TransformsAreCapturedWhenProcessed) {
+    auto material = gleam::UnlitMaterial::Create();
+    auto mesh = AddMesh(material, -5.0f);
+
+    Process();
+    const auto captured = mesh->GetWorldTransform();
+
+    mesh->transform.SetPosition({1.0f, 0.0f, -5.0f});
+    scene->UpdateTransformHierarchy();
+
+    ASSERT_EQ(render_lists.Transforms().size(), 1);
+    EXPECT_EQ(render_lists.Transforms()[0], captured);
+    EXPECT_NE(mesh->GetWorldTransform(), captured);
+}
+
+TEST_F(RenderListsTest, SpriteStateIsCapturedWhenProcessed) {
+    auto sprite = gleam::Sprite::Create();
+    sprite->anchor = {0.25f, 0.75f};
+    sprite->rotation = 1.0f;
+    sprite->transform.SetPosition({0.0f, 0.0f, -5.0f});
+    scene->Add(sprite);
+
+    Process();
+    sprite->anchor = {0.5f, 0.5f};
+    sprite->rotation = 2.0f;
+
+    ASSERT_EQ(render_lists.DrawStates().size(), 1);
+    const auto& state = render_lists.DrawStates()[0];
+    EXPECT_EQ(state.anchor, gleam::Vector2(0.25f, 0.75f));
+    EXPECT_FLOAT_EQ(state.rotation, 1.0f);
+    EXPECT_EQ(state.instance_data, -1);
+}
+
+TEST_F(RenderListsTest, InstanceDataIsCapturedWhenProcessed) {
+    auto copied = gleam::RenderLists {&jobs, true};
+    auto mesh = gleam::InstancedMesh::Create(geometry, gleam::UnlitMaterial::Create(), 2);
+    mesh->SetTransformAt(0, gleam::Matrix4::Identity());
+    mesh->SetTransformAt(1, gleam::Matrix4::Identity());
+    mesh->transform.SetPosition({0.0f, 0.0f, -5.0f});
+    scene->Add(mesh);
+
+    Process(copied);
+    mesh->SetColorAt(1, 0xFF0000);
+
+    ASSERT_EQ(copied.Instances().size(), 1);
+    const auto& data = copied.Instances()[copied.DrawStates()[0].instance_data];
+    EXPECT_EQ(data.mesh, mesh.get());
+    ASSERT_EQ(data.transforms.size(), 2);
+    EXPECT_EQ(data.colors[1], gleam::Color(0xFFFFFF));
+    const auto transforms_version = data.transforms_version;
+    const auto colors_version = data.colors_version;
+
+    // Only arrays that changed since the previous frame get a new version
+    Process(copied);
+    const auto& next = copied.Instances()[0];
+    EXPECT_EQ(next.transforms_version, transforms_version);
+    EXPECT_NE(next.colors_version, colors_version);
+    EXPECT_EQ(next.colors[1], gleam::Color(0xFF0000));
+}
+
+TEST_F(RenderListsTest, InstanceDataPointsToMeshWithoutCopies) {
+    auto mesh = gleam::InstancedMesh::Create(geometry, gleam::UnlitMaterial::Create(), 2);
+    mesh->transform.SetPosition({0.0f, 0.0f, -5.0f});
+    scene->Add(mesh);
+
+    Process();
+
+    ASSERT_EQ(render_lists.Instances().size(), 1);
+    const auto& data = render_lists.Instances()[0];
+    EXPECT_EQ(data.transforms.size(), 2);
+    mesh->SetColorAt(1, 0xFF0000);
+    EXPECT_EQ(data.colors[1], gleam::Color(0xFF0000));
+}
+
+#pragma endregion
+
+#pragma region Culling
+
+TEST_F(RenderListsTest, SkipsRenderablesOutsideFrustum) {
+    auto material = gleam::UnlitMaterial::Create();
+    AddMesh(material, -5.0f);
+    AddMesh(material, 5.0f);
+
+    Process();
+
+    EXPECT_EQ(render_lists.Opaque().size(), 1);
+}
+
+TEST_F(RenderListsTest, ParallelCullingMatchesSceneOrder) {
+    auto material_a = gleam::UnlitMaterial::Create();
+    auto material_b = gleam::UnlitMaterial::Create();
+    material_b->transparent = true;
+
+    // Meshes join the scene through a single group, since adding
+    // a node to the scene searches the whole hierarchy for it.
+    auto group = gleam::Node::Create();
+    const auto count = gleam::RenderLists::kMinParallelCandidates * 2;
+    for (auto i = std::size_t {0}; i < count; ++i) {
+        // Every fourth mesh is behind the camera
+        const auto z = i % 4 == 0 ? 5.0f : -2.0f - static_cast<float>(i) * 0.1f;
+        auto mesh = gleam::Mesh::Create(geometry, i % 2 ? material_a : material_b);
+        mesh->transform.SetPosition({0.0f, 0.0f, z});
+        group->Add(mesh);
+    }
+    scene->Add(group);
+
+    Process();
+
+    const auto opaque = render_lists.Opaque();
+    const auto transparent = render_lists.Transparent();
+    EXPECT_EQ(opaque.size(), count / 2);
+    EXPECT_EQ(transparent.size(), count / 4);
+
+    for (auto i = std::size_t {1}; i < opaque.size(); ++i) {
+        EXPECT_GE(opaque[i - 1]->GetWorldPosition().z, opaque[i]->GetWorldPosition().z);
+    }
+    for (auto i = std::size_t {1}; i < transparent.size(); ++i) {
+        EXPECT_LE(transparent[i - 1]->GetWorldPosition().z, transparent[i]->GetWorldPosition().z);
+    }
+}
+
+TEST_F(RenderListsTest, OccludersHideMeshesBehindThem) {
+    auto wall = gleam::Mesh::Create(
+        gleam::PlaneGeometry::Create({.width = 20.0f, .height = 20.0f}),
+        gleam::UnlitMaterial::Create()
+    );
+    wall->transform.SetPosition({0.0f, 0.0f, -3.0f});
+    scene->Add(wall);
+
+    auto material = gleam::UnlitMaterial::Create();
+    auto hidden = AddMesh(material, -10.0f);
+    auto in_front = AddMesh(material, -1.5f);
+
+    Process();
+    EXPECT_EQ(render_lists.Opaque().size(), 3);
+
+    wall->occluder = true;
+    Process();
+
+    const auto opaque = render_lists.Opaque();
+    EXPECT_EQ(opaque.size(), 2);
+    EXPECT_EQ(std::ranges::count(opaque, hidden.get()), 0);
+    EXPECT_EQ(std::ranges::count(opaque, in_front.get()), 1);
+}
+
+TEST_F(RenderListsTest, PartiallyOccludedMeshesAreKept) {
+    auto wall = gleam::Mesh::Create(
+        gleam::PlaneGeometry::Create({.width = 2.0f, .height = 2.0f}),
+        gleam::UnlitMaterial::Create()
+    );
+    wall->transform.SetPosition({-1.0f, 0.0f, -3.0f});
+    wall->occluder = true;
+    scene->Add(wall);
+
+    // Straddles the wall's right edge
+    auto mesh = AddMesh(gleam::UnlitMaterial::Create(), -10.0f);
+    mesh->transform.SetPosition({0.5f, 0.0f, -10.0f});
+
+    Process();
+
+    EXPECT_EQ(std::ranges::count(render_lists.Opaque(), mesh.get()), 1);
+}
+
+TEST_F(RenderListsTest, MeshesPeekingPastOccluderWithinATexelAreKept) {
+    // The wall's right edge ends 0.6 texels into a column of the culling
+    // buffer, so the center of that column is behind the wall.
+    auto wall = gleam::Mesh::Create(
+        gleam::PlaneGeometry::Create({.width = 2.0f, .height = 2.0f}),
+        gleam::UnlitMaterial::Create()
+    );
+    wall->transform.SetPosition({-0.991881f, 0.0f, -3.0f});
+    wall->occluder = true;
+    scene->Add(wall);
+
+    // Spans 0.31 to 0.69 of the same column, so it peeks out past the edge
+    auto mesh = gleam::Mesh::Create(
+        gleam::BoxGeometry::Create({.width = 0.01f, .height = 0.01f, .depth = 0.01f}),
+        gleam::UnlitMaterial::Create()
+    );
+    mesh->transform.SetPosition({0.022553f, 0.045105f, -10.0f});
+    scene->Add(mesh);
+
+    Process();
+
+    EXPECT_EQ(std::ranges::count(render_lists.Opaque(), mesh.get()), 1);
+}
+
+TEST_F(RenderListsTest, CollectsLights) {
+    scene->Add(gleam::PointLight::Create({
+        .color = 0xFFFFFF,
+        .intensity = 1.0f,
+        .attenuation = {}
+    }));
+
+    Process();
+
+    EXPECT_EQ(render_lists.Lights().size(), 1);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,62 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/geometries/box_geometry.hpp>
+#include <gleam/materials/phong_material.hpp>
+#include <gleam/materials/shader_material.hpp>
+#include <gleam/nodes/mesh.hpp>
+#include <gleam/nodes/scene.hpp>
+
+#include "core/shader_library.hpp"
+
+#include <memory>
+#include <string>
+
+#pragma region Built-in Shaders
+
+TEST(ShaderLibrary, BuiltInShadersAreFlattenedAtBuildTime) {
+    auto scene = gleam::Scene::Create();
+    auto mesh = gleam::Mesh::Create(gleam::BoxGeometry::Create(), gleam::PhongMaterial::Create());
+    const auto attrs = gleam::ProgramAttributes {mesh.get(), {.directional = 2}, scene.get()};
+
+    const auto shaders = gleam::ShaderLibrary {}.GetShaderSource(attrs);
+
+    ASSERT_EQ(shaders.size(), 2);
+    for (const auto& shader : shaders) {
+        EXPECT_TRUE(shader.source.starts_with("#version 410 core"));
+        EXPECT_EQ(shader.source.find("#include \"snippets/"), std::string::npos);
+        EXPECT_EQ(shader.source.find("#pragma inject_attributes"), std::string::npos);
+        EXPECT_NE(shader.source.find("#define NUM_LIGHTS 2\n"), std::string::npos);
+    }
+}
+
+#pragma endregion
+
+#pragma region Custom Shaders
+
+TEST(ShaderLibrary, CustomShadersResolveDefinesAndIncludes) {
+    auto scene = gleam::Scene::Create();
+    auto material = gleam::ShaderMaterial::Create(
+        "#version 410 core\n#pragma inject_attributes\n#include \"snippets/vert_global_params.glsl\"\n",
+        "#version 410 core\n#pragma inject_attributes\n#include \"snippets/frag_global_params.glsl\"\n",
+        {}
+    );
+    auto mesh = gleam::Mesh::Create(gleam::BoxGeometry::Create(), material);
+    const auto attrs = gleam::ProgramAttributes {mesh.get(), gleam::ProgramAttributes::LightsCounter {}, scene.get()};
+
+    const auto shaders = gleam::ShaderLibrary {}.GetShaderSource(attrs);
+
+    ASSERT_EQ(shaders.size(), 2);
+    for (const auto& shader : shaders) {
+        EXPECT_EQ(shader.source.find("#include"), std::string::npos);
+        EXPECT_NE(shader.source.find("#define NUM_LIGHTS 0\n"), std::string::npos);
+    }
+}
+
+#pragma endregion
\ No newline at end of file
@@ -9,8 +9,14 @@
 
 #include <gleam/loaders/texture_loader.hpp>
 
+#include "asset_builder/include/types.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <future>
 #include <thread>
+#include <vector>
 
 const auto texture_loader = gleam::TextureLoader::Create();
 
@@ -31,6 +37,23 @@ auto RunAsyncTest(const std::string& file_path, Callback callback) {
     EXPECT_EQ(status, std::future_status::ready);
 }
 
+auto WriteTexture(const std::filesystem::path& path, uint32_t mip_levels, std::size_t data_size) {
+    auto header = TextureHeader {};
+    std::memcpy(header.magic, "TEX0", 4);
+    header.version = 1;
+    header.header_size = sizeof(TextureHeader);
+    header.width = 4;
+    header.height = 2;
+    header.format = static_cast<uint32_t>(TextureFormat::RGBA8);
+    header.mip_levels = mip_levels;
+    header.pixel_data_size = data_size;
+
+    const auto data = std::vector<char>(data_size, 0);
+    auto file = std::ofstream {path, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(data.data(), data.size());
+}
+
 auto VerifyImage(const auto& texture, const std::string& filename) {
     EXPECT_EQ(texture->data.size(), 5 * 5 * 4);
     EXPECT_EQ(texture->width, 5);
@@ -58,6 +81,30 @@ TEST(TextureLoader, LoadTextureSynchronousInvalidFile) {
     EXPECT_EQ(result.error(), "File not found 'assets/invalid_texture.tex'");
 }
 
+TEST(TextureLoader, LoadTextureSynchronousMipLevels) {
+    const auto path = std::filesystem::temp_directory_path() / "gleam_mipmapped_texture.tex";
+    WriteTexture(path, 3, (4 * 2 + 2 * 1 + 1 * 1) * 4);
+
+    auto result = texture_loader->Load(path);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result.value()->mip_levels, 3);
+    EXPECT_EQ(result.value()->data.size(), 44);
+    EXPECT_EQ(result.value()->MipLevelSize(2), 4);
+
+    std::filesystem::remove(path);
+}
+
+TEST(TextureLoader, LoadTextureSynchronousMissingMipLevels) {
+    const auto path = std::filesystem::temp_directory_path() / "gleam_truncated_texture.tex";
+    WriteTexture(path, 3, 4 * 2 * 4);
+
+    auto result = texture_loader->Load(path);
+    EXPECT_FALSE(result);
+    EXPECT_EQ(result.error(), "Invalid texture data in file '" + path.string() + "'");
+
+    std::filesystem::remove(path);
+}
+
 #pragma endregion
 
 #pragma region Load Image Asynchronously
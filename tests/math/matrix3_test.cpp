@@ -331,6 +331,51 @@ TEST(Matrix3, TransposeNonIdentity) {
 
 #pragma endregion
 
+#pragma region Normal Matrix
+
+TEST(Matrix3, NormalMatrixUniformScaleKeepsLinearPart) {
+    constexpr auto m = gleam::Matrix4 {
+        0.0f, -2.0f, 0.0f, 5.0f,
+        2.0f,  0.0f, 0.0f, 1.0f,
+        0.0f,  0.0f, 2.0f, 3.0f,
+        0.0f,  0.0f, 0.0f, 1.0f
+    };
+
+    EXPECT_MAT3_EQ(gleam::NormalMatrix(m), gleam::Matrix3 {m});
+}
+
+TEST(Matrix3, NormalMatrixNonUniformScaleIsInverseTranspose) {
+    constexpr auto m = gleam::Matrix4 {
+        2.0f, 0.0f, 0.0f, 5.0f,
+        0.0f, 4.0f, 0.0f, 1.0f,
+        0.0f, 0.0f, 1.0f, 3.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    EXPECT_MAT3_NEAR(gleam::NormalMatrix(m), {
+        0.5f,  0.0f, 0.0f,
+        0.0f, 0.25f, 0.0f,
+        0.0f,  0.0f, 1.0f
+    }, 1e-6f);
+}
+
+TEST(Matrix3, NormalMatrixShearIsInverseTranspose) {
+    constexpr auto m = gleam::Matrix4 {
+        1.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+
+    EXPECT_MAT3_NEAR(
+        gleam::NormalMatrix(m),
+        gleam::Transpose(gleam::Inverse(gleam::Matrix3 {m})),
+        1e-6f
+    );
+}
+
+#pragma endregion
+
 #pragma region Operators
 
 TEST(Matrix3, SubscriptOperatorReturnsColumnVectorConst) {
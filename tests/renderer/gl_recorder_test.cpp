@@ -0,0 +1,533 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/cameras/perspective_camera.hpp>
+#include <gleam/geometries/box_geometry.hpp>
+#include <gleam/geometries/plane_geometry.hpp>
+#include <gleam/geometries/sphere_geometry.hpp>
+#include <gleam/materials/phong_material.hpp>
+#include <gleam/materials/unlit_material.hpp>
+#include <gleam/nodes/instanced_mesh.hpp>
+#include <gleam/nodes/mesh.hpp>
+#include <gleam/nodes/scene.hpp>
+#include <gleam/textures/texture_2d.hpp>
+#include <gleam/textures/texture_array.hpp>
+
+#include "core/renderer.hpp"
+#include "renderer/gl/gl_recorder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#pragma region Fixtures
+
+class GLRecorderTest : public ::testing::Test {
+protected:
+    std::shared_ptr<gleam::Scene> scene = gleam::Scene::Create();
+
+    std::shared_ptr<gleam::PerspectiveCamera> camera = gleam::PerspectiveCamera::Create({
+        .fov = gleam::math::DegToRad(60.0f),
+        .aspect = 1.0f,
+        .near = 0.1f,
+        .far = 1000.0f
+    });
+
+    std::shared_ptr<gleam::BoxGeometry> geometry = gleam::BoxGeometry::Create();
+
+    gleam::Renderer renderer {{
+        .width = 800,
+        .height = 600,
+        .backend = gleam::Renderer::Backend::Recording
+    }};
+
+    auto SetUp() -> void override {
+        gleam::GLRecorder::Reset();
+    }
+
+    auto AddMesh(std::shared_ptr<gleam::Material> material, float z) {
+        auto mesh = gleam::Mesh::Create(geometry, material);
+        mesh->transform.SetPosition({0.0f, 0.0f, z});
+        scene->Add(mesh);
+        return mesh;
+    }
+
+    auto Render(gleam::Renderer& target) {
+        gleam::GLRecorder::Reset();
+        target.Render(scene.get(), camera.get());
+        return gleam::GLRecorder::GetCounters();
+    }
+
+    auto Render() {
+        return Render(renderer);
+    }
+
+    // Recording renderer with the fixture's size, unless one is given
+    static auto MakeRenderer(gleam::Renderer::Parameters params) {
+        if (params.width == 0 || params.height == 0) {
+            params.width = 800;
+            params.height = 600;
+        }
+        params.backend = gleam::Renderer::Backend::Recording;
+        return gleam::Renderer {params};
+    }
+
+    // Number of recorded calls to the function since the last reset
+    static auto Count(std::string_view function) {
+        return std::ranges::count(gleam::GLRecorder::GetCommands(), function, [](const auto& command) {
+            return std::string_view {command.function};
+        });
+    }
+};
+
+#pragma endregion
+
+#pragma region Commands
+
+TEST_F(GLRecorderTest, FrameStartsWithClear) {
+    AddMesh(gleam::UnlitMaterial::Create(), -5.0f);
+
+    Render();
+
+    const auto commands = gleam::GLRecorder::GetCommands();
+    ASSERT_FALSE(commands.empty());
+    EXPECT_EQ(commands.front().type, gleam::GLRecorder::CommandType::Clear);
+}
+
+TEST_F(GLRecorderTest, RecordsOneDrawPerBatch) {
+    auto batched = gleam::UnlitMaterial::Create();
+    AddMesh(batched, -2.0f);
+    AddMesh(batched, -3.0f);
+    AddMesh(batched, -4.0f);
+    AddMesh(gleam::PhongMaterial::Create(), -5.0f);
+
+    const auto counters = Render();
+
+    const auto commands = gleam::GLRecorder::GetCommands();
+    const auto draws = std::ranges::count_if(commands, [](const auto& command) {
+        return command.type == gleam::GLRecorder::CommandType::Draw;
+    });
+    EXPECT_EQ(draws, 2);
+    EXPECT_EQ(counters.draws, 2);
+    EXPECT_EQ(counters.instances, 4);
+}
+
+TEST_F(GLRecorderTest, MaterialFeatureChangesSelectNewPrograms) {
+    auto material = gleam::UnlitMaterial::Create();
+    AddMesh(material, -5.0f);
+    Render();
+
+    material->albedo_map = gleam::Texture2D::Create({.width = 2, .height = 2, .data = std::vector<uint8_t>(16, 255)});
+    Render();
+    EXPECT_EQ(Count("glLinkProgram"), 1);
+
+    material->flat_shaded = true;
+    Render();
+    EXPECT_EQ(Count("glLinkProgram"), 1);
+
+    // Programs seen before are reused
+    material->albedo_map = nullptr;
+    material->flat_shaded = false;
+    Render();
+    EXPECT_EQ(Count("glLinkProgram"), 0);
+    EXPECT_EQ(Count("glUseProgram"), 1);
+}
+
+TEST_F(GLRecorderTest, TextureArrayLayersShareOneTextureAndDraw) {
+    auto array = gleam::TextureArray::Create({
+        .width = 2,
+        .height = 2,
+        .layers = 3,
+        .data = std::vector<uint8_t>(48, 255)
+    });
+    for (auto i = 0; i < 3; ++i) {
+        auto material = gleam::UnlitMaterial::Create();
+        material->albedo_map = array;
+        material->texture_layer = i;
+        AddMesh(material, -2.0f - static_cast<float>(i));
+    }
+
+    const auto counters = Render();
+
+    EXPECT_EQ(Count("glTexImage3D"), 1);
+    EXPECT_EQ(Count("glTexImage2D"), 0);
+    EXPECT_EQ(counters.draws, 1);
+    EXPECT_EQ(counters.instances, 3);
+}
+
+TEST_F(GLRecorderTest, MipmappedTexturesUploadEveryLevelAndFilterTrilinearly) {
+    auto filtered = MakeRenderer({.anisotropy = 8.0f});
+    auto material = gleam::UnlitMaterial::Create();
+    material->albedo_map = gleam::Texture2D::Create({
+        .width = 4,
+        .height = 4,
+        .data = std::vector<uint8_t>(4 * 4 * 4 + 2 * 2 * 4 + 1 * 1 * 4, 255),
+        .mip_levels = 3
+    });
+    AddMesh(material, -5.0f);
+
+    Render(filtered);
+
+    const auto commands = gleam::GLRecorder::GetCommands();
+    const auto parameter = [&](std::string_view function, int64_t pname) {
+        const auto it = std::ranges::find_if(commands, [&](const auto& command) {
+            return command.function == function && command.args[1] == pname;
+        });
+        return it == commands.end() ? int64_t {-1} : it->args[2];
+    };
+    EXPECT_EQ(Count("glTexImage2D"), 3);
+    EXPECT_EQ(parameter("glTexParameteri", 0x813D), 2); // GL_TEXTURE_MAX_LEVEL
+    EXPECT_EQ(parameter("glTexParameteri", 0x2801), 0x2703); // GL_LINEAR_MIPMAP_LINEAR
+    EXPECT_EQ(parameter("glTexParameterf", 0x84FE), std::bit_cast<int32_t>(8.0f)); // Anisotropy
+}
+
+#pragma endregion
+
+#pragma region Counters
+
+TEST_F(GLRecorderTest, UploadsGeometryOnce) {
+    auto material = gleam::UnlitMaterial::Create();
+    AddMesh(material, -5.0f);
+
+    const auto first = Render();
+    const auto second = Render();
+
+    EXPECT_GT(first.bytes_uploaded, second.bytes_uploaded);
+    EXPECT_GT(second.bytes_uploaded, 0);
+}
+
+TEST_F(GLRecorderTest, RepeatedFrameHasNoRedundantUniforms) {
+    auto unlit = gleam::UnlitMaterial::Create();
+    auto phong = gleam::PhongMaterial::Create();
+    phong->transparent = true;
+
+    for (auto i = 0; i < 4; ++i) {
+        AddMesh(unlit, -2.0f - static_cast<float>(i));
+        AddMesh(phong, -2.5f - static_cast<float>(i));
+    }
+
+    Render();
+    const auto counters = Render();
+
+    EXPECT_GT(counters.uniforms, 0);
+    EXPECT_EQ(counters.redundant_uniforms, 0);
+}
+
+TEST_F(GLRecorderTest, RepeatedFrameHasNoRedundantBindsOrStateChanges) {
+    auto texture = gleam::Texture2D::Create({.width = 2, .height = 2, .data = std::vector<uint8_t>(16, 255)});
+    auto textured = gleam::UnlitMaterial::Create();
+    textured->albedo_map = texture;
+    auto two_sided = gleam::PhongMaterial::Create();
+    two_sided->two_sided = true;
+    auto additive = gleam::PhongMaterial::Create();
+    additive->transparent = true;
+    additive->blending = gleam::Blending::Additive;
+    auto normal = gleam::UnlitMaterial::Create();
+    normal->transparent = true;
+
+    for (auto i = 0; i < 3; ++i) {
+        AddMesh(textured, -2.0f - static_cast<float>(i));
+        AddMesh(two_sided, -2.5f - static_cast<float>(i));
+        AddMesh(additive, -3.0f - static_cast<float>(i));
+        AddMesh(normal, -3.5f - static_cast<float>(i));
+    }
+
+    Render();
+    const auto counters = Render();
+    const auto stats = renderer.StateCacheStatsPerFrame();
+
+    // Buffers are bound to their generic targets only to be written
+    for (const auto& command : gleam::GLRecorder::GetCommands()) {
+        if (std::string_view {command.function} == "glBindBuffer") continue;
+        EXPECT_FALSE(command.redundant) << command.function;
+    }
+    EXPECT_GT(counters.binds, 0);
+    EXPECT_GT(counters.state_changes, 0);
+    EXPECT_EQ(counters.redundant_state_changes, 0);
+    EXPECT_GT(stats.skipped, 0);
+    EXPECT_LT(stats.skipped, stats.calls);
+}
+
+#pragma endregion
+
+#pragma region Offscreen
+
+TEST_F(GLRecorderTest, OffscreenFrameResolvesIntoFramebuffer) {
+    auto offscreen = MakeRenderer({
+        .width = 320,
+        .height = 240,
+        .offscreen = true,
+        .samples = 4
+    });
+    AddMesh(gleam::UnlitMaterial::Create(), -5.0f);
+
+    Render(offscreen);
+
+    const auto commands = gleam::GLRecorder::GetCommands();
+    ASSERT_GE(commands.size(), 2);
+    EXPECT_STREQ(commands[0].function, "glBindFramebuffer");
+    EXPECT_NE(commands[0].args[1], 0);
+    EXPECT_EQ(commands[1].type, gleam::GLRecorder::CommandType::Clear);
+
+    const auto copies = std::ranges::count_if(commands, [](const auto& command) {
+        return command.type == gleam::GLRecorder::CommandType::Copy;
+    });
+    const auto blit = std::ranges::find(commands, std::string_view {"glBlitFramebuffer"}, [](const auto& command) {
+        return std::string_view {command.function};
+    });
+    EXPECT_EQ(copies, 1);
+    ASSERT_NE(blit, commands.end());
+    EXPECT_EQ(blit->args[0], 320);
+    EXPECT_EQ(blit->args[1], 240);
+}
+
+#pragma endregion
+
+#pragma region Capture
+
+TEST_F(GLRecorderTest, CaptureDeliversFramesOnLaterFrames) {
+    auto frames = std::vector<gleam::CapturedFrame> {};
+    AddMesh(gleam::UnlitMaterial::Create(), -5.0f);
+
+    renderer.StartCapture([&frames](gleam::CapturedFrame frame) {
+        frames.emplace_back(std::move(frame));
+    });
+    for (auto i = 0; i < 4; ++i) Render();
+
+    // The last frame is still in flight until the capture stops
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_EQ(frames[0].frame, 0);
+    EXPECT_EQ(frames[2].frame, 2);
+    EXPECT_EQ(frames[0].width, 800);
+    EXPECT_EQ(frames[0].height, 600);
+    EXPECT_EQ(frames[0].pixels.size(), 800 * 600 * 4);
+
+    renderer.StopCapture();
+
+    const auto stats = renderer.CaptureStats();
+    ASSERT_EQ(frames.size(), 4);
+    EXPECT_EQ(frames[3].frame, 3);
+    EXPECT_EQ(stats.captured, 4);
+    EXPECT_EQ(stats.dropped, 0);
+    EXPECT_GT(stats.latency_frames, 0.0);
+}
+
+TEST_F(GLRecorderTest, CaptureReadsIntoPixelBuffers) {
+    AddMesh(gleam::UnlitMaterial::Create(), -5.0f);
+    renderer.StartCapture(nullptr);
+
+    const auto counters = Render();
+
+    const auto commands = gleam::GLRecorder::GetCommands();
+    const auto read = std::ranges::find(commands, std::string_view {"glReadPixels"}, [](const auto& command) {
+        return std::string_view {command.function};
+    });
+    ASSERT_NE(read, commands.end());
+    EXPECT_EQ(read->type, gleam::GLRecorder::CommandType::Copy);
+    EXPECT_EQ(counters.bytes_read, 800 * 600 * 4);
+
+    renderer.StopCapture();
+}
+
+#pragma endregion
+
+#pragma region Occlusion Queries
+
+TEST_F(GLRecorderTest, OcclusionQueriesTestLargeMeshesAfterOpaquePass) {
+    auto occlusion = MakeRenderer({.occlusion_queries = true});
+    auto mesh = gleam::Mesh::Create(gleam::SphereGeometry::Create(), gleam::UnlitMaterial::Create());
+    mesh->transform.SetPosition({0.0f, 0.0f, -5.0f});
+    scene->Add(mesh);
+    AddMesh(gleam::UnlitMaterial::Create(), -10.0f);
+
+    // Only the sphere has enough vertices to be worth a query
+    Render(occlusion);
+    EXPECT_EQ(Count("glBeginQuery"), 1);
+    EXPECT_EQ(Count("glEndQuery"), 1);
+    EXPECT_EQ(Count("glGetQueryObjectuiv"), 0);
+
+    // The next frame reads the result back, and the sphere passed
+    const auto counters = Render(occlusion);
+    EXPECT_EQ(Count("glGetQueryObjectuiv"), 2);
+    EXPECT_EQ(Count("glBeginConditionalRender"), 0);
+    EXPECT_EQ(counters.draws, 3);
+}
+
+TEST_F(GLRecorderTest, OcclusionQueriesTestFlatMeshesWithLessOrEqualDepth) {
+    auto occlusion = MakeRenderer({.occlusion_queries = true});
+    auto plane = gleam::Mesh::Create(
+        gleam::PlaneGeometry::Create({.width_segments = 16, .height_segments = 16}),
+        gleam::UnlitMaterial::Create()
+    );
+    plane->transform.SetPosition({0.0f, 0.0f, -5.0f});
+    scene->Add(plane);
+
+    Render(occlusion);
+
+    // The proxy's front face lies on the plane, which is in the depth buffer
+    auto depth_func = int64_t {0};
+    auto queried = false;
+    for (const auto& command : gleam::GLRecorder::GetCommands()) {
+        const auto function = std::string_view {command.function};
+        if (function == "glDepthFunc") depth_func = command.args[0];
+        if (function == "glBeginQuery") {
+            queried = true;
+            break;
+        }
+    }
+    EXPECT_TRUE(queried);
+    EXPECT_EQ(depth_func, 0x0203); // GL_LEQUAL
+}
+
+#pragma endregion
+
+#pragma region Depth Pre-Pass
+
+TEST_F(GLRecorderTest, DepthPrepassShadesOpaqueListWithEqualDepth) {
+    auto prepass = MakeRenderer({.depth_prepass = true});
+    AddMesh(gleam::PhongMaterial::Create(), -5.0f);
+    AddMesh(gleam::UnlitMaterial::Create(), -10.0f);
+    auto wireframe = gleam::UnlitMaterial::Create();
+    wireframe->wireframe = true;
+    AddMesh(wireframe, -15.0f);
+
+    const auto counters = Render(prepass);
+
+    const auto commands = gleam::GLRecorder::GetCommands();
+    auto has = [&](std::string_view function, int64_t arg) {
+        return std::ranges::any_of(commands, [&](const auto& command) {
+            return command.function == function && command.args[0] == arg;
+        });
+    };
+
+    // Wireframes aren't drawn in the pre-pass
+    EXPECT_EQ(counters.draws, 5);
+    EXPECT_TRUE(has("glColorMask", 0)); // GL_FALSE
+    EXPECT_TRUE(has("glDepthFunc", 0x0202)); // GL_EQUAL
+    EXPECT_EQ(Count("glBeginQuery"), 2);
+
+    // Sample counts are read back three frames later
+    for (auto i = 0; i < 3; ++i) {
+        prepass.Render(scene.get(), camera.get());
+    }
+    EXPECT_EQ(prepass.DepthPrepassStatsPerFrame().depth_fragments, 1);
+    EXPECT_EQ(prepass.DepthPrepassStatsPerFrame().shaded_fragments, 1);
+}
+
+#pragma endregion
+
+#pragma region Program Cache
+
+TEST_F(GLRecorderTest, ProgramCacheLoadsLinkedProgramsOnTheNextRun) {
+    const auto directory = std::filesystem::temp_directory_path() / "gleam_program_cache_test";
+    std::filesystem::remove_all(directory);
+
+    // Every run starts from a new scene, like a new process would
+    auto run = [&]() {
+        scene = gleam::Scene::Create();
+        geometry = gleam::BoxGeometry::Create();
+        AddMesh(gleam::PhongMaterial::Create(), -5.0f);
+        auto cached = MakeRenderer({.shader_cache = directory});
+        EXPECT_EQ(Render(cached).draws, 1);
+    };
+
+    run();
+    EXPECT_EQ(Count("glCompileShader"), 2);
+    EXPECT_EQ(Count("glGetProgramBinary"), 1);
+
+    run();
+    EXPECT_EQ(Count("glCompileShader"), 0);
+    EXPECT_EQ(Count("glProgramBinary"), 1);
+    EXPECT_GT(Count("glUniformBlockBinding"), 0);
+
+    // Binaries the driver rejects are compiled from source and replaced
+    for (const auto& entry : std::filesystem::directory_iterator {directory}) {
+        auto file = std::ifstream {entry.path(), std::ios::binary};
+        auto data = std::string {std::istreambuf_iterator<char> {file}, {}};
+        file.close();
+        data.replace(data.find("GLREC"), 5, "XXXXX");
+        std::ofstream {entry.path(), std::ios::binary | std::ios::trunc} << data;
+    }
+
+    run();
+    EXPECT_EQ(Count("glProgramBinary"), 1);
+    EXPECT_EQ(Count("glCompileShader"), 2);
+
+    run();
+    EXPECT_EQ(Count("glCompileShader"), 0);
+
+    std::filesystem::remove_all(directory);
+}
+
+#pragma endregion
+
+#pragma region Asynchronous Shaders
+
+TEST_F(GLRecorderTest, AsyncShadersSkipObjectsUntilProgramsAreReady) {
+    scene = gleam::Scene::Create();
+    geometry = gleam::BoxGeometry::Create();
+    AddMesh(gleam::PhongMaterial::Create(), -5.0f);
+    auto async = MakeRenderer({.async_shaders = true});
+
+    EXPECT_EQ(Render(async).draws, 0);
+
+    // The recorder reports links as complete from the second query on
+    EXPECT_EQ(async.PendingPrograms(), 1);
+    EXPECT_EQ(async.PendingPrograms(), 0);
+
+    EXPECT_EQ(Render(async).draws, 1);
+}
+
+TEST_F(GLRecorderTest, AsyncShadersUploadInstancesOfSkippedDraws) {
+    scene = gleam::Scene::Create();
+    auto mesh = gleam::InstancedMesh::Create(geometry, gleam::PhongMaterial::Create(), 5);
+    mesh->transform.SetPosition({0.0f, 0.0f, -5.0f});
+    scene->Add(mesh);
+    auto async = MakeRenderer({.async_shaders = true});
+
+    EXPECT_EQ(Render(async).draws, 0);
+    EXPECT_EQ(async.PendingPrograms(), 1);
+    EXPECT_EQ(async.PendingPrograms(), 0);
+
+    // Transforms set before the skipped frame are uploaded by the first draw
+    EXPECT_EQ(Render(async).draws, 1);
+    const auto transforms_size = static_cast<int64_t>(5 * sizeof(gleam::Matrix4));
+    const auto uploads = std::ranges::count_if(gleam::GLRecorder::GetCommands(), [&](const auto& command) {
+        return std::string_view {command.function} == "glBufferData" && command.args[2] == transforms_size;
+    });
+    EXPECT_EQ(uploads, 1);
+}
+
+TEST_F(GLRecorderTest, PrecompileBuildsProgramsBeforeTheFirstFrame) {
+    scene = gleam::Scene::Create();
+    geometry = gleam::BoxGeometry::Create();
+    AddMesh(gleam::PhongMaterial::Create(), -5.0f);
+    AddMesh(gleam::UnlitMaterial::Create(), -6.0f);
+    auto async = MakeRenderer({.async_shaders = true});
+
+    gleam::GLRecorder::Reset();
+    async.Precompile(scene.get());
+    EXPECT_GE(Count("glLinkProgram"), 2);
+    EXPECT_EQ(Count("glGetShaderiv"), 0);
+
+    while (async.PendingPrograms() > 0) {}
+
+    EXPECT_EQ(Render(async).draws, 2);
+    EXPECT_EQ(Count("glCompileShader"), 0);
+}
+
+#pragma endregion
\ No newline at end of file
@@ -0,0 +1,160 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+
+#include <gleam/cameras/perspective_camera.hpp>
+#include <gleam/core/job_system.hpp>
+#include <gleam/geometries/box_geometry.hpp>
+#include <gleam/geometries/plane_geometry.hpp>
+#include <gleam/lights/directional_light.hpp>
+#include <gleam/materials/phong_material.hpp>
+#include <gleam/materials/unlit_material.hpp>
+#include <gleam/nodes/mesh.hpp>
+#include <gleam/nodes/scene.hpp>
+
+#include "core/renderer.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#pragma region Fixtures
+
+class SoftwareRendererTest : public ::testing::Test {
+protected:
+    static constexpr auto kSize = 96;
+
+    std::shared_ptr<gleam::Scene> scene = gleam::Scene::Create();
+
+    std::shared_ptr<gleam::PerspectiveCamera> camera = gleam::PerspectiveCamera::Create({
+        .fov = gleam::math::DegToRad(60.0f),
+        .aspect = 1.0f,
+        .near = 0.1f,
+        .far = 100.0f
+    });
+
+    std::shared_ptr<gleam::PlaneGeometry> plane = gleam::PlaneGeometry::Create();
+
+    auto AddPlane(std::shared_ptr<gleam::Material> material, float z) {
+        auto mesh = gleam::Mesh::Create(plane, material);
+        mesh->transform.SetPosition({0.0f, 0.0f, z});
+        scene->Add(mesh);
+        return mesh;
+    }
+
+    auto Render(gleam::JobSystem* jobs = nullptr) {
+        auto renderer = gleam::Renderer {{
+            .width = kSize,
+            .height = kSize,
+            .jobs = jobs,
+            .backend = gleam::Renderer::Backend::Software
+        }};
+        renderer.SetClearColor(0x0000FF);
+
+        auto pixels = std::vector<uint8_t> {};
+        renderer.StartCapture([&pixels](gleam::CapturedFrame frame) {
+            pixels = std::move(frame.pixels);
+        });
+        renderer.Render(scene.get(), camera.get());
+        renderer.StopCapture();
+        return pixels;
+    }
+
+    static auto Pixel(const std::vector<uint8_t>& pixels, int x, int y) {
+        const auto offset = (static_cast<std::size_t>(y) * kSize + x) * 4;
+        return std::array<uint8_t, 4> {
+            pixels[offset], pixels[offset + 1], pixels[offset + 2], pixels[offset + 3]
+        };
+    }
+};
+
+using Rgba = std::array<uint8_t, 4>;
+
+#pragma endregion
+
+#pragma region Rasterization
+
+TEST_F(SoftwareRendererTest, EmptySceneIsClearColor) {
+    const auto pixels = Render();
+
+    ASSERT_EQ(pixels.size(), kSize * kSize * 4);
+    EXPECT_EQ(Pixel(pixels, 0, 0), (Rgba {0, 0, 255, 255}));
+    EXPECT_EQ(Pixel(pixels, kSize / 2, kSize / 2), (Rgba {0, 0, 255, 255}));
+}
+
+TEST_F(SoftwareRendererTest, UnlitPlaneCoversCenter) {
+    AddPlane(gleam::UnlitMaterial::Create(0xFF0000), -2.0f);
+
+    const auto pixels = Render();
+
+    EXPECT_EQ(Pixel(pixels, kSize / 2, kSize / 2), (Rgba {255, 0, 0, 255}));
+    EXPECT_EQ(Pixel(pixels, 0, 0), (Rgba {0, 0, 255, 255}));
+}
+
+TEST_F(SoftwareRendererTest, NearerPlaneOccludesFartherPlane) {
+    AddPlane(gleam::UnlitMaterial::Create(0x00FF00), -2.0f);
+    AddPlane(gleam::UnlitMaterial::Create(0xFF0000), -4.0f);
+
+    const auto pixels = Render();
+
+    EXPECT_EQ(Pixel(pixels, kSize / 2, kSize / 2), (Rgba {0, 255, 0, 255}));
+}
+
+TEST_F(SoftwareRendererTest, CullsBackFacesUnlessTwoSided) {
+    auto material = gleam::UnlitMaterial::Create(0xFF0000);
+    auto mesh = AddPlane(material, -2.0f);
+    mesh->transform.Rotate(gleam::Vector3::Up(), gleam::math::pi);
+
+    EXPECT_EQ(Pixel(Render(), kSize / 2, kSize / 2), (Rgba {0, 0, 255, 255}));
+
+    material->two_sided = true;
+
+    EXPECT_EQ(Pixel(Render(), kSize / 2, kSize / 2), (Rgba {255, 0, 0, 255}));
+}
+
+TEST_F(SoftwareRendererTest, BlendsTransparentPlanes) {
+    auto material = gleam::UnlitMaterial::Create(0xFF0000);
+    material->transparent = true;
+    material->opacity = 0.5f;
+    AddPlane(material, -2.0f);
+
+    const auto center = Pixel(Render(), kSize / 2, kSize / 2);
+
+    EXPECT_NEAR(center[0], 128, 1);
+    EXPECT_EQ(center[1], 0);
+    EXPECT_NEAR(center[2], 128, 1);
+}
+
+#pragma endregion
+
+#pragma region Threading
+
+TEST_F(SoftwareRendererTest, JobsProduceTheSameImage) {
+    auto material = gleam::PhongMaterial::Create(0xCC8844);
+    for (auto i = 0; i < 8; ++i) {
+        auto box = gleam::Mesh::Create(gleam::BoxGeometry::Create(), material);
+        box->transform.SetPosition({static_cast<float>(i % 4) - 1.5f, static_cast<float>(i / 4) - 0.5f, -5.0f});
+        box->transform.Rotate(gleam::Vector3::Up(), 0.3f * static_cast<float>(i));
+        scene->Add(box);
+    }
+    scene->Add(gleam::DirectionalLight::Create({
+        .color = 0xFFFFFF,
+        .intensity = 1.0f,
+        .target = nullptr
+    }));
+
+    auto jobs = gleam::JobSystem {{.workers = 4}};
+    const auto serial = Render();
+    const auto parallel = Render(&jobs);
+
+    EXPECT_EQ(serial, parallel);
+    EXPECT_NE(Pixel(serial, kSize / 2, kSize / 2), (Rgba {0, 0, 255, 255}));
+}
+
+#pragma endregion
\ No newline at end of file
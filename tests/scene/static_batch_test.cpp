@@ -0,0 +1,189 @@
+/*
+===========================================================================
+  GLEAM ENGINE https://gleamengine.org
+  Copyright © 2024 - Present, Shlomi Nissan
+===========================================================================
+*/
+
+#include <gtest/gtest.h>
+#include <test_helpers.hpp>
+
+#include <gleam/geometries/box_geometry.hpp>
+#include <gleam/materials/unlit_material.hpp>
+#include <gleam/nodes/instanced_mesh.hpp>
+#include <gleam/nodes/mesh.hpp>
+#include <gleam/nodes/static_batch.hpp>
+
+#include <memory>
+
+#pragma region Helpers
+
+static auto MeshAt(
+    std::shared_ptr<gleam::Geometry> geometry,
+    std::shared_ptr<gleam::Material> material,
+    const gleam::Vector3& position
+) {
+    auto mesh = gleam::Mesh::Create(geometry, material);
+    mesh->transform.SetPosition(position);
+    return mesh;
+}
+
+static auto MergedMesh(const std::shared_ptr<gleam::Node>& node) {
+    return std::static_pointer_cast<gleam::Mesh>(node);
+}
+
+#pragma endregion
+
+#pragma region Merging
+
+TEST(StaticBatch, MergesMeshesSharingMaterial) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material = gleam::UnlitMaterial::Create();
+
+    for (auto i = 0; i < 4; ++i) {
+        batch->Add(MeshAt(geometry, material, {static_cast<float>(i) * 2.0f, 0.0f, 0.0f}));
+    }
+
+    batch->Build();
+
+    ASSERT_EQ(batch->Children().size(), 1);
+    auto merged = MergedMesh(batch->Children()[0])->GetGeometry();
+    EXPECT_EQ(merged->VertexCount(), geometry->VertexCount() * 4);
+    EXPECT_EQ(merged->IndexCount(), geometry->IndexCount() * 4);
+    EXPECT_EQ(merged->Stride(), geometry->Stride());
+}
+
+TEST(StaticBatch, SplitsByMaterial) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material_a = gleam::UnlitMaterial::Create();
+    auto material_b = gleam::UnlitMaterial::Create();
+
+    batch->Add(MeshAt(geometry, material_a, {0.0f, 0.0f, 0.0f}));
+    batch->Add(MeshAt(geometry, material_b, {2.0f, 0.0f, 0.0f}));
+    batch->Add(MeshAt(geometry, material_a, {4.0f, 0.0f, 0.0f}));
+
+    batch->Build();
+
+    EXPECT_EQ(batch->Children().size(), 2);
+}
+
+TEST(StaticBatch, OrdersChunksByFirstSeenMaterial) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material_a = gleam::UnlitMaterial::Create();
+    auto material_b = gleam::UnlitMaterial::Create();
+
+    batch->Add(MeshAt(geometry, material_b, {0.0f, 0.0f, 0.0f}));
+    batch->Add(MeshAt(geometry, material_a, {2.0f, 0.0f, 0.0f}));
+    batch->Add(MeshAt(geometry, material_b, {4.0f, 0.0f, 0.0f}));
+
+    batch->Build();
+
+    ASSERT_EQ(batch->Children().size(), 2);
+    EXPECT_EQ(MergedMesh(batch->Children()[0])->GetMaterial(), material_b);
+    EXPECT_EQ(MergedMesh(batch->Children()[1])->GetMaterial(), material_a);
+}
+
+TEST(StaticBatch, SplitsIntoSpatialChunks) {
+    auto batch = gleam::StaticBatch::Create({.chunk_size = 10.0f});
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material = gleam::UnlitMaterial::Create();
+
+    batch->Add(MeshAt(geometry, material, {1.0f, 1.0f, 1.0f}));
+    batch->Add(MeshAt(geometry, material, {2.0f, 1.0f, 1.0f}));
+    batch->Add(MeshAt(geometry, material, {25.0f, 1.0f, 1.0f}));
+
+    batch->Build();
+
+    ASSERT_EQ(batch->Children().size(), 2);
+    for (const auto& child : batch->Children()) {
+        const auto sphere = MergedMesh(child)->BoundingSphere();
+        EXPECT_LT(sphere.radius, 10.0f);
+    }
+}
+
+#pragma endregion
+
+#pragma region Transforms
+
+TEST(StaticBatch, PreTransformsNestedVertices) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material = gleam::UnlitMaterial::Create();
+
+    auto group = gleam::Node::Create();
+    group->transform.SetPosition({0.0f, 10.0f, 0.0f});
+    group->Add(MeshAt(geometry, material, {5.0f, 0.0f, 0.0f}));
+    batch->Add(group);
+
+    batch->Build();
+
+    ASSERT_EQ(batch->Children().size(), 2);
+    EXPECT_TRUE(group->Children().empty());
+
+    auto merged = MergedMesh(batch->Children()[1]);
+    EXPECT_VEC3_NEAR(merged->BoundingSphere().center, {5.0f, 10.0f, 0.0f}, 1e-5f);
+    EXPECT_VEC3_NEAR(merged->GetWorldPosition(), {0.0f, 0.0f, 0.0f}, 1e-5f);
+}
+
+TEST(StaticBatch, MirroredTransformFlipsWinding) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material = gleam::UnlitMaterial::Create();
+
+    auto mesh = gleam::Mesh::Create(geometry, material);
+    mesh->SetScale({-1.0f, 1.0f, 1.0f});
+    batch->Add(mesh);
+
+    batch->Build();
+
+    ASSERT_EQ(batch->Children().size(), 1);
+    const auto& source = geometry->IndexData();
+    const auto& merged = MergedMesh(batch->Children()[0])->GetGeometry()->IndexData();
+    EXPECT_EQ(merged[0], source[0]);
+    EXPECT_EQ(merged[1], source[2]);
+    EXPECT_EQ(merged[2], source[1]);
+}
+
+#pragma endregion
+
+#pragma region Eligibility
+
+TEST(StaticBatch, SkipsInstancedMeshesAndMeshesWithChildren) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material = gleam::UnlitMaterial::Create();
+
+    auto instanced = gleam::InstancedMesh::Create(geometry, material, 4);
+    auto parent = gleam::Mesh::Create(geometry, material);
+    parent->Add(gleam::Node::Create());
+
+    batch->Add(instanced);
+    batch->Add(parent);
+    batch->Build();
+
+    EXPECT_EQ(batch->Children().size(), 2);
+    EXPECT_TRUE(batch->IsChild(instanced.get()));
+    EXPECT_TRUE(batch->IsChild(parent.get()));
+}
+
+TEST(StaticBatch, SkipsTransparentMeshes) {
+    auto batch = gleam::StaticBatch::Create();
+    auto geometry = gleam::BoxGeometry::Create();
+    auto material = gleam::UnlitMaterial::Create();
+    auto transparent = gleam::UnlitMaterial::Create();
+    transparent->transparent = true;
+
+    auto glass = MeshAt(geometry, transparent, {0.0f, 0.0f, 0.0f});
+    batch->Add(glass);
+    batch->Add(MeshAt(geometry, material, {2.0f, 0.0f, 0.0f}));
+    batch->Add(MeshAt(geometry, material, {4.0f, 0.0f, 0.0f}));
+    batch->Build();
+
+    EXPECT_EQ(batch->Children().size(), 2);
+    EXPECT_TRUE(batch->IsChild(glass.get()));
+}
+
+#pragma endregion
\ No newline at end of file
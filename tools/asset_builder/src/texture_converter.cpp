@@ -10,12 +10,101 @@
 #include "texture_converter.hpp"
 #include "types.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <vector>
 
 #include "stb_image.hpp"
 
+namespace {
+
+// Color channels are stored in sRGB, so they're filtered in linear space.
+// Averaging the encoded values instead darkens every level of the chain.
+auto srgb_to_linear(float value) {
+    return value <= 0.04045f
+        ? value / 12.92f
+        : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+auto linear_to_srgb(float value) {
+    return value <= 0.0031308f
+        ? value * 12.92f
+        : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// RGBA pixels in linear space. Alpha is linear to begin with.
+struct Image {
+    int width {0};
+    int height {0};
+    std::vector<float> pixels {};
+};
+
+auto decode(const uint8_t* data, int width, int height) {
+    auto table = std::array<float, 256> {};
+    for (auto i = 0; i < 256; ++i) {
+        table[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+    }
+
+    auto image = Image {width, height};
+    image.pixels.resize(static_cast<std::size_t>(width) * height * 4);
+    for (auto i = std::size_t {0}; i < image.pixels.size(); i += 4) {
+        image.pixels[i] = table[data[i]];
+        image.pixels[i + 1] = table[data[i + 1]];
+        image.pixels[i + 2] = table[data[i + 2]];
+        image.pixels[i + 3] = static_cast<float>(data[i + 3]) / 255.0f;
+    }
+    return image;
+}
+
+auto encode(const Image& image, std::vector<uint8_t>& out) {
+    const auto quantize = [](float value) {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    };
+    for (auto i = std::size_t {0}; i < image.pixels.size(); i += 4) {
+        out.emplace_back(quantize(linear_to_srgb(image.pixels[i])));
+        out.emplace_back(quantize(linear_to_srgb(image.pixels[i + 1])));
+        out.emplace_back(quantize(linear_to_srgb(image.pixels[i + 2])));
+        out.emplace_back(quantize(image.pixels[i + 3]));
+    }
+}
+
+// Halves the image with a 2x2 box filter. Sizes round down like the sizes
+// of GL mip levels, and once a side is a single pixel only the other side
+// is halved. Both passes are plain loops over contiguous floats, which the
+// compiler vectorizes.
+auto downsample(const Image& src, std::vector<float>& row) {
+    auto dst = Image {std::max(1, src.width / 2), std::max(1, src.height / 2)};
+    dst.pixels.resize(static_cast<std::size_t>(dst.width) * dst.height * 4);
+
+    const auto src_stride = static_cast<std::size_t>(src.width) * 4;
+    row.resize(src_stride);
+
+    for (auto y = 0; y < dst.height; ++y) {
+        const auto* row0 = src.pixels.data() + std::min(y * 2, src.height - 1) * src_stride;
+        const auto* row1 = src.pixels.data() + std::min(y * 2 + 1, src.height - 1) * src_stride;
+        for (auto i = std::size_t {0}; i < src_stride; ++i) {
+            row[i] = row0[i] + row1[i];
+        }
+
+        auto* out = dst.pixels.data() + static_cast<std::size_t>(y) * dst.width * 4;
+        for (auto x = 0; x < dst.width; ++x) {
+            const auto* a = row.data() + static_cast<std::size_t>(x) * 8;
+            const auto* b = row.data() + static_cast<std::size_t>(std::min(x * 2 + 1, src.width - 1)) * 4;
+            for (auto c = 0; c < 4; ++c) {
+                out[x * 4 + c] = (a[c] + b[c]) * 0.25f;
+            }
+        }
+    }
+
+    return dst;
+}
+
+}
+
 auto convert_texture(
     const fs::path& input_path,
     const fs::path& output_path
@@ -30,6 +119,21 @@ auto convert_texture(
         return std::unexpected("Failed to load image: " + input_path.string());
     }
 
+    // The full chain down to 1x1. Level 0 is stored as loaded, and every
+    // other level is filtered from the previous one in floating point, so
+    // rounding errors don't accumulate down the chain.
+    auto pixels = std::vector<uint8_t>(data, data + static_cast<std::size_t>(width) * height * 4);
+    auto mip_levels = 1u;
+    auto image = decode(data, width, height);
+    auto row = std::vector<float> {};
+    stbi_image_free(data);
+
+    while (image.width > 1 || image.height > 1) {
+        image = downsample(image, row);
+        encode(image, pixels);
+        ++mip_levels;
+    }
+
     auto header = TextureHeader {};
     std::memcpy(header.magic, "TEX0", 4);
     header.version = 1;
@@ -37,18 +141,16 @@ auto convert_texture(
     header.width = static_cast<uint32_t>(width);
     header.height = static_cast<uint32_t>(height);
     header.format = static_cast<uint32_t>(TextureFormat::RGBA8);
-    header.mip_levels = 1;
-    header.pixel_data_size = static_cast<uint64_t>(width) * height * 4;
+    header.mip_levels = mip_levels;
+    header.pixel_data_size = static_cast<uint64_t>(pixels.size());
 
     auto out_stream = std::ofstream {output_path, std::ios::binary};
     if (!out_stream) {
-        stbi_image_free(data);
         return std::unexpected("Failed to open output file: " + output_path.string());
     }
 
     out_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    out_stream.write(reinterpret_cast<const char*>(data), header.pixel_data_size);
-    stbi_image_free(data);
+    out_stream.write(reinterpret_cast<const char*>(pixels.data()), header.pixel_data_size);
 
     return {};
 }
\ No newline at end of file